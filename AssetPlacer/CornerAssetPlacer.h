@@ -8,6 +8,9 @@
 #include "gept3dar.h"  // For AcGePoint3d
 #include "dbsymtb.h"   // For AcDbObjectId
 #include "SharedConfigs.h"
+#include "CornerLayout.h"
+
+class BlockBatch;
 
 struct Panels {
     double width;
@@ -60,27 +63,26 @@ public:
     static AcDbObjectId loadAsset(const wchar_t* blockName);
     // Public method to identify walls, ensuring declaration matches definition
     static void identifyWalls();
-    static int identifyFirstLoopEnd(const std::vector<AcGePoint3d>& corners);
-    // Helper method to split corners into two loops
-    static std::pair<std::vector<AcGePoint3d>, std::vector<AcGePoint3d>> splitLoops(const std::vector<AcGePoint3d>& corners, int firstLoopEnd);
     static PanelConfig getPanelConfig(double distance, PanelDimensions& panelDims);
-    static std::vector<CornerConfig> generateCornerConfigs(const std::vector<AcGePoint3d>& corners, const PanelConfig& config);
-    static bool directionOfDrawing2(std::vector<AcGePoint3d>& points);
+    // Corner at `corner` of `loop` for g_cornerConfigs, reaching as far as the panels of `set`
+    static CornerConfig cornerConfig(const WallCorner& corner, const PlanLoop& loop, const CornerPanelSet& set);
     // Helper method to calculate distance between first two polylines
     static double calculateDistanceBetweenPolylines();
+    // Queue an inside corner assembly (post, a panel on each wall, compensators on 150 walls) or an
+    // outside one at `corner`, in 1350 then 600 rows up to the wall height; `distance` is the wall thickness
+    static void placeInsideCornerPostAndPanels(BlockBatch& batch, const AcGePoint3d& corner, double rotation, AcDbObjectId cornerPostId, const CornerPanelSet& set, double distance);
+    static void placeOutsideCornerPostAndPanels(BlockBatch& batch, const AcGePoint3d& corner, double rotation, AcDbObjectId cornerPostId, const CornerPanelSet& set, double distance);
 private:
-    // Method to detect polylines in the drawing
-    static std::vector<AcGePoint3d> detectPolylines();
     // Method to load an asset block from the block table
     
     // Method to get panel configuration based on distance
    
     // Method to place an asset at a specific corner with a given rotation
     static void placeAssetAtCorner(const AcGePoint3d& corner, double rotation, AcDbObjectId assetId);
-    // Method to place corner post and panels (Inside corner)
-    static void placeInsideCornerPostAndPanels(const AcGePoint3d& corner, double rotation, AcDbObjectId cornerPostId, AcDbObjectId panelIdA, AcDbObjectId panelIdB, double distance, AcDbObjectId compensatorIdA, AcDbObjectId compensatorIdB);
-    // Method to place corner post and panels (Outside corner)
-    static void placeOutsideCornerPostAndPanels(const AcGePoint3d& corner, double rotation, AcDbObjectId cornerPostId, const PanelConfig& config, AcDbObjectId outsidePanelIdA, AcDbObjectId outsidePanelIdB, AcDbObjectId outsidePanelIdC, AcDbObjectId outsidePanelIdD, AcDbObjectId outsidePanelIdE, AcDbObjectId outsidePanelIdF, AcDbObjectId outsideCompensatorIdA, AcDbObjectId outsideCompensatorIdB, double distance);
+    // Corner of an assembly as CornerLayout takes it, from the placer's rotation
+    static WallCorner wallCornerAt(const AcGePoint3d& corner, double rotation, bool inside);
+    // Method to queue the parts of a corner assembly, blocks looked up by part width
+    static void addCornerParts(BlockBatch& batch, const std::vector<CornerPart>& parts, AcDbObjectId cornerPostId);
     // Method to add text annotation at a specific position
     static void addTextAnnotation(const AcGePoint3d& position, const wchar_t* text);
     // Helper method to identify the end of the first loop
@@ -88,20 +90,4 @@ private:
     // Helper method to process corners, determining rotation and inside/outside placement
     static void processCorners(const std::vector<AcGePoint3d>& corners, AcDbObjectId cornerPostId, const PanelConfig& config,
         double distance, const std::vector<bool>& loopIsClockwise, const std::vector<bool>& isInsideLoop);
-    // Helper method to adjust rotation for a corner based on direction vectors
-    static void adjustRotationForCorner(double& rotation, const std::vector<AcGePoint3d>& corners, size_t cornerNum);
-
-    // Comparator for AcGePoint3d to be used in the map
-    struct Point3dComparator {
-        bool operator()(const AcGePoint3d& lhs, const AcGePoint3d& rhs) const {
-            if (lhs.x != rhs.x)
-                return lhs.x < rhs.x;
-            if (lhs.y != rhs.y)
-                return lhs.y < rhs.y;
-            return lhs.z < rhs.z;
-        }
-    };
-
-    // Static member to hold the wall mapping
-    static std::map<AcGePoint3d, std::vector<AcGePoint3d>, Point3dComparator> wallMap;
 };
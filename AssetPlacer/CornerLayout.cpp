@@ -0,0 +1,183 @@
+#include "CornerLayout.h"
+#include "Orientation.h"
+#include <cmath>
+
+// One part of an assembly in panel coordinates of a corner at quadrant 0: the offset from the
+// corner and the quarter turns added to the corner rotation
+struct CornerPartTemplate {
+    CornerPartKind kind;
+    int width;
+    PlanPoint offset;
+    int turns;
+};
+
+
+// Places the parts that have a width at every 1350 then 600 row up to `wallHeight`, the rows the
+// corner placers stack
+static void placeRows(const WallCorner& corner, const CornerPartTemplate* templates, size_t count, int wallHeight,
+    std::vector<CornerPart>& parts) {
+    PlanPoint local[12];
+    PlanPoint offsets[12];
+    for (size_t i = 0; i < count; ++i) {
+        local[i] = templates[i].offset;
+    }
+    orient(orientations[corner.quadrant], local, offsets, count);
+
+    const int rowHeights[] = { 1350, 600 };
+    int currentHeight = 0;
+    for (int height : rowHeights) {
+        int rows = (wallHeight - currentHeight) / height;
+        for (int row = 0; row < rows; ++row) {
+            for (size_t i = 0; i < count; ++i) {
+                if (templates[i].width <= 0) {
+                    continue;
+                }
+                PlanPoint position = makePlanPoint(corner.position.x + offsets[i].x, corner.position.y + offsets[i].y,
+                    corner.position.z + currentHeight);
+                parts.push_back({ templates[i].kind, templates[i].width, height, position,
+                    orientations[(corner.quadrant + templates[i].turns) % 4].angle });
+            }
+            currentHeight += height;
+        }
+    }
+}
+
+
+bool CornerLayout::panelSet(double wallThickness, CornerPanelSet& set) {
+    // Outside panels of the first, second and third pair by thickness; the compensators
+    // take up the rest in 50s
+    struct Row {
+        int thickness;
+        int outside[3];
+        int compensator;
+    };
+    static const Row rows[] = {
+        { 150, { 450, 0, 0 }, 50 }, { 200, { 450, 0, 0 }, 0 }, { 250, { 450, 0, 0 }, 50 }, { 300, { 450, 0, 0 }, 100 },
+        { 350, { 600, 0, 0 }, 0 }, { 400, { 600, 0, 0 }, 50 }, { 450, { 600, 0, 0 }, 100 },
+        { 500, { 750, 0, 0 }, 0 }, { 550, { 750, 0, 0 }, 50 }, { 600, { 750, 0, 0 }, 100 },
+        { 650, { 450, 450, 0 }, 0 }, { 700, { 450, 450, 0 }, 50 }, { 750, { 450, 450, 0 }, 100 },
+        { 800, { 300, 750, 0 }, 0 }, { 850, { 300, 750, 0 }, 50 }, { 900, { 300, 750, 0 }, 100 },
+        { 950, { 450, 750, 0 }, 0 }, { 1000, { 450, 750, 0 }, 50 }, { 1050, { 450, 750, 0 }, 100 },
+        { 1100, { 600, 750, 0 }, 0 }, { 1150, { 600, 750, 0 }, 50 }, { 1200, { 600, 750, 0 }, 100 },
+        { 1250, { 750, 750, 0 }, 0 }, { 1300, { 750, 750, 0 }, 50 }, { 1350, { 750, 750, 0 }, 100 },
+        { 1400, { 450, 450, 750 }, 0 }, { 1450, { 450, 450, 750 }, 50 }, { 1500, { 450, 450, 750 }, 100 },
+        { 1550, { 600, 450, 750 }, 0 }, { 1600, { 600, 450, 750 }, 50 }, { 1650, { 600, 450, 750 }, 100 },
+        { 1700, { 750, 450, 750 }, 0 }, { 1750, { 750, 450, 750 }, 50 }, { 1800, { 750, 450, 750 }, 100 },
+        { 1850, { 600, 750, 750 }, 0 }, { 1900, { 600, 750, 750 }, 50 }, { 1950, { 600, 750, 750 }, 100 },
+        { 2000, { 750, 750, 750 }, 0 }, { 2050, { 750, 750, 750 }, 50 }, { 2100, { 750, 750, 750 }, 100 }
+    };
+
+    for (const Row& row : rows) {
+        if (row.thickness != wallThickness) {
+            continue;
+        }
+        set.inside[0] = set.inside[1] = 150;
+        for (int pair = 0; pair < 3; ++pair) {
+            set.outside[pair * 2] = set.outside[pair * 2 + 1] = row.outside[pair];
+        }
+        set.compensator[0] = set.compensator[1] = row.compensator;
+        return true;
+    }
+    return false;
+}
+
+
+void CornerLayout::corners(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy, const WallGraph& graph,
+    std::vector<WallCorner>& corners) {
+    for (size_t loopIndex = 0; loopIndex < loops.size() && loopIndex < hierarchy.size(); ++loopIndex) {
+        const PlanLoop& loop = loops[loopIndex];
+        size_t count = loop.size();
+        if (count < 3) {
+            continue;
+        }
+
+        // The wall lies inside an outer loop and outside an inner one
+        bool wallOnLeft = hierarchy.isClockwise(loopIndex) != hierarchy.isOuter(loopIndex);
+        for (size_t vertex = 0; vertex < count; ++vertex) {
+            const PlanPoint& previous = loop[(vertex + count - 1) % count];
+            const PlanPoint& current = loop[vertex];
+            const PlanPoint& next = loop[(vertex + 1) % count];
+            double inX = current.x - previous.x;
+            double inY = current.y - previous.y;
+            double outX = next.x - current.x;
+            double outY = next.y - current.y;
+            double cross = inX * outY - inY * outX;
+            if (std::fabs(cross) <= 1e-9 * std::sqrt((inX * inX + inY * inY) * (outX * outX + outY * outY))) {
+                continue;
+            }
+
+            // No corner post where a wall changes thickness or stops
+            int node = graph.jointOf(static_cast<int>(loopIndex), static_cast<int>(vertex), current);
+            if (node >= 0) {
+                WallNodeType type = graph.nodes()[node].type;
+                if (type == WallNodeType::End || type == WallNodeType::Inline) {
+                    continue;
+                }
+            }
+
+            int quadrant = (orientationQuadrant(std::atan2(outY, outX)) + (cross > 0 ? 1 : 0)) % 4;
+            corners.push_back({ current, quadrant, (cross < 0) == wallOnLeft,
+                static_cast<int>(loopIndex), static_cast<int>(vertex), node });
+        }
+    }
+}
+
+
+void CornerLayout::insideCorner(const WallCorner& corner, const CornerPanelSet& set, double wallThickness, int wallHeight,
+    std::vector<CornerPart>& parts) {
+    const double panelEnd = postWidth + 150.0;
+    bool compensators = wallThickness == 150;
+    CornerPartTemplate templates[] = {
+        { CornerPartKind::Post, postWidth, makePlanPoint(0, 0, 0), 0 },
+        { CornerPartKind::Panel, set.inside[0], makePlanPoint(postWidth, 0, 0), 0 },
+        { CornerPartKind::Panel, set.inside[1], makePlanPoint(0, -panelEnd, 0), 1 },
+        { CornerPartKind::Compensator, compensators ? set.compensator[0] : 0, makePlanPoint(panelEnd, 0, 0), 0 },
+        { CornerPartKind::Compensator, compensators ? set.compensator[1] : 0, makePlanPoint(0, -(panelEnd + 50.0), 0), 1 }
+    };
+    placeRows(corner, templates, sizeof(templates) / sizeof(templates[0]), wallHeight, parts);
+}
+
+
+void CornerLayout::outsideCorner(const WallCorner& corner, const CornerPanelSet& set, double wallThickness, int wallHeight,
+    std::vector<CornerPart>& parts) {
+    // Panels run from the post along the first wall (even) and down the second (odd)
+    const double post = postWidth;
+    const int* width = set.outside;
+    PlanPoint origin = makePlanPoint(-post, post, 0);
+    PlanPoint panels[6];
+    panels[0] = makePlanPoint(post + width[0], -post, 0);
+    panels[1] = makePlanPoint(post, -post, 0);
+    for (int i = 2; i < 6; ++i) {
+        panels[i] = i % 2 == 0
+            ? makePlanPoint(panels[i - 2].x + width[i], panels[i - 2].y, 0)
+            : makePlanPoint(panels[i - 2].x, panels[i - 2].y - width[i - 2], 0);
+    }
+    PlanPoint compensatorA = makePlanPoint(panels[4].x + set.compensator[0], panels[4].y, 0);
+    PlanPoint compensatorB = makePlanPoint(panels[5].x, panels[5].y - width[5], 0);
+
+    auto fromCorner = [&](const PlanPoint& offset) {
+        return makePlanPoint(origin.x + offset.x, origin.y + offset.y, 0);
+    };
+    bool compensators = wallThickness != 150;
+    CornerPartTemplate templates[9];
+    templates[0] = { CornerPartKind::Post, postWidth, origin, 0 };
+    for (int i = 0; i < 6; ++i) {
+        templates[i + 1] = { CornerPartKind::Panel, width[i], fromCorner(panels[i]), i % 2 == 0 ? 2 : 3 };
+    }
+    templates[7] = { CornerPartKind::Compensator, compensators ? set.compensator[0] : 0, fromCorner(compensatorA), 2 };
+    templates[8] = { CornerPartKind::Compensator, compensators ? set.compensator[1] : 0, fromCorner(compensatorB), 3 };
+    placeRows(corner, templates, 9, wallHeight, parts);
+}
+
+
+void CornerLayout::build(const std::vector<WallCorner>& corners, const CornerPanelSet& set, double wallThickness, int wallHeight,
+    std::vector<CornerPart>& parts) {
+    for (const WallCorner& corner : corners) {
+        if (corner.inside) {
+            insideCorner(corner, set, wallThickness, wallHeight, parts);
+        }
+        else {
+            outsideCorner(corner, set, wallThickness, wallHeight, parts);
+        }
+    }
+}
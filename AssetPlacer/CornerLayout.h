@@ -0,0 +1,71 @@
+// CornerLayout.h
+#pragma once
+
+#include "PlanGeometry.h"
+#include "LoopHierarchy.h"
+#include "WallGraph.h"
+#include <vector>
+
+// Panel widths of the corner assemblies for one wall thickness, in mm; 0 leaves the part out
+struct CornerPanelSet {
+    int inside[2];          // panels either side of an inside corner post
+    int outside[6];         // outside corner panels, alternating between the two walls outward from the post
+    int compensator[2];     // closing the last panel on each wall to the thickness
+};
+
+// Wall corner as the corner placers see it
+struct WallCorner {
+    PlanPoint position;
+    int quadrant;           // orientation of the assembly (see Orientation.h): the edge leaving the corner, turned a quarter at a left turn
+    bool inside;            // concave from the formwork side: a corner post with a panel on each wall
+    int loop;
+    int vertex;
+    int node = -1;          // WallGraph joint the corner belongs to, -1 when its edges face no wall
+};
+
+enum class CornerPartKind {
+    Post,
+    Panel,
+    Compensator
+};
+
+struct CornerPart {
+    CornerPartKind kind;
+    int width;
+    int height;             // 1350 or 600 row
+    PlanPoint position;
+    double rotation;
+};
+
+// Corners of the wall loops and the posts, panels and compensators the corner placers put at
+// them. Pure geometry, no BRX dependencies; the placers look up the blocks and commit them.
+class CornerLayout {
+public:
+    // Width of the DC 135 * 10 corner post
+    static const int postWidth = 100;
+
+    // Panels for a wall `wallThickness` thick, 150 to 2100 in steps of 50; false for any other
+    static bool panelSet(double wallThickness, CornerPanelSet& set);
+
+    // Every corner of every loop at an L-joint, T-joint or crossing of `graph` (built on the same
+    // loops), and at vertices whose edges face no wall. Collinear vertices, the steps of an inline
+    // change of thickness and the ends of free-standing walls are skipped. Which side of a loop
+    // the wall is on comes from its depth in the hierarchy, so inside and outside do not depend on
+    // the order or direction the loops were drawn in.
+    static void corners(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy, const WallGraph& graph,
+        std::vector<WallCorner>& corners);
+
+    // Corner post and a panel on each wall, in 1350 then 600 rows up to `wallHeight`; compensators
+    // only on 150 thick walls
+    static void insideCorner(const WallCorner& corner, const CornerPanelSet& set, double wallThickness, int wallHeight,
+        std::vector<CornerPart>& parts);
+
+    // Corner post set out of the corner and up to three panels on each wall, in the same rows;
+    // compensators on every wall but a 150 thick one
+    static void outsideCorner(const WallCorner& corner, const CornerPanelSet& set, double wallThickness, int wallHeight,
+        std::vector<CornerPart>& parts);
+
+    // Inside or outside assembly at every corner
+    static void build(const std::vector<WallCorner>& corners, const CornerPanelSet& set, double wallThickness, int wallHeight,
+        std::vector<CornerPart>& parts);
+};
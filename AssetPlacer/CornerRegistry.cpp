@@ -0,0 +1,43 @@
+#include "CornerRegistry.h"
+#include <cmath>
+
+
+CornerRegistry::CornerRegistry(double tolerance)
+    : cellSize(tolerance > 0 ? tolerance : 1.0), count(0) {
+}
+
+
+bool CornerRegistry::isNear(const PlanPoint& point) const {
+    PointKey center = PointKey::of(point, cellSize);
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dz = -1; dz <= 1; ++dz) {
+                PointKey key = { center.x + dx, center.y + dy, center.z + dz };
+                const std::vector<PlanPoint>* cell = cells.find(key);
+                if (!cell) continue;
+
+                for (const auto& corner : *cell) {
+                    double ex = point.x - corner.x;
+                    double ey = point.y - corner.y;
+                    double ez = point.z - corner.z;
+                    if (std::sqrt(ex * ex + ey * ey + ez * ez) < cellSize) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+void CornerRegistry::add(const PlanPoint& point) {
+    cells[PointKey::of(point, cellSize)].push_back(point);
+    count++;
+}
+
+
+void CornerRegistry::clear() {
+    cells.clear();
+    count = 0;
+}
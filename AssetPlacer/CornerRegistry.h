@@ -0,0 +1,28 @@
+// CornerRegistry.h
+#pragma once
+
+#include "PlanGeometry.h"
+#include "PointKey.h"
+#include <vector>
+
+// Corners already handled during one placement command. Backed by a spatial hash with
+// tolerance-sized cells, so a proximity query only looks at the 27 neighbouring cells.
+// Create one per command run; nothing carries over between runs.
+class CornerRegistry {
+public:
+    explicit CornerRegistry(double tolerance);
+
+    // True when a registered corner lies closer than the tolerance
+    bool isNear(const PlanPoint& point) const;
+
+    void add(const PlanPoint& point);
+
+    size_t size() const { return count; }
+    double tolerance() const { return cellSize; }
+    void clear();
+
+private:
+    double cellSize;
+    size_t count;
+    PointMap<std::vector<PlanPoint>> cells;
+};
@@ -0,0 +1,469 @@
+#include "StdAfx.h"
+#include "GeometryStore.h"
+#include "LayoutCache.h"
+#include "WallThickness.h"
+#include "PolylineGeometry.h"
+#include "dbents.h"
+#include "dbdict.h"
+#include "dbxrecrd.h"
+#include "acutads.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include "Profiler.h"
+
+static const ACHAR* geometryDictionary = _T("PERI_GEOMETRY");
+
+// Corners closer than this (mm) to the previous vertex are dropped by processPolyline
+static const double cornerTolerance = 0.1;
+
+// A saved loop matches the polyline when every vertex is within this (mm)
+static const double vertexTolerance = 0.05;
+
+
+static std::wstring handleKey(const AcDbObjectId& id) {
+    ACHAR buffer[17] = { 0 };
+    id.handle().getIntoAsciiBuffer(buffer);
+    return buffer;
+}
+
+
+unsigned long long GeometryStore::fingerprint(const PlanLoop& loop) {
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](long long value) {
+        for (int byte = 0; byte < 8; ++byte) {
+            hash ^= static_cast<unsigned long long>(value >> (byte * 8)) & 0xff;
+            hash *= 0x100000001b3ULL;
+        }
+    };
+    mix(static_cast<long long>(loop.size()));
+    for (const PlanPoint& point : loop) {
+        mix(std::llround(point.x * 10));
+        mix(std::llround(point.y * 10));
+    }
+    return hash;
+}
+
+
+// Record of `loop`; false when it is not for these vertices or refers to a polyline that is gone
+static bool readRecord(const resbuf* pItem, const PlanLoop& loop, const std::map<std::wstring, int>& loopOfKey,
+    const std::vector<PlanLoop>& loops, int& parent, int& depth, bool& isClockwise, PlanLoop& corners,
+    std::vector<FaceThickness>& faces) {
+
+    auto next = [&pItem](short type) -> const resbuf* {
+        const resbuf* pCurrent = pItem;
+        if (!pCurrent || pCurrent->restype != type) {
+            return nullptr;
+        }
+        pItem = pItem->rbnext;
+        return pCurrent;
+    };
+    auto loopOf = [&loopOfKey](const resbuf* pKey) {
+        std::wstring key = pKey->resval.rstring ? pKey->resval.rstring : L"";
+        auto loopIt = loopOfKey.find(key);
+        return key.empty() ? -1 : (loopIt == loopOfKey.end() ? -2 : loopIt->second);
+    };
+
+    // Fingerprint first, so a record of other vertices is turned down without reading it
+    unsigned long long print = GeometryStore::fingerprint(loop);
+    const resbuf* pLow = next(AcDb::kDxfInt32);
+    const resbuf* pHigh = next(AcDb::kDxfInt32);
+    if (!pLow || !pHigh ||
+        static_cast<unsigned long>(pLow->resval.rlong) != static_cast<unsigned long>(print & 0xffffffffULL) ||
+        static_cast<unsigned long>(pHigh->resval.rlong) != static_cast<unsigned long>(print >> 32)) {
+        return false;
+    }
+
+    const resbuf* pParent = next(AcDb::kDxfText);
+    const resbuf* pDepth = next(AcDb::kDxfInt16);
+    const resbuf* pClockwise = next(AcDb::kDxfInt16);
+    const resbuf* pCount = next(AcDb::kDxfInt32);
+    if (!pParent || !pDepth || !pClockwise || !pCount || static_cast<size_t>(pCount->resval.rlong) != loop.size()) {
+        return false;
+    }
+    parent = loopOf(pParent);
+    depth = pDepth->resval.rint;
+    isClockwise = pClockwise->resval.rint != 0;
+    if (parent < -1) {
+        return false;
+    }
+
+    for (const PlanPoint& vertex : loop) {
+        const resbuf* pX = next(AcDb::kDxfReal);
+        const resbuf* pY = next(AcDb::kDxfReal);
+        const resbuf* pZ = next(AcDb::kDxfReal);
+        if (!pX || !pY || !pZ || std::fabs(pX->resval.rreal - vertex.x) > vertexTolerance ||
+            std::fabs(pY->resval.rreal - vertex.y) > vertexTolerance || std::fabs(pZ->resval.rreal - vertex.z) > vertexTolerance) {
+            return false;
+        }
+    }
+
+    const resbuf* pCornerCount = next(AcDb::kDxfInt32);
+    if (!pCornerCount || pCornerCount->resval.rlong < 0 || static_cast<size_t>(pCornerCount->resval.rlong) > loop.size()) {
+        return false;
+    }
+    corners.clear();
+    for (long cornerNum = 0; cornerNum < pCornerCount->resval.rlong; ++cornerNum) {
+        const resbuf* pX = next(AcDb::kDxfReal);
+        const resbuf* pY = next(AcDb::kDxfReal);
+        const resbuf* pZ = next(AcDb::kDxfReal);
+        if (!pX || !pY || !pZ) {
+            return false;
+        }
+        corners.push_back(makePlanPoint(pX->resval.rreal, pY->resval.rreal, pZ->resval.rreal));
+    }
+
+    faces.clear();
+    for (size_t edgeNum = 0; edgeNum < loop.size(); ++edgeNum) {
+        const resbuf* pMeasured = next(AcDb::kDxfReal);
+        const resbuf* pThickness = next(AcDb::kDxfReal);
+        const resbuf* pOpposite = next(AcDb::kDxfText);
+        const resbuf* pOppositeEdge = next(AcDb::kDxfInt32);
+        if (!pMeasured || !pThickness || !pOpposite || !pOppositeEdge) {
+            return false;
+        }
+        FaceThickness face = { pMeasured->resval.rreal, pThickness->resval.rreal, -1, -1 };
+
+        // The facing polyline has to be in the drawing still, with the edge in range
+        int opposite = loopOf(pOpposite);
+        if (opposite >= 0) {
+            int oppositeEdge = static_cast<int>(pOppositeEdge->resval.rlong);
+            if (oppositeEdge < 0 || oppositeEdge >= static_cast<int>(loops[opposite].size())) {
+                return false;
+            }
+            face.oppositeLoop = opposite;
+            face.oppositeEdge = oppositeEdge;
+        }
+        else if (opposite < -1) {
+            return false;
+        }
+        faces.push_back(face);
+    }
+    return true;
+}
+
+
+static resbuf* buildRecord(const std::vector<std::wstring>& keys, const WallGeometry& geometry, size_t loopNum) {
+    resbuf* pData = nullptr;
+    resbuf* pTail = nullptr;
+    auto link = [&pData, &pTail](resbuf* pItem) {
+        if (pTail) {
+            pTail->rbnext = pItem;
+        }
+        else {
+            pData = pItem;
+        }
+        pTail = pItem;
+        return pItem;
+    };
+    auto append = [&link](short type) {
+        return link(acutNewRb(type));
+    };
+    auto appendText = [&link](const std::wstring& text) {
+        link(acutBuildList(AcDb::kDxfText, text.c_str(), RTNONE));
+    };
+    auto appendPoint = [&append](const PlanPoint& point) {
+        append(AcDb::kDxfReal)->resval.rreal = point.x;
+        append(AcDb::kDxfReal)->resval.rreal = point.y;
+        append(AcDb::kDxfReal)->resval.rreal = point.z;
+    };
+
+    const PlanLoop& loop = geometry.loops[loopNum];
+    const LoopNode& node = geometry.hierarchy.node(loopNum);
+    unsigned long long print = GeometryStore::fingerprint(loop);
+    append(AcDb::kDxfInt32)->resval.rlong = static_cast<int>(print & 0xffffffffULL);
+    append(AcDb::kDxfInt32)->resval.rlong = static_cast<int>(print >> 32);
+    appendText(node.parent >= 0 ? keys[node.parent] : std::wstring());
+    append(AcDb::kDxfInt16)->resval.rint = static_cast<short>(node.depth);
+    append(AcDb::kDxfInt16)->resval.rint = node.isClockwise ? 1 : 0;
+    append(AcDb::kDxfInt32)->resval.rlong = static_cast<int>(loop.size());
+    for (const PlanPoint& vertex : loop) {
+        appendPoint(vertex);
+    }
+    append(AcDb::kDxfInt32)->resval.rlong = static_cast<int>(geometry.corners[loopNum].size());
+    for (const PlanPoint& corner : geometry.corners[loopNum]) {
+        appendPoint(corner);
+    }
+    for (const FaceThickness& face : geometry.graph.faces()[loopNum]) {
+        append(AcDb::kDxfReal)->resval.rreal = face.measured;
+        append(AcDb::kDxfReal)->resval.rreal = face.thickness;
+        appendText(face.oppositeLoop >= 0 ? keys[face.oppositeLoop] : std::wstring());
+        append(AcDb::kDxfInt32)->resval.rlong = face.oppositeEdge;
+    }
+    return pData;
+}
+
+
+void GeometryStore::scan(AcDbDatabase* pDb, WallGeometry& geometry) {
+    Profiler::Phase phase("scan_polylines");
+    AcDbBlockTable* pBlockTable;
+    Profiler::count(ProfileCounter::BlockTableOpens);
+    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to get block table."));
+        return;
+    }
+
+    AcDbBlockTableRecord* pModelSpace;
+    if (pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to get model space."));
+        pBlockTable->close();
+        return;
+    }
+    pBlockTable->close();
+
+    AcDbBlockTableRecordIterator* pIter;
+    if (pModelSpace->newIterator(pIter) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to create iterator."));
+        pModelSpace->close();
+        return;
+    }
+
+    for (pIter->start(); !pIter->done(); pIter->step()) {
+        AcDbEntity* pEnt;
+        Profiler::count(ProfileCounter::ObjectsOpened);
+        if (pIter->getEntity(pEnt, AcDb::kForRead) != Acad::eOk) {
+            continue;
+        }
+        AcDbPolyline* pPolyline = AcDbPolyline::cast(pEnt);
+        if (pPolyline && pPolyline->isClosed()) {
+            PlanLoop loop;
+            int numVerts = pPolyline->numVerts();
+            for (int vertexNum = 0; vertexNum < numVerts; ++vertexNum) {
+                AcGePoint3d vertex;
+                if (pPolyline->getPointAt(vertexNum, vertex) == Acad::eOk) {
+                    loop.push_back(makePlanPoint(vertex.x, vertex.y, vertex.z));
+                }
+            }
+            geometry.polylineIds.push_back(pEnt->objectId());
+            geometry.loops.push_back(loop);
+        }
+        pEnt->close();
+    }
+
+    delete pIter;
+    pModelSpace->close();
+}
+
+
+void GeometryStore::restore(AcDbDatabase* pDb, const std::vector<std::wstring>& keys, const std::vector<PlanLoop>& loops,
+    std::vector<Record>& records, std::vector<char>& found) {
+
+    records.assign(loops.size(), Record());
+    found.assign(loops.size(), 0);
+
+    AcDbDictionary* pNamedObjects;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (pDb->getNamedObjectsDictionary(pNamedObjects, AcDb::kForRead) != Acad::eOk) {
+        return;
+    }
+    AcDbObject* pObject;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    Acad::ErrorStatus es = pNamedObjects->getAt(geometryDictionary, pObject, AcDb::kForRead);
+    pNamedObjects->close();
+    if (es != Acad::eOk) {
+        return;
+    }
+    AcDbDictionary* pGeometry = AcDbDictionary::cast(pObject);
+    if (!pGeometry) {
+        pObject->close();
+        return;
+    }
+
+    std::map<std::wstring, int> loopOfKey;
+    for (size_t loopNum = 0; loopNum < keys.size(); ++loopNum) {
+        loopOfKey[keys[loopNum]] = static_cast<int>(loopNum);
+    }
+
+    for (size_t loopNum = 0; loopNum < loops.size(); ++loopNum) {
+        AcDbObject* pRecordObject;
+        Profiler::count(ProfileCounter::ObjectsOpened);
+        if (pGeometry->getAt(keys[loopNum].c_str(), pRecordObject, AcDb::kForRead) != Acad::eOk) {
+            continue;
+        }
+        AcDbXrecord* pRecord = AcDbXrecord::cast(pRecordObject);
+        resbuf* pData = nullptr;
+        if (pRecord && pRecord->rbChain(&pData) == Acad::eOk && pData) {
+            Record& record = records[loopNum];
+            found[loopNum] = readRecord(pData, loops[loopNum], loopOfKey, loops, record.parent, record.depth,
+                record.isClockwise, record.corners, record.faces) ? 1 : 0;
+            acutRelRb(pData);
+        }
+        pRecordObject->close();
+    }
+    pGeometry->close();
+}
+
+
+void GeometryStore::save(AcDbDatabase* pDb, const std::vector<std::wstring>& keys, const WallGeometry& geometry,
+    const std::vector<char>& stale) {
+
+    AcDbDictionary* pNamedObjects;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (pDb->getNamedObjectsDictionary(pNamedObjects, AcDb::kForWrite) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to open the named object dictionary."));
+        return;
+    }
+
+    AcDbDictionary* pGeometry = nullptr;
+    AcDbObject* pObject;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (pNamedObjects->getAt(geometryDictionary, pObject, AcDb::kForWrite) == Acad::eOk) {
+        pGeometry = AcDbDictionary::cast(pObject);
+        if (!pGeometry) {
+            pObject->close();
+        }
+    }
+    else {
+        pGeometry = new AcDbDictionary();
+        AcDbObjectId geometryId;
+        if (pNamedObjects->setAt(geometryDictionary, pGeometry, geometryId) != Acad::eOk) {
+            delete pGeometry;
+            pGeometry = nullptr;
+        }
+    }
+    pNamedObjects->close();
+
+    if (!pGeometry) {
+        acutPrintf(_T("\nFailed to store the wall geometry in the drawing."));
+        return;
+    }
+
+    // Records of polylines that are gone
+    std::map<std::wstring, int> loopOfKey;
+    for (size_t loopNum = 0; loopNum < keys.size(); ++loopNum) {
+        loopOfKey[keys[loopNum]] = static_cast<int>(loopNum);
+    }
+    std::vector<std::wstring> orphans;
+    AcDbDictionaryIterator* pIter = pGeometry->newIterator();
+    for (; pIter && !pIter->done(); pIter->next()) {
+        if (loopOfKey.find(pIter->name()) == loopOfKey.end()) {
+            orphans.push_back(pIter->name());
+        }
+    }
+    delete pIter;
+    for (const auto& orphan : orphans) {
+        pGeometry->remove(orphan.c_str());
+    }
+
+    for (size_t loopNum = 0; loopNum < geometry.loops.size(); ++loopNum) {
+        if (!stale[loopNum]) {
+            continue;
+        }
+
+        AcDbXrecord* pRecord = nullptr;
+        AcDbObject* pRecordObject;
+        Profiler::count(ProfileCounter::ObjectsOpened);
+        if (pGeometry->getAt(keys[loopNum].c_str(), pRecordObject, AcDb::kForWrite) == Acad::eOk) {
+            pRecord = AcDbXrecord::cast(pRecordObject);
+            if (!pRecord) {
+                pRecordObject->close();
+                continue;
+            }
+        }
+        else {
+            pRecord = new AcDbXrecord();
+            AcDbObjectId recordId;
+            if (pGeometry->setAt(keys[loopNum].c_str(), pRecord, recordId) != Acad::eOk) {
+                delete pRecord;
+                continue;
+            }
+        }
+
+        resbuf* pData = buildRecord(keys, geometry, loopNum);
+        if (pData) {
+            pRecord->setFromRbChain(*pData);
+            acutRelRb(pData);
+        }
+        pRecord->close();
+    }
+    pGeometry->close();
+}
+
+
+const WallGeometry* GeometryStore::geometry(AcDbDatabase* pDb, std::vector<char>* measured) {
+    if (measured) {
+        measured->clear();
+    }
+    if (!pDb) {
+        return nullptr;
+    }
+    const WallGeometry* cached = LayoutCache::findGeometry(pDb);
+    if (cached) {
+        if (measured) {
+            measured->assign(cached->loops.size(), 0);
+        }
+        return cached;
+    }
+
+    WallGeometry geometry;
+    scan(pDb, geometry);
+    const std::vector<PlanLoop>& loops = geometry.loops;
+    std::vector<std::wstring> keys;
+    keys.reserve(geometry.polylineIds.size());
+    for (const auto& polylineId : geometry.polylineIds) {
+        keys.push_back(handleKey(polylineId));
+    }
+
+    std::vector<Record> records;
+    std::vector<char> found;
+    {
+        Profiler::Phase phase("geometry_restore");
+        restore(pDb, keys, loops, records, found);
+    }
+
+    // The saved tree holds while every polyline has its record; else it is built again, and the
+    // loops whose place in it changed are analysed again with the ones that had no record
+    bool restored = false;
+    if (std::find(found.begin(), found.end(), 0) == found.end()) {
+        std::vector<int> parents;
+        for (const Record& record : records) {
+            parents.push_back(record.parent);
+        }
+        restored = geometry.hierarchy.restore(loops, parents);
+    }
+    if (!restored) {
+        Profiler::Phase phase("loop_hierarchy");
+        geometry.hierarchy.build(loops);
+    }
+
+    std::vector<char> stale(loops.size(), 1);
+    std::vector<std::vector<FaceThickness>> faces(loops.size());
+    geometry.corners.assign(loops.size(), PlanLoop());
+    bool anyStale = false;
+    for (size_t loopNum = 0; loopNum < loops.size(); ++loopNum) {
+        const LoopNode& node = geometry.hierarchy.node(loopNum);
+        const Record& record = records[loopNum];
+        if (found[loopNum] && node.parent == record.parent && node.depth == record.depth && node.isClockwise == record.isClockwise) {
+            stale[loopNum] = 0;
+            faces[loopNum] = record.faces;
+            geometry.corners[loopNum] = record.corners;
+        }
+        else {
+            processPolyline(loops[loopNum], geometry.corners[loopNum], cornerTolerance);
+            anyStale = true;
+        }
+    }
+
+    if (anyStale) {
+        {
+            Profiler::Phase phase("wall_thickness");
+            WallThickness::measure(loops, geometry.hierarchy, faces, stale);
+        }
+        if (measured) {
+            *measured = stale;
+        }
+    }
+    else if (measured) {
+        measured->assign(loops.size(), 0);
+    }
+    {
+        Profiler::Phase phase("wall_graph");
+        geometry.graph.build(loops, geometry.hierarchy, faces);
+    }
+    if (anyStale) {
+        save(pDb, keys, geometry, stale);
+    }
+
+    LayoutCache::storeGeometry(pDb, geometry);
+    return LayoutCache::findGeometry(pDb);
+}
@@ -0,0 +1,52 @@
+// GeometryStore.h
+#pragma once
+
+#include <string>
+#include <vector>
+#include "dbmain.h"
+#include "PlanGeometry.h"
+#include "LoopHierarchy.h"
+#include "WallGraph.h"
+
+// Closed wall polylines of a drawing and their analysis, shared by every placer
+struct WallGeometry {
+    std::vector<AcDbObjectId> polylineIds;
+    std::vector<PlanLoop> loops;            // polyline vertices
+    std::vector<PlanLoop> corners;          // vertices closer than 0.1 mm to the previous one dropped, empty under 3
+    LoopHierarchy hierarchy;
+    WallGraph graph;                        // wall centrelines and joints, with the thickness of every face
+};
+
+// Wall geometry analysis saved with the drawing, so a reopened drawing does not classify its
+// loops or pair its wall faces again. The PERI_GEOMETRY dictionary in the named object
+// dictionary holds one Xrecord per closed polyline, keyed by the polyline handle: a fingerprint
+// of its vertices, its loop classification (parent handle, depth and direction), the loop and
+// its corners, and the thickness and facing edge of every edge. A record is used while the
+// polyline still matches it; only the other polylines and their neighbours are analysed again,
+// and their records rewritten.
+class GeometryStore {
+public:
+    // Geometry of the closed polylines in model space: the one cached for this session, else
+    // read from the polylines with the saved analysis plus whatever changed since. `measured`
+    // flags the loops whose faces were measured again for this call. nullptr without a drawing.
+    static const WallGeometry* geometry(AcDbDatabase* pDb, std::vector<char>* measured = nullptr);
+
+    // Hash of the vertex count and the vertices on a 0.1 mm grid; stands in for a modification
+    // counter, which the database does not keep per object
+    static unsigned long long fingerprint(const PlanLoop& loop);
+
+private:
+    struct Record {
+        int parent;         // loop index, -1 for a top-level loop
+        int depth;
+        bool isClockwise;
+        PlanLoop corners;
+        std::vector<FaceThickness> faces;
+    };
+
+    static void scan(AcDbDatabase* pDb, WallGeometry& geometry);
+    static void restore(AcDbDatabase* pDb, const std::vector<std::wstring>& keys, const std::vector<PlanLoop>& loops,
+        std::vector<Record>& records, std::vector<char>& found);
+    static void save(AcDbDatabase* pDb, const std::vector<std::wstring>& keys, const WallGeometry& geometry,
+        const std::vector<char>& stale);
+};
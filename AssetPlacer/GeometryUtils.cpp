@@ -1,5 +1,7 @@
 #include "StdAfx.h"
 #include "GeometryUtils.h"
+#include "GeometryStore.h"
+#include "PolylineGeometry.h"
 #include "SharedDefinations.h"
 #include <cmath>
 #include <typeinfo>
@@ -12,6 +14,7 @@
 #include "AcDb/AcDbBlockReference.h"
 #include <sstream>
 #include <iostream>
+#include "Profiler.h"
 
 
 const double TOLERANCE = 0.19;
@@ -25,6 +28,25 @@ T clamp(T value, T min, T max) {
 }
 
 
+static PlanLoop planLoopOf(const std::vector<AcGePoint3d>& points) {
+    PlanLoop loop;
+    loop.reserve(points.size());
+    for (const AcGePoint3d& point : points) {
+        loop.push_back(makePlanPoint(point.x, point.y, point.z));
+    }
+    return loop;
+}
+
+
+static void assignPoints(const PlanLoop& loop, std::vector<AcGePoint3d>& points) {
+    points.clear();
+    points.reserve(loop.size());
+    for (const PlanPoint& point : loop) {
+        points.push_back(AcGePoint3d(point.x, point.y, point.z));
+    }
+}
+
+
 double calculateAngle(const AcGeVector3d& v1, const AcGeVector3d& v2) {
     
     AcGeVector3d normV1 = v1.normal();
@@ -208,52 +230,15 @@ void logAngle(double angle, const char* message) {
 }
 
 
+// Same corners as processPolyline on plan points (PolylineGeometry); angleThreshold is not used
 void processPolyline(const AcDbPolyline* pPolyline, std::vector<AcGePoint3d>& corners, double angleThreshold, double tolerance) {
-    
     std::vector<AcGePoint3d> vertices;
     detectVertices(pPolyline, vertices);
 
-    filterClosePoints(vertices, tolerance);
-
-    size_t numVerts = vertices.size();
-    if (numVerts < 3) {
-        
-        return;
-    }
-
-    
-    for (size_t i = 0; i < numVerts; ++i) {  
-        AcGeVector3d currentDirection, nextDirection;
-
-        
-        currentDirection = vertices[(i + 1) % numVerts] - vertices[i];
-        currentDirection.normalize();  
-
-        
-        if (i > 0) {
-            nextDirection = vertices[i] - vertices[i - 1];
-        }
-        else {
-            nextDirection = vertices[i] - vertices[numVerts - 1];  
-        }
-        nextDirection.normalize();  
-
-        
-        double angle = calculateAngle(currentDirection, nextDirection);
-
-        
-        if (areAnglesEqual(angle, angleThreshold, tolerance)) {
-            corners.push_back(vertices[i]);
-        }
-        else {
-            
-            corners.push_back(vertices[i]);
-        }
-    }
-
-    
-    if (std::find(corners.begin(), corners.end(), vertices.back()) == corners.end()) {
-        corners.push_back(vertices.back());
+    PlanLoop planCorners;
+    processPolyline(planLoopOf(vertices), planCorners, tolerance);
+    for (const PlanPoint& corner : planCorners) {
+        corners.push_back(AcGePoint3d(corner.x, corner.y, corner.z));
     }
 }
 
@@ -337,57 +322,6 @@ std::vector<AcGePoint3d> getPolylineVertices(AcDbPolyline* pPolyline) {
 }
 
 
-double getPolylineDistance(AcDbPolyline* pPolyline1, AcDbPolyline* pPolyline2) {
-    
-    std::vector<AcGePoint3d> vertices1 = getPolylineVertices(pPolyline1);
-
-    
-    std::vector<AcGePoint3d> vertices2 = getPolylineVertices(pPolyline2);
-
-    
-    size_t minSize = std::min(vertices1.size(), vertices2.size());
-
-    
-    std::vector<double> predeterminedValues = { 150, 200, 250, 300, 350, 400, 450, 500, 550, 600,
-                                                650, 700, 750, 800, 850, 900, 950, 1000, 1050, 1100,
-                                                1150, 1200, 1250, 1300, 1350, 1400, 1450, 1500,
-                                                1550, 1600, 1650, 1700, 1750, 1800, 1850, 1900, 1950, 2000,
-                                                2050, 2100 };
-
-    double totalDistance = 0.0;
-
-    for (size_t i = 0; i < minSize; ++i) {
-        double deltaX = vertices2[i].x - vertices1[i].x;
-        double deltaY = vertices2[i].y - vertices1[i].y;
-
-        if (fabs(deltaX - deltaY) < 1e-6) {
-            
-            totalDistance = deltaX; 
-        }
-        else {
-            
-            double distance = sqrt(deltaX * deltaX + deltaY * deltaY);
-            double closestValue = predeterminedValues[0];
-            double minDifference = fabs(distance - closestValue);
-            
-            for (double value : predeterminedValues) {
-                double difference = fabs(distance - value);
-                if (difference < minDifference) {
-                    minDifference = difference;
-                    closestValue = value;
-                }
-            }
-            totalDistance = closestValue;
-        }
-    }
-    
-	
-    
-
-    return totalDistance;
-}
-
-
 std::vector<AcGePoint3d> forcePolylineClockwise(std::vector<AcGePoint3d>& points) {
     if (points.empty()) return points;
 
@@ -402,29 +336,7 @@ std::vector<AcGePoint3d> forcePolylineClockwise(std::vector<AcGePoint3d>& points
 
 
 bool isPolylineClockwise(const std::vector<AcGePoint3d>& points) {
-    double sum = 0.0;
-    const double tolerance = 1e-6;
-
-    for (size_t i = 0; i < points.size(); ++i) {
-        AcGePoint3d current = points[i];
-        AcGePoint3d next = points[(i + 1) % points.size()];
-
-        double contribution = (next.x - current.x) * (next.y + current.y);
-        sum += contribution;
-    }
-
-    if (sum > tolerance) {
-        
-        return true;
-    }
-    else if (sum < -tolerance) {
-        
-        return false;
-    }
-    else {
-        
-        return false; 
-    }
+    return isPolylineClockwise(planLoopOf(points));
 }
 
 
@@ -460,27 +372,9 @@ bool isInsideCorner(const std::vector<AcGePoint3d>& polylinePoints, size_t curre
 
 
 void filterClosePoints(std::vector<AcGePoint3d>& vertices, double tolerance) {
-    std::vector<AcGePoint3d> filteredVertices;
-    
-
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        
-        if (i == 0 || vertices[i].distanceTo(vertices[i - 1]) > tolerance) {
-            filteredVertices.push_back(vertices[i]);
-        }
-        else {
-            
-                
-        }
-    }
-
-    
-    if (filteredVertices.size() > 1 && filteredVertices.back().distanceTo(filteredVertices.front()) <= tolerance) {
-        
-        filteredVertices.pop_back();
-    }
-
-    vertices.swap(filteredVertices);
+    PlanLoop loop = planLoopOf(vertices);
+    filterClosePoints(loop, tolerance);
+    assignPoints(loop, vertices);
 }
 
 
@@ -501,57 +395,23 @@ bool isItInteger(double value, double tolerance) {
 
 
 double calculateDistanceBetweenPolylines() {
+    Profiler::Phase phase("polyline_distance");
     AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-    if (!pDb) {
-        return -1.0;
-    }
+    const WallGeometry* geometry = GeometryStore::geometry(pDb);
+    double distance = geometry ? geometry->graph.dominantThickness() : 0.0;
+    return distance > 0 ? distance : -1.0;
+}
 
-    AcDbBlockTable* pBlockTable;
-    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
-        return -1.0;
-    }
 
-    AcDbBlockTableRecord* pModelSpace;
-    if (pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead) != Acad::eOk) {
-        pBlockTable->close();
-        return -1.0;
-    }
-
-    AcDbBlockTableRecordIterator* pIter;
-    if (pModelSpace->newIterator(pIter) != Acad::eOk) {
-        pModelSpace->close();
-        pBlockTable->close();
-        return -1.0;
+bool wallPolylineCorners(std::vector<AcGePoint3d>& corners) {
+    const WallGeometry* geometry = GeometryStore::geometry(acdbHostApplicationServices()->workingDatabase());
+    if (!geometry) {
+        return false;
     }
-
-    AcDbPolyline* pFirstPolyline = nullptr;
-    AcDbPolyline* pSecondPolyline = nullptr;
-
-    
-    for (pIter->start(); !pIter->done(); pIter->step()) {
-        AcDbEntity* pEnt;
-        if (pIter->getEntity(pEnt, AcDb::kForRead) == Acad::eOk) {
-            if (pEnt->isKindOf(AcDbPolyline::desc())) {
-                if (!pFirstPolyline) {
-                    pFirstPolyline = AcDbPolyline::cast(pEnt);
-                }
-                else if (!pSecondPolyline) {
-                    pSecondPolyline = AcDbPolyline::cast(pEnt);
-                    pEnt->close();
-                    break; 
-                }
-            }
-            pEnt->close();
+    for (const PlanLoop& loop : geometry->corners) {
+        for (const PlanPoint& corner : loop) {
+            corners.push_back(AcGePoint3d(corner.x, corner.y, corner.z));
         }
     }
-
-    double distance = -1.0;
-    if (pFirstPolyline && pSecondPolyline) {
-        distance = getPolylineDistance(pFirstPolyline, pSecondPolyline);
-    }
-
-    delete pIter;
-    pModelSpace->close();
-    pBlockTable->close();
-    return distance;
-}
\ No newline at end of file
+    return true;
+}
@@ -7,7 +7,11 @@
 double calculateAngle(const AcGeVector3d& v1, const AcGeVector3d& v2);
 bool areAnglesEqual(double angle1, double angle2, double tolerance);
 double normalizeAngle(double angle);
+// Wall thickness covering most of the closed polylines in model space, -1 when no faces pair up
 double calculateDistanceBetweenPolylines();
+// Corners of every closed polyline in model space, loop after loop, from the geometry analysed
+// once per drawing (see GeometryStore); false without a drawing
+bool wallPolylineCorners(std::vector<AcGePoint3d>& corners);
 double snapToExactAngle(double angle, double tolerance);
 void adjustStartAndEndPoints(AcGePoint3d& start, AcGePoint3d& end, double tolerance = 0.5);
 AcGeVector3d calculateCardinalDirection(const AcGePoint3d& start, const AcGePoint3d& end, double tolerance = 0.5);
@@ -22,7 +26,6 @@ void rotateAroundXAxis(AcDbBlockReference* pBlockRef, double angle);
 void rotateAroundYAxis(AcDbBlockReference* pBlockRef, double angle);
 void rotateAroundZAxis(AcDbBlockReference* pBlockRef, double angle);
 std::vector<AcGePoint3d> getPolylineVertices(AcDbPolyline* pPolyline);
-double getPolylineDistance(AcDbPolyline* pPolyline1, AcDbPolyline* pPolyline2);
 bool isPolylineClosed(const AcDbPolyline* pPolyline);
 std::vector<AcGePoint3d> forcePolylineClockwise(std::vector<AcGePoint3d>& points);
 bool isPolylineClockwise(const std::vector<AcGePoint3d>& points);
@@ -31,4 +34,4 @@ bool isInsideCorner(const std::vector<AcGePoint3d>& polylinePoints, size_t curre
 void filterClosePoints(std::vector<AcGePoint3d>& vertices, double tolerance);
 void adjustRotationForCorner(double& rotation, const std::vector<AcGePoint3d>& corners, size_t cornerNum);
 // GeometryUtils.h (or wherever the function is declared)
-bool isItInteger(double value, double tolerance = 1e-9);
\ No newline at end of file
+bool isItInteger(double value, double tolerance = 1e-9);
@@ -0,0 +1,131 @@
+#include "StdAfx.h"
+#include "LayoutCache.h"
+#include "dbents.h"
+
+std::map<const AcDbDatabase*, LayoutCache::DatabaseCache> LayoutCache::caches;
+
+
+class LayoutCacheReactor : public AcDbDatabaseReactor {
+public:
+    void objectAppended(const AcDbDatabase* pDb, const AcDbObject* pObj) override {
+        checkPolyline(pDb, pObj);
+    }
+
+    void objectModified(const AcDbDatabase* pDb, const AcDbObject* pObj) override {
+        checkPolyline(pDb, pObj);
+    }
+
+    void objectErased(const AcDbDatabase* pDb, const AcDbObject* pObj, Adesk::Boolean erased) override {
+        if (AcDbBlockReference::cast(pObj)) {
+            LayoutCache::invalidate(pDb);
+            return;
+        }
+        checkPolyline(pDb, pObj);
+    }
+
+    void goodbye(const AcDbDatabase* pDb) override {
+        LayoutCache::forget(pDb);
+    }
+
+private:
+    void checkPolyline(const AcDbDatabase* pDb, const AcDbObject* pObj) {
+        AcDbPolyline* pPolyline = AcDbPolyline::cast(pObj);
+        if (pPolyline && pPolyline->isClosed()) {
+            LayoutCache::invalidate(pDb);
+            LayoutCache::invalidateGeometry(pDb);
+        }
+    }
+};
+
+
+LayoutCache::DatabaseCache& LayoutCache::cacheFor(AcDbDatabase* pDb) {
+    auto cacheIt = caches.find(pDb);
+    if (cacheIt == caches.end()) {
+        DatabaseCache cache;
+        cache.valid = false;
+        cache.geometryValid = false;
+        cache.reactor = new LayoutCacheReactor();
+        pDb->addReactor(cache.reactor);
+        cacheIt = caches.emplace(pDb, cache).first;
+    }
+    return cacheIt->second;
+}
+
+
+void LayoutCache::store(AcDbDatabase* pDb, const LayoutPlan& plan, double wallThickness, int wallHeight) {
+    if (!pDb) {
+        return;
+    }
+
+    DatabaseCache& cache = cacheFor(pDb);
+    cache.entry = { plan, wallThickness, wallHeight };
+    cache.valid = true;
+}
+
+
+void LayoutCache::storeGeometry(AcDbDatabase* pDb, const WallGeometry& geometry) {
+    if (!pDb) {
+        return;
+    }
+
+    DatabaseCache& cache = cacheFor(pDb);
+    cache.geometry = geometry;
+    cache.geometryValid = true;
+}
+
+
+const WallGeometry* LayoutCache::findGeometry(const AcDbDatabase* pDb) {
+    auto cacheIt = caches.find(pDb);
+    if (cacheIt == caches.end() || !cacheIt->second.geometryValid) {
+        return nullptr;
+    }
+    return &cacheIt->second.geometry;
+}
+
+
+const LayoutCache::Entry* LayoutCache::find(const AcDbDatabase* pDb, int wallHeight) {
+    auto cacheIt = caches.find(pDb);
+    if (cacheIt == caches.end() || !cacheIt->second.valid || cacheIt->second.entry.wallHeight != wallHeight) {
+        return nullptr;
+    }
+    return &cacheIt->second.entry;
+}
+
+
+void LayoutCache::invalidate(const AcDbDatabase* pDb) {
+    auto cacheIt = caches.find(pDb);
+    if (cacheIt != caches.end() && cacheIt->second.valid) {
+        cacheIt->second.valid = false;
+        cacheIt->second.entry.plan.clear();
+    }
+}
+
+
+void LayoutCache::invalidateGeometry(const AcDbDatabase* pDb) {
+    auto cacheIt = caches.find(pDb);
+    if (cacheIt != caches.end() && cacheIt->second.geometryValid) {
+        cacheIt->second.geometryValid = false;
+        cacheIt->second.geometry = WallGeometry();
+    }
+}
+
+
+void LayoutCache::forget(const AcDbDatabase* pDb) {
+    auto cacheIt = caches.find(pDb);
+    if (cacheIt == caches.end()) {
+        return;
+    }
+
+    LayoutCacheReactor* pReactor = cacheIt->second.reactor;
+    caches.erase(cacheIt);
+    delete pReactor;
+}
+
+
+void LayoutCache::shutdown() {
+    for (auto& cache : caches) {
+        const_cast<AcDbDatabase*>(cache.first)->removeReactor(cache.second.reactor);
+        delete cache.second.reactor;
+    }
+    caches.clear();
+}
@@ -0,0 +1,52 @@
+// LayoutCache.h
+#pragma once
+
+#include <map>
+#include "dbmain.h"
+#include "WallLayout.h"
+#include "GeometryStore.h"
+
+class LayoutCacheReactor;
+
+// Wall layout of the last PlaceWalls run, kept per database so later commands (ties,
+// connectors) can work from the placed panels instead of laying the walls out again.
+// The layout is dropped when a closed polyline is added, changed or erased, when a block
+// reference is erased (undo of PlaceWalls included), and with the database.
+// The analysed wall geometry of the polylines is kept next to it and only dropped with polyline edits.
+class LayoutCache {
+public:
+    struct Entry {
+        LayoutPlan plan;
+        double wallThickness;
+        int wallHeight;
+    };
+
+    static void store(AcDbDatabase* pDb, const LayoutPlan& plan, double wallThickness, int wallHeight);
+
+    // nullptr when nothing is cached or the layout was made for another wall height
+    static const Entry* find(const AcDbDatabase* pDb, int wallHeight);
+
+    static void storeGeometry(AcDbDatabase* pDb, const WallGeometry& geometry);
+
+    // nullptr when the polylines changed since the geometry was stored
+    static const WallGeometry* findGeometry(const AcDbDatabase* pDb);
+
+    static void invalidate(const AcDbDatabase* pDb);
+    static void invalidateGeometry(const AcDbDatabase* pDb);
+    static void shutdown();
+
+private:
+    struct DatabaseCache {
+        Entry entry;
+        bool valid;
+        WallGeometry geometry;
+        bool geometryValid;
+        LayoutCacheReactor* reactor;
+    };
+
+    friend class LayoutCacheReactor;
+    static DatabaseCache& cacheFor(AcDbDatabase* pDb);
+    static void forget(const AcDbDatabase* pDb);
+
+    static std::map<const AcDbDatabase*, DatabaseCache> caches;
+};
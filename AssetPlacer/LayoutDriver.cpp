@@ -0,0 +1,472 @@
+#include "LayoutDriver.h"
+#include "CornerLayout.h"
+#include "LoopHierarchy.h"
+#include "PointKey.h"
+#include "PolylineGeometry.h"
+#include "CornerRegistry.h"
+#include "PanelFillSolver.h"
+#include "SegmentGrid.h"
+#include "WallGraph.h"
+#include "WallThickness.h"
+#include "Blocks/StubDatabase.h"
+#include "Tie/TieLayout.h"
+#include "WallPanelConnectors/ConnectorLayout.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+
+
+static double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+
+// Panels of a layout in the four sets the connector placers select from the PanelIndex.
+// Catalogue widths up to 100 are wall thickness compensators.
+struct ConnectorPanelSets {
+    std::vector<ConnectorPanel> wallPanels;     // WallPanelConnector: all but the 1200 high panels
+    std::vector<ConnectorPanel> walers;         // WalerConnector: 100 wide compensators
+    std::vector<ConnectorPanel> stacked;        // StackedWallPanelConnectors: panels but the 150 wide
+    std::vector<ConnectorPanel> stacked15;      // Stacked15PanelConnector: 150 wide panels
+};
+
+
+static void selectConnectorPanels(const LayoutPlan& layout, ConnectorPanelSets& sets) {
+    for (const LayoutItem& item : layout.items) {
+        ConnectorPanel panel = { item.position, item.rotation, static_cast<double>(item.width), 1, false };
+        if (item.width <= 100) {
+            if (item.width == 100) {
+                panel.levels = item.height == 1350 ? 2 : 1;
+                sets.walers.push_back(panel);
+            }
+            continue;
+        }
+        if (item.height != 1200) {
+            panel.levels = item.height == 600 ? 2 : 3;
+            sets.wallPanels.push_back(panel);
+            panel.levels = 1;
+        }
+        (item.width == 150 ? sets.stacked15 : sets.stacked).push_back(panel);
+    }
+}
+
+
+// Corner assemblies as the connector placers find them in the PanelIndex: posts and panels take
+// wall panel connectors, the panels stacked connectors too, 100 wide compensators walers
+static void addCornerPanels(const std::vector<CornerPart>& parts, ConnectorPanelSets& sets) {
+    for (const CornerPart& part : parts) {
+        ConnectorPanel panel = { part.position, part.rotation, static_cast<double>(part.width),
+            part.height == 600 ? 2 : 3, part.kind == CornerPartKind::Post };
+        if (part.kind == CornerPartKind::Compensator) {
+            if (part.width == 100) {
+                panel.levels = part.height == 1350 ? 2 : 1;
+                sets.walers.push_back(panel);
+            }
+            continue;
+        }
+        sets.wallPanels.push_back(panel);
+        if (part.kind == CornerPartKind::Panel) {
+            panel.levels = 1;
+            (part.width == 150 ? sets.stacked15 : sets.stacked).push_back(panel);
+        }
+    }
+}
+
+
+// Vertex lookups of the placers at a million points: every point inserted, then looked up again
+// with floating point noise added, in PointMap and in a std::map with an exact comparator
+static void benchmarkPointMap(unsigned seed, std::ostream& csv) {
+    const int count = 1000000;
+    std::vector<PlanPoint> points;
+    points.reserve(count);
+    std::uint32_t state = seed * 2654435761u + 1;
+    for (int i = 0; i < count; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        points.push_back(makePlanPoint((state % 100000) * 1.0, (state / 100000 % 100000) * 1.0, 0.0));
+    }
+    auto row = [&](const char* stage, double ms, size_t found) {
+        csv << "points-" << points.size() << ',' << seed << ",0," << points.size() << ','
+            << stage << ",1," << ms << ',' << found << "\n";
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    PointMap<int> pointMap;
+    for (int i = 0; i < count; ++i) {
+        pointMap[PointKey::of(points[i])] = i;
+    }
+    size_t found = 0;
+    for (const PlanPoint& point : points) {
+        found += pointMap.contains(PointKey::of(point.x + 1e-7, point.y, point.z)) ? 1 : 0;
+    }
+    row("point_map", elapsedMs(start), found);
+
+    auto exactLess = [](const PlanPoint& lhs, const PlanPoint& rhs) {
+        if (lhs.x != rhs.x) return lhs.x < rhs.x;
+        if (lhs.y != rhs.y) return lhs.y < rhs.y;
+        return lhs.z < rhs.z;
+    };
+    start = std::chrono::steady_clock::now();
+    std::map<PlanPoint, int, decltype(exactLess)> exactMap(exactLess);
+    for (int i = 0; i < count; ++i) {
+        exactMap[points[i]] = i;
+    }
+    found = 0;
+    for (const PlanPoint& point : points) {
+        found += exactMap.count(makePlanPoint(point.x + 1e-7, point.y, point.z));
+    }
+    row("exact_point_map", elapsedMs(start), found);
+}
+
+
+bool LayoutDriver::readPlan(std::istream& in, PlanInput& plan, std::string& error) {
+    plan.loops.clear();
+    PlanLoop current;
+    std::string line;
+    int lineNumber = 0;
+
+    auto closeLoop = [&]() {
+        if (current.size() >= 3) {
+            plan.loops.push_back(current);
+        }
+        current.clear();
+    };
+
+    while (std::getline(in, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+
+        std::istringstream fields(line);
+        std::string word;
+        if (!(fields >> word)) {
+            closeLoop();
+            continue;
+        }
+
+        if (word == "loop") {
+            closeLoop();
+            continue;
+        }
+        if (word == "thickness" || word == "height") {
+            double value = 0.0;
+            if (!(fields >> value) || value <= 0) {
+                error = "line " + std::to_string(lineNumber) + ": expected a positive value after '" + word + "'";
+                return false;
+            }
+            if (word == "thickness") {
+                plan.wallThickness = value;
+            }
+            else {
+                plan.wallHeight = static_cast<int>(value);
+            }
+            continue;
+        }
+
+        PlanPoint point = makePlanPoint(0, 0, 0);
+        std::istringstream coordinates(line);
+        if (!(coordinates >> point.x >> point.y)) {
+            error = "line " + std::to_string(lineNumber) + ": expected 'x y [z]'";
+            return false;
+        }
+        coordinates >> point.z;
+        current.push_back(point);
+    }
+    closeLoop();
+    return true;
+}
+
+
+WallLayoutSettings LayoutDriver::catalogueSettings(double wallThickness, int wallHeight) {
+    const int widths[] = { 600, 450, 300, 150, 100, 50 };
+
+    WallLayoutSettings settings;
+    settings.wallThickness = wallThickness;
+    settings.wallHeight = wallHeight;
+    for (int width : widths) {
+        // Only the 600 wide panel comes in a 1200 height
+        std::vector<int> heights;
+        heights.push_back(1350);
+        if (width == 600) {
+            heights.push_back(1200);
+        }
+        heights.push_back(600);
+
+        // Same base row rule as WallPlacer::placeWalls
+        int currentHeight = 0;
+        for (int height : heights) {
+            if ((wallHeight - currentHeight) / height > 0) {
+                settings.baseRows.push_back({ width, height, currentHeight });
+                break;
+            }
+            currentHeight += height;
+            if (currentHeight >= wallHeight) {
+                break;
+            }
+        }
+        settings.stackHeights[width] = heights;
+    }
+    return settings;
+}
+
+
+LayoutRunReport LayoutDriver::run(const PlanInput& plan, LayoutPlan& layout, unsigned threads) {
+    LayoutRunReport report;
+    report.loops = plan.loops.size();
+    for (const auto& loop : plan.loops) {
+        report.corners += loop.size();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    LoopHierarchy hierarchy;
+    hierarchy.build(plan.loops);
+    for (size_t i = 0; i < hierarchy.size(); ++i) {
+        if (hierarchy.isOuter(i)) {
+            report.outerLoops++;
+        }
+    }
+    report.hierarchyMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    WallGraph graph;
+    graph.build(plan.loops, hierarchy);
+    report.walls = graph.edges().size();
+    for (const WallNode& node : graph.nodes()) {
+        report.tJoints += node.type == WallNodeType::TJoint ? 1 : 0;
+        report.crossings += node.type == WallNodeType::Cross ? 1 : 0;
+    }
+    report.graphMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    WallLayoutSettings settings = catalogueSettings(plan.wallThickness, plan.wallHeight);
+    settings.threads = threads;
+    CornerRegistry processedCorners(1.0);
+    layout.clear();
+    WallLayout::build(plan.loops, hierarchy, settings, processedCorners, layout);
+    report.layoutMs = elapsedMs(start);
+
+    for (const auto& item : layout.items) {
+        if (item.type == LayoutComponent::WallPanel) {
+            report.wallPanels++;
+        }
+        else {
+            report.stackedPanels++;
+        }
+    }
+
+    start = std::chrono::steady_clock::now();
+    std::vector<TieAnchor> ties;
+    TieLayout::build(layout, graph, ties);
+    report.ties = ties.size();
+    report.tieMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<WallCorner> wallCorners;
+    CornerLayout::corners(plan.loops, hierarchy, graph, wallCorners);
+    for (const WallCorner& corner : wallCorners) {
+        (corner.inside ? report.insideCorners : report.outsideCorners)++;
+    }
+    std::vector<CornerPart> cornerParts;
+    CornerPanelSet panelSet;
+    if (CornerLayout::panelSet(plan.wallThickness, panelSet)) {
+        CornerLayout::build(wallCorners, panelSet, plan.wallThickness, plan.wallHeight, cornerParts);
+    }
+    report.cornerParts = cornerParts.size();
+    report.cornerMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    ConnectorPanelSets panels;
+    selectConnectorPanels(layout, panels);
+    addCornerPanels(cornerParts, panels);
+    std::vector<ConnectorPosition> connectors[4];
+    ConnectorLayout::wallPanels(panels.wallPanels, connectors[0]);
+    ConnectorLayout::walers(panels.walers, connectors[1]);
+    ConnectorLayout::stackedPanels(panels.stacked, connectors[2]);
+    ConnectorLayout::stacked15Panels(panels.stacked15, connectors[3]);
+    for (const auto& placed : connectors) {
+        report.connectors += placed.size();
+    }
+    report.connectorMs = elapsedMs(start);
+
+    // One command and one batch per placer, as PlaceWalls, PlaceTies, the corner commands and
+    // PlaceConnectors commit them
+    start = std::chrono::steady_clock::now();
+    StubDatabase database;
+    auto commitCommand = [&](StubBlockBatch& batch) {
+        CommandRollback command(database);
+        batch.commit();
+    };
+
+    StubBlockBatch wallBatch(database);
+    wallBatch.reserve(layout.items.size());
+    for (const LayoutItem& item : layout.items) {
+        wallBatch.add("panel", item.width, item.height, item.position, item.rotation);
+    }
+    commitCommand(wallBatch);
+
+    StubBlockBatch tieBatch(database);
+    tieBatch.reserve(ties.size());
+    for (const TieAnchor& tie : ties) {
+        tieBatch.add(tie.waler ? "waler tie" : "tie", 0, 0, tie.position, tie.rotation);
+    }
+    commitCommand(tieBatch);
+
+    const char* cornerBlocks[] = { "corner post", "corner panel", "corner compensator" };
+    StubBlockBatch cornerBatch(database);
+    cornerBatch.reserve(cornerParts.size());
+    for (const CornerPart& part : cornerParts) {
+        cornerBatch.add(cornerBlocks[static_cast<int>(part.kind)], part.width, part.height, part.position, part.rotation);
+    }
+    commitCommand(cornerBatch);
+
+    const char* connectorBlocks[] = { "wall panel connector", "waler connector", "stacked connector", "stacked 15 connector" };
+    StubBlockBatch connectorBatch(database);
+    connectorBatch.reserve(report.connectors);
+    for (int placer = 0; placer < 4; ++placer) {
+        for (const ConnectorPosition& connector : connectors[placer]) {
+            connectorBatch.add(connectorBlocks[placer], 0, 0, connector.position, connector.rotation);
+        }
+    }
+    commitCommand(connectorBatch);
+
+    report.committed = database.modelSpace().size();
+    report.commitMs = elapsedMs(start);
+    return report;
+}
+
+
+void LayoutDriver::benchmark(const std::vector<PlanCase>& cases, unsigned seed,
+    const std::vector<unsigned>& threadCounts, std::ostream& csv) {
+    csv << "case,seed,loops,corners,stage,threads,ms,count\n";
+
+    for (const auto& entry : cases) {
+        const PlanInput& plan = entry.plan;
+        size_t corners = 0;
+        for (const auto& loop : plan.loops) {
+            corners += loop.size();
+        }
+        auto row = [&](const char* stage, unsigned threads, double ms, size_t count) {
+            csv << entry.name << ',' << seed << ',' << plan.loops.size() << ',' << corners << ','
+                << stage << ',' << threads << ',' << ms << ',' << count << "\n";
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        LoopHierarchy hierarchy;
+        hierarchy.build(plan.loops);
+        row("loop_hierarchy", 1, elapsedMs(start), hierarchy.roots().size());
+
+        // Candidate search of the T-joint detection: one grid over every segment, one query per corner
+        start = std::chrono::steady_clock::now();
+        const double threshold = 150.0;
+        SegmentGrid segmentGrid(threshold * 4);
+        int segmentId = 0;
+        for (const auto& loop : plan.loops) {
+            for (size_t i = 0; i < loop.size(); ++i) {
+                const PlanPoint& a = loop[i];
+                const PlanPoint& b = loop[(i + 1) % loop.size()];
+                segmentGrid.insert(segmentId++, a.x, a.y, b.x, b.y);
+            }
+        }
+        size_t candidates = 0;
+        std::vector<int> ids;
+        for (const auto& loop : plan.loops) {
+            for (const auto& point : loop) {
+                segmentGrid.query(point.x, point.y, threshold, ids);
+                candidates += ids.size();
+            }
+        }
+        row("tjoint_candidates", 1, elapsedMs(start), candidates);
+
+        // Panel fill on a fresh table, so the table build is part of the time
+        WallLayoutSettings settings = catalogueSettings(plan.wallThickness, plan.wallHeight);
+        std::vector<int> widths;
+        for (const auto& baseRow : settings.baseRows) {
+            widths.push_back(baseRow.width);
+        }
+        start = std::chrono::steady_clock::now();
+        PanelFillSolver panelFill(widths);
+        size_t pieces = 0;
+        for (const auto& loop : plan.loops) {
+            for (size_t i = 0; i < loop.size(); ++i) {
+                const PlanPoint& a = loop[i];
+                const PlanPoint& b = loop[(i + 1) % loop.size()];
+                double length = std::sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+                pieces += panelFill.solve(length).pieces;
+            }
+        }
+        row("panel_fill", 1, elapsedMs(start), pieces);
+
+        start = std::chrono::steady_clock::now();
+        std::vector<std::vector<FaceThickness>> faces;
+        WallThickness::measure(plan.loops, hierarchy, faces);
+        size_t pairedFaces = 0;
+        for (const auto& loopFaces : faces) {
+            for (const auto& face : loopFaces) {
+                pairedFaces += face.oppositeLoop >= 0 ? 1 : 0;
+            }
+        }
+        row("wall_thickness", 1, elapsedMs(start), pairedFaces);
+
+        // Corner extraction of the placers on every loop
+        start = std::chrono::steady_clock::now();
+        PlanLoop loopCorners;
+        for (const auto& loop : plan.loops) {
+            processPolyline(loop, loopCorners, 0.1);
+        }
+        row("process_polyline", 1, elapsedMs(start), loopCorners.size());
+
+        start = std::chrono::steady_clock::now();
+        size_t kept = 0;
+        PlanLoop vertices;
+        for (const auto& loop : plan.loops) {
+            vertices.assign(loop.begin(), loop.end());
+            filterClosePoints(vertices, 0.19);
+            kept += vertices.size();
+        }
+        row("filter_close_points", 1, elapsedMs(start), kept);
+
+        start = std::chrono::steady_clock::now();
+        size_t clockwise = 0;
+        for (const auto& loop : plan.loops) {
+            clockwise += isPolylineClockwise(loop) ? 1 : 0;
+        }
+        row("polyline_clockwise", 1, elapsedMs(start), clockwise);
+
+        LayoutPlan layout;
+        for (unsigned threads : threadCounts) {
+            LayoutRunReport report = run(plan, layout, threads);
+            row("wall_layout", threads, report.layoutMs, layout.items.size());
+            if (threads == threadCounts.front()) {
+                row("wall_graph", 1, report.graphMs, report.walls);
+                row("tie_layout", 1, report.tieMs, report.ties);
+                row("corner_layout", 1, report.cornerMs, report.cornerParts);
+                row("stub_commit", 1, report.commitMs, report.committed);
+            }
+        }
+
+        // Connector positions of the four connector placers on the panels just laid out
+        ConnectorPanelSets panels;
+        selectConnectorPanels(layout, panels);
+        std::vector<ConnectorPosition> connectors;
+        auto connectorStage = [&](const char* stage, void (*calculate)(const std::vector<ConnectorPanel>&, std::vector<ConnectorPosition>&),
+            const std::vector<ConnectorPanel>& selected) {
+            connectors.clear();
+            auto stageStart = std::chrono::steady_clock::now();
+            calculate(selected, connectors);
+            row(stage, 1, elapsedMs(stageStart), connectors.size());
+        };
+        connectorStage("wall_panel_connectors", &ConnectorLayout::wallPanels, panels.wallPanels);
+        connectorStage("waler_connectors", &ConnectorLayout::walers, panels.walers);
+        connectorStage("stacked_connectors", &ConnectorLayout::stackedPanels, panels.stacked);
+        connectorStage("stacked15_connectors", &ConnectorLayout::stacked15Panels, panels.stacked15);
+    }
+
+    benchmarkPointMap(seed, csv);
+}
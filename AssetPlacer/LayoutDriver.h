@@ -0,0 +1,75 @@
+// LayoutDriver.h
+#pragma once
+
+#include "PlanGeometry.h"
+#include "WallLayout.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Plan read from a plain text file:
+//   # comment
+//   thickness 200
+//   height 2700
+//   loop
+//   0 0
+//   0 5000
+//   ...
+// Each "loop" keyword (or a blank line) starts a new closed loop; vertex lines are "x y [z]".
+struct PlanInput {
+    std::vector<PlanLoop> loops;
+    double wallThickness = 200.0;
+    int wallHeight = 2700;
+};
+
+struct PlanCase {
+    std::string name;
+    PlanInput plan;
+};
+
+struct LayoutRunReport {
+    size_t loops = 0;
+    size_t corners = 0;
+    size_t outerLoops = 0;
+    size_t walls = 0;               // straight walls between joints in the wall graph
+    size_t tJoints = 0;
+    size_t crossings = 0;
+    size_t wallPanels = 0;
+    size_t stackedPanels = 0;
+    size_t ties = 0;
+    size_t insideCorners = 0;
+    size_t outsideCorners = 0;
+    size_t cornerParts = 0;         // posts, panels and compensators at the corners
+    size_t connectors = 0;          // parts placed by the four connector placers
+    size_t committed = 0;           // block references in the stub drawing after the commits
+    double hierarchyMs = 0.0;
+    double graphMs = 0.0;
+    double layoutMs = 0.0;
+    double tieMs = 0.0;
+    double cornerMs = 0.0;
+    double connectorMs = 0.0;
+    double commitMs = 0.0;
+};
+
+// Runs the wall layout without a drawing, for large plans and batch runs. No BRX dependencies.
+class LayoutDriver {
+public:
+    // False with `error` set when a line cannot be parsed
+    static bool readPlan(std::istream& in, PlanInput& plan, std::string& error);
+
+    // Layout settings with every panel in the catalogue available
+    static WallLayoutSettings catalogueSettings(double wallThickness, int wallHeight);
+
+    // Wall panels, ties, corner assemblies and connectors, in the order the commands place them,
+    // each placer's blocks committed as one batch in its own command on a StubDatabase.
+    // `threads` as in WallLayoutSettings, 0 = one per hardware thread
+    static LayoutRunReport run(const PlanInput& plan, LayoutPlan& layout, unsigned threads = 0);
+
+    // Times each pure layout stage on every case and writes one CSV row per case and stage:
+    // case,seed,loops,corners,stage,threads,ms,count
+    // The wall layout is timed once per entry of `threadCounts`, giving the scaling curve.
+    // A last case, points-1000000, times the vertex lookups of the placers (point_map) against
+    // the exact std::map they replaced (exact_point_map).
+    static void benchmark(const std::vector<PlanCase>& cases, unsigned seed,
+        const std::vector<unsigned>& threadCounts, std::ostream& csv);
+};
@@ -0,0 +1,146 @@
+#include "LayoutUpdate.h"
+#include "CornerRegistry.h"
+#include <cmath>
+
+
+// Turn of the loop at `cornerNum` relative to its winding: 1 where it turns with the loop
+// (a corner on the outside of the turn), -1 where it turns against it, 0 when straight
+static int cornerTurn(const PlanLoop& loop, size_t cornerNum, bool isClockwise) {
+    size_t count = loop.size();
+    const PlanPoint& prev = loop[(cornerNum + count - 1) % count];
+    const PlanPoint& corner = loop[cornerNum];
+    const PlanPoint& next = loop[(cornerNum + 1) % count];
+    double inX = corner.x - prev.x;
+    double inY = corner.y - prev.y;
+    double outX = next.x - corner.x;
+    double outY = next.y - corner.y;
+    double lengths = std::sqrt((inX * inX + inY * inY) * (outX * outX + outY * outY));
+    if (lengths <= 0.0) {
+        return 0;
+    }
+    double sine = (inX * outY - inY * outX) / lengths;
+    if (std::fabs(sine) < 1e-6) {
+        return 0;
+    }
+    return (sine > 0) != isClockwise ? 1 : -1;
+}
+
+
+PlacedLoop LayoutUpdate::placed(const PlanLoop& loop, size_t loopNum, const LoopHierarchy& hierarchy,
+    const std::vector<std::vector<double>>& runThickness) {
+
+    PlacedLoop placedLoop;
+    placedLoop.corners = loop;
+    if (loopNum < runThickness.size()) {
+        placedLoop.runThickness = runThickness[loopNum];
+    }
+    placedLoop.runThickness.resize(loop.size(), 0.0);
+    placedLoop.isOuter = hierarchy.isOuter(loopNum);
+    placedLoop.isClockwise = hierarchy.isClockwise(loopNum);
+    return placedLoop;
+}
+
+
+void LayoutUpdate::runThickness(const LayoutPlan& plan, const std::vector<PlanLoop>& loops,
+    std::vector<std::vector<double>>& thickness) {
+
+    thickness.assign(loops.size(), std::vector<double>());
+    for (size_t loopNum = 0; loopNum < loops.size(); ++loopNum) {
+        thickness[loopNum].assign(loops[loopNum].size(), 0.0);
+    }
+    for (const LayoutRun& run : plan.runs) {
+        if (run.loop >= 0 && static_cast<size_t>(run.loop) < thickness.size() &&
+            run.edge >= 0 && static_cast<size_t>(run.edge) < thickness[run.loop].size()) {
+            thickness[run.loop][run.edge] = run.thickness;
+        }
+    }
+}
+
+
+size_t LayoutUpdate::compare(const PlacedLoop& before, const PlacedLoop& current, double tolerance,
+    std::vector<char>& dirty, std::vector<PlanPoint>& moved) {
+
+    size_t cornerCount = current.corners.size();
+    dirty.assign(cornerCount, 0);
+    if (cornerCount == 0) {
+        return 0;
+    }
+
+    // A new corner count renumbers the edges, so none of the old runs can be matched up
+    if (before.corners.size() != cornerCount || before.isOuter != current.isOuter ||
+        before.isClockwise != current.isClockwise) {
+        dirty.assign(cornerCount, 1);
+        moved.insert(moved.end(), before.corners.begin(), before.corners.end());
+        moved.insert(moved.end(), current.corners.begin(), current.corners.end());
+        return cornerCount;
+    }
+
+    for (size_t cornerNum = 0; cornerNum < cornerCount; ++cornerNum) {
+        const PlanPoint& was = before.corners[cornerNum];
+        const PlanPoint& now = current.corners[cornerNum];
+        if (std::fabs(was.x - now.x) > tolerance || std::fabs(was.y - now.y) > tolerance) {
+            // The corner ends the previous edge and starts this one
+            dirty[(cornerNum + cornerCount - 1) % cornerCount] = 1;
+            dirty[cornerNum] = 1;
+            moved.push_back(was);
+            moved.push_back(now);
+        }
+
+        // Moving a corner turns its neighbours too; a corner whose turn changed touches both
+        // of its edges, e.g. edges i - 2 and i + 1 when corner i moved
+        if (cornerTurn(before.corners, cornerNum, before.isClockwise) != cornerTurn(current.corners, cornerNum, current.isClockwise)) {
+            dirty[(cornerNum + cornerCount - 1) % cornerCount] = 1;
+            dirty[cornerNum] = 1;
+        }
+
+        double thicknessBefore = cornerNum < before.runThickness.size() ? before.runThickness[cornerNum] : 0.0;
+        double thicknessNow = cornerNum < current.runThickness.size() ? current.runThickness[cornerNum] : 0.0;
+        if (std::fabs(thicknessBefore - thicknessNow) > 0.5) {
+            dirty[cornerNum] = 1;
+        }
+    }
+
+    size_t flagged = 0;
+    for (char edgeDirty : dirty) {
+        flagged += edgeDirty ? 1 : 0;
+    }
+    return flagged;
+}
+
+
+void LayoutUpdate::loopsNear(const std::vector<PlanLoop>& loops, const std::vector<PlanPoint>& moved,
+    double proximity, std::vector<char>& flagged) {
+
+    flagged.resize(loops.size(), 0);
+    if (moved.empty()) {
+        return;
+    }
+
+    CornerRegistry movedCorners(proximity);
+    for (const PlanPoint& corner : moved) {
+        movedCorners.add(corner);
+    }
+    for (size_t loopNum = 0; loopNum < loops.size(); ++loopNum) {
+        if (flagged[loopNum]) {
+            continue;
+        }
+        for (const PlanPoint& corner : loops[loopNum]) {
+            if (movedCorners.isNear(corner)) {
+                flagged[loopNum] = 1;
+                break;
+            }
+        }
+    }
+}
+
+
+void LayoutUpdate::dirtyRuns(const LayoutPlan& plan, const std::vector<std::vector<char>>& dirty, std::vector<size_t>& runs) {
+    runs.clear();
+    for (size_t runNum = 0; runNum < plan.runs.size(); ++runNum) {
+        const LayoutRun& run = plan.runs[runNum];
+        if (run.loop >= 0 && static_cast<size_t>(run.loop) < dirty.size() &&
+            run.edge >= 0 && static_cast<size_t>(run.edge) < dirty[run.loop].size() && dirty[run.loop][run.edge]) {
+            runs.push_back(runNum);
+        }
+    }
+}
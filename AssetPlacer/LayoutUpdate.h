@@ -0,0 +1,47 @@
+// LayoutUpdate.h
+#pragma once
+
+#include "PlanGeometry.h"
+#include "LoopHierarchy.h"
+#include "WallLayout.h"
+#include <vector>
+
+// Wall loop as it was laid out when its components were placed
+struct PlacedLoop {
+    PlanLoop corners;
+    std::vector<double> runThickness;   // per edge (corner i to i + 1), 0 when the corner was skipped
+    bool isOuter;                       // even depth
+    bool isClockwise;
+};
+
+// Which wall runs an edit of the polylines touches. A run is decided by its two corners, the
+// turn at each of them, the thickness behind it, whether its corner was skipped and the
+// classification of its loop, so only edges where one of those changed are laid out and
+// placed again. Pure geometry, no BRX
+// dependencies.
+class LayoutUpdate {
+public:
+    // Loop `loopNum` as laid out in `plan`
+    static PlacedLoop placed(const PlanLoop& loop, size_t loopNum, const LoopHierarchy& hierarchy,
+        const std::vector<std::vector<double>>& runThickness);
+
+    // Per loop and edge, thickness of the run laid out from it in `plan`, 0 for skipped corners
+    static void runThickness(const LayoutPlan& plan, const std::vector<PlanLoop>& loops,
+        std::vector<std::vector<double>>& thickness);
+
+    // Flags in `dirty` the edges of `current` whose run can differ from the one laid out for
+    // `before`: both edges of a corner that moved or now turns the other way (an inside corner
+    // become an outside one), and every edge when the corner count or the loop classification
+    // changed. Corners that moved further than `tolerance` go to `moved`, at both positions.
+    // Returns the number of edges flagged.
+    static size_t compare(const PlacedLoop& before, const PlacedLoop& current, double tolerance,
+        std::vector<char>& dirty, std::vector<PlanPoint>& moved);
+
+    // Flags the loops with a corner within `proximity` of one in `moved`; corner skipping
+    // there can change with the edit
+    static void loopsNear(const std::vector<PlanLoop>& loops, const std::vector<PlanPoint>& moved,
+        double proximity, std::vector<char>& flagged);
+
+    // Runs of `plan` laid out from a flagged edge, in plan order
+    static void dirtyRuns(const LayoutPlan& plan, const std::vector<std::vector<char>>& dirty, std::vector<size_t>& runs);
+};
@@ -0,0 +1,154 @@
+#include "LoopHierarchy.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+
+bool LoopHierarchy::bboxContains(const LoopNode& outer, const LoopNode& inner) const {
+    return outer.minX <= inner.minX && outer.minY <= inner.minY &&
+        outer.maxX >= inner.maxX && outer.maxY >= inner.maxY;
+}
+
+
+std::vector<int> LoopHierarchy::resetNodes(const std::vector<PlanLoop>& loops) {
+    nodes.clear();
+    rootIndices.clear();
+    outermost = -1;
+
+    nodes.resize(loops.size());
+    for (size_t i = 0; i < loops.size(); ++i) {
+        LoopNode& node = nodes[i];
+        double signedArea = signedLoopArea(loops[i]);
+        node.parent = -1;
+        node.depth = 0;
+        node.area = std::fabs(signedArea);
+        node.isClockwise = signedArea <= 0.0;
+        node.minX = node.minY = std::numeric_limits<double>::max();
+        node.maxX = node.maxY = std::numeric_limits<double>::lowest();
+        for (const PlanPoint& point : loops[i]) {
+            node.minX = std::min(node.minX, point.x);
+            node.minY = std::min(node.minY, point.y);
+            node.maxX = std::max(node.maxX, point.x);
+            node.maxY = std::max(node.maxY, point.y);
+        }
+    }
+
+    
+    std::vector<int> order(loops.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<int>(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return nodes[a].area > nodes[b].area;
+    });
+
+    if (!order.empty()) {
+        outermost = order.front();
+    }
+    return order;
+}
+
+
+void LoopHierarchy::attach(int index, int parent) {
+    LoopNode& node = nodes[index];
+    node.parent = parent;
+    if (parent < 0) {
+        rootIndices.push_back(index);
+    }
+    else {
+        node.depth = nodes[parent].depth + 1;
+        nodes[parent].children.push_back(index);
+    }
+}
+
+
+void LoopHierarchy::build(const std::vector<PlanLoop>& loops) {
+    std::vector<int> order = resetNodes(loops);
+
+    // Loops placed so far, by the grid cells their bounding box covers. A loop's parent covers
+    // a point just inside it, so only the loops in that point's cell are tested. Not a vertex:
+    // one on the parent's boundary (a shared wall face) can test as outside it.
+    std::vector<double> extents;
+    double planMinX = std::numeric_limits<double>::max();
+    double planMinY = std::numeric_limits<double>::max();
+    double planMaxX = std::numeric_limits<double>::lowest();
+    double planMaxY = std::numeric_limits<double>::lowest();
+    for (size_t i = 0; i < loops.size(); ++i) {
+        if (loops[i].empty()) continue;
+        const LoopNode& node = nodes[i];
+        extents.push_back(std::max(node.maxX - node.minX, node.maxY - node.minY));
+        planMinX = std::min(planMinX, node.minX);
+        planMinY = std::min(planMinY, node.minY);
+        planMaxX = std::max(planMaxX, node.maxX);
+        planMaxY = std::max(planMaxY, node.maxY);
+    }
+    // Cells the size of a typical loop, and no more than 1024 across the plan
+    double cellSize = 1.0;
+    if (!extents.empty()) {
+        std::nth_element(extents.begin(), extents.begin() + extents.size() / 2, extents.end());
+        double planExtent = std::max(planMaxX - planMinX, planMaxY - planMinY);
+        cellSize = std::max(std::max(extents[extents.size() / 2], planExtent / 1024.0), 1.0);
+    }
+    auto cellCoord = [&](double value, double origin) {
+        return static_cast<long long>(std::floor((value - origin) / cellSize));
+    };
+    auto cellKey = [](long long cx, long long cy) {
+        return (cx << 32) ^ (cy & 0xffffffffLL);
+    };
+    std::unordered_map<long long, std::vector<int>> cells;
+
+    for (int index : order) {
+        const LoopNode& node = nodes[index];
+        if (loops[index].empty()) {
+            rootIndices.push_back(index);
+            continue;
+        }
+        PlanPoint probe = loopInteriorPoint(loops[index]);
+
+        // Innermost containing loop: the smallest one, the later one of equal areas
+        int parent = -1;
+        auto cellIt = cells.find(cellKey(cellCoord(probe.x, planMinX), cellCoord(probe.y, planMinY)));
+        if (cellIt != cells.end()) {
+            for (int candidate : cellIt->second) {
+                const LoopNode& candidateNode = nodes[candidate];
+                if (parent >= 0 && candidateNode.area > nodes[parent].area) continue;
+                if (!bboxContains(candidateNode, node)) continue;
+                if (!isPointInsideLoop(probe, loops[candidate])) continue;
+                parent = candidate;
+            }
+        }
+
+        attach(index, parent);
+
+        long long maxCellX = cellCoord(node.maxX, planMinX);
+        long long maxCellY = cellCoord(node.maxY, planMinY);
+        for (long long cx = cellCoord(node.minX, planMinX); cx <= maxCellX; ++cx) {
+            for (long long cy = cellCoord(node.minY, planMinY); cy <= maxCellY; ++cy) {
+                cells[cellKey(cx, cy)].push_back(index);
+            }
+        }
+    }
+}
+
+
+bool LoopHierarchy::restore(const std::vector<PlanLoop>& loops, const std::vector<int>& parents) {
+    std::vector<int> order = resetNodes(loops);
+    if (parents.size() != loops.size()) {
+        resetNodes(std::vector<PlanLoop>());
+        return false;
+    }
+
+    // build places a parent before its children, so anything else was not saved from it
+    std::vector<char> placed(loops.size(), 0);
+    for (int index : order) {
+        int parent = parents[index];
+        if (parent >= static_cast<int>(loops.size()) || (parent >= 0 && !placed[parent])) {
+            resetNodes(std::vector<PlanLoop>());
+            return false;
+        }
+        attach(index, parent);
+        placed[index] = 1;
+    }
+    return true;
+}
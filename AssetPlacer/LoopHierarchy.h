@@ -0,0 +1,50 @@
+// LoopHierarchy.h
+#pragma once
+
+#include "PlanGeometry.h"
+#include <vector>
+
+// One closed loop in the containment tree
+struct LoopNode {
+    int parent;                 // -1 for top-level loops
+    int depth;                  // 0 = outside face of a wall ring, 1 = its inside face, 2 = island, ...
+    double area;                // absolute area, computed once
+    bool isClockwise;
+    double minX, minY, maxX, maxY;
+    std::vector<int> children;
+};
+
+// Containment hierarchy of all closed wall loops (outer walls, courtyards, shafts, nested islands).
+// Built in one sweep: loops are visited largest first, and each one takes as parent the smallest
+// loop already placed that contains it, found through a uniform grid of loop bounding boxes.
+class LoopHierarchy {
+public:
+    void build(const std::vector<PlanLoop>& loops);
+
+    // Same tree from the parent of every loop, as build found them (e.g. saved with the drawing),
+    // without the containment tests. False, leaving the hierarchy empty, when a parent is out of
+    // range or not larger than its child.
+    bool restore(const std::vector<PlanLoop>& loops, const std::vector<int>& parents);
+
+    size_t size() const { return nodes.size(); }
+    const LoopNode& node(size_t index) const { return nodes[index]; }
+    const std::vector<int>& roots() const { return rootIndices; }
+
+    // Even depth faces outward (outside of a wall ring), odd depth faces into an enclosed space
+    bool isOuter(size_t index) const { return nodes[index].depth % 2 == 0; }
+    bool isClockwise(size_t index) const { return nodes[index].isClockwise; }
+    double area(size_t index) const { return nodes[index].area; }
+
+    // Loop with the largest area, -1 when empty
+    int outermostIndex() const { return outermost; }
+
+private:
+    // Areas, directions and bounding boxes of fresh nodes; returns the loops largest first
+    std::vector<int> resetNodes(const std::vector<PlanLoop>& loops);
+    void attach(int index, int parent);
+    bool bboxContains(const LoopNode& outer, const LoopNode& inner) const;
+
+    std::vector<LoopNode> nodes;
+    std::vector<int> rootIndices;
+    int outermost = -1;
+};
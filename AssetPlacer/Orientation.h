@@ -0,0 +1,49 @@
+// Orientation.h
+#pragma once
+
+#include "PlanGeometry.h"
+#include <cmath>
+#include <cstddef>
+
+// One of the four orthogonal panel orientations. Offsets are written in panel coordinates
+// (x along the panel, y across it) and turned into model space with the exact integer
+// 2x2 rotation, so no quadrant needs its own hand-written sign flips.
+struct Orientation {
+    int cosine;
+    int sine;
+    double angle;   // radians, quadrant * 90 degrees
+};
+
+constexpr Orientation orientations[4] = {
+    { 1, 0, 0.0 },
+    { 0, 1, 1.5707963267948966 },
+    { -1, 0, 3.141592653589793 },
+    { 0, -1, 4.71238898038469 }
+};
+
+// Quadrant 0..3 nearest to a rotation in radians, for negative angles and whole turns too
+inline int orientationQuadrant(double rotation) {
+    int quadrant = static_cast<int>(std::lround(rotation / 1.5707963267948966)) % 4;
+    return quadrant < 0 ? quadrant + 4 : quadrant;
+}
+
+inline const Orientation& orientationOf(double rotation) {
+    return orientations[orientationQuadrant(rotation)];
+}
+
+// Panel-coordinate offset in model space; z is not rotated
+constexpr PlanPoint orient(const Orientation& orientation, const PlanPoint& local) {
+    return { orientation.cosine * local.x - orientation.sine * local.y,
+        orientation.sine * local.x + orientation.cosine * local.y, local.z };
+}
+
+// Whole offset template at once: branch-free arithmetic the compiler can vectorize
+inline void orient(const Orientation& orientation, const PlanPoint* local, PlanPoint* out, size_t count) {
+    const double cosine = orientation.cosine;
+    const double sine = orientation.sine;
+    for (size_t i = 0; i < count; ++i) {
+        out[i].x = cosine * local[i].x - sine * local[i].y;
+        out[i].y = sine * local[i].x + cosine * local[i].y;
+        out[i].z = local[i].z;
+    }
+}
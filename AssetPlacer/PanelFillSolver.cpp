@@ -0,0 +1,118 @@
+#include "PanelFillSolver.h"
+#include <cmath>
+
+std::map<std::vector<int>, std::unique_ptr<PanelFillSolver>> PanelFillSolver::solvers;
+
+
+PanelFillSolver::PanelFillSolver(const std::vector<int>& widths, int compensatorWidth, int step)
+    : catalogue(widths), compensatorWidth(compensatorWidth), stepSize(step > 0 ? step : 50) {
+    Mix empty;
+    empty.counts.assign(catalogue.size(), 0);
+    empty.pieces = 0;
+    empty.compensators = 0;
+    empty.length = 0;
+    table.push_back(empty);
+    bestReachable.push_back(0);
+}
+
+
+PanelFillSolver& PanelFillSolver::shared(const std::vector<int>& widths) {
+    std::unique_ptr<PanelFillSolver>& solver = solvers[widths];
+    if (!solver) {
+        solver.reset(new PanelFillSolver(widths));
+    }
+    return *solver;
+}
+
+
+void PanelFillSolver::reserve(double maxLength) {
+    if (maxLength > 0.0) {
+        extend(static_cast<int>(std::floor(maxLength / stepSize + 1e-6)));
+    }
+}
+
+
+const PanelFillSolver::Mix& PanelFillSolver::solve(double length) {
+    int units = length > 0.0 ? static_cast<int>(std::floor(length / stepSize + 1e-6)) : 0;
+    extend(units);
+    return table[bestReachable[units]];
+}
+
+
+void PanelFillSolver::arrange(const Mix& mix, std::vector<int>& order) const {
+    int fullPanels = mix.pieces - mix.compensators;
+    int head = fullPanels - fullPanels / 2;
+    order.assign(mix.pieces > 0 ? mix.pieces : 0, 0);
+
+    // Head panels, compensators and tail panels are written through their own cursors
+    int headPos = 0;
+    int compensatorPos = head;
+    int tailPos = head + mix.compensators;
+    for (size_t i = 0; i < catalogue.size() && i < mix.counts.size(); ++i) {
+        int index = static_cast<int>(i);
+        for (int n = 0; n < mix.counts[i]; ++n) {
+            if (isCompensator(index)) {
+                order[compensatorPos++] = index;
+            }
+            else if (headPos < head) {
+                order[headPos++] = index;
+            }
+            else {
+                order[tailPos++] = index;
+            }
+        }
+    }
+}
+
+
+void PanelFillSolver::extend(int units) {
+    int first = static_cast<int>(table.size());
+    if (units < first) {
+        return;
+    }
+
+    table.reserve(units + 1);
+    bestReachable.reserve(units + 1);
+
+    for (int n = first; n <= units; ++n) {
+        int bestWidth = -1;
+        int bestPieces = 0;
+        int bestCompensators = 0;
+
+        
+        for (size_t i = 0; i < catalogue.size(); ++i) {
+            int widthUnits = catalogue[i] / stepSize;
+            if (widthUnits <= 0 || widthUnits > n || catalogue[i] % stepSize != 0) continue;
+
+            const Mix& rest = table[n - widthUnits];
+            if (rest.pieces < 0) continue;
+
+            int pieces = rest.pieces + 1;
+            int compensators = rest.compensators + (catalogue[i] <= compensatorWidth ? 1 : 0);
+            if (bestWidth < 0 || pieces < bestPieces ||
+                (pieces == bestPieces && compensators < bestCompensators)) {
+                bestWidth = static_cast<int>(i);
+                bestPieces = pieces;
+                bestCompensators = compensators;
+            }
+        }
+
+        Mix mix;
+        if (bestWidth < 0) {
+            mix.counts.assign(catalogue.size(), 0);
+            mix.pieces = -1;
+            mix.compensators = 0;
+            mix.length = 0;
+            bestReachable.push_back(bestReachable[n - 1]);
+        }
+        else {
+            mix = table[n - catalogue[bestWidth] / stepSize];
+            mix.counts[bestWidth]++;
+            mix.pieces = bestPieces;
+            mix.compensators = bestCompensators;
+            mix.length += catalogue[bestWidth];
+            bestReachable.push_back(n);
+        }
+        table.push_back(mix);
+    }
+}
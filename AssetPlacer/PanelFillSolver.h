@@ -0,0 +1,53 @@
+// PanelFillSolver.h
+#pragma once
+
+#include <vector>
+#include <map>
+#include <memory>
+
+// Dynamic-programming panel mix for a straight wall run. For every length in `step`
+// increments the table holds the mix with the fewest pieces, then the fewest
+// compensators, then the largest panels first. Built once per catalogue and grown
+// on demand, so each segment is a table lookup. Has no BRX dependencies.
+class PanelFillSolver {
+public:
+    struct Mix {
+        std::vector<int> counts;    // panels per catalogue width, in catalogue order
+        int pieces;
+        int compensators;
+        int length;                 // covered length in mm
+    };
+
+    // `widths` in mm, largest first; widths up to `compensatorWidth` count as compensators
+    explicit PanelFillSolver(const std::vector<int>& widths, int compensatorWidth = 150, int step = 50);
+
+    // Solver shared by every placer using the same catalogue
+    static PanelFillSolver& shared(const std::vector<int>& widths);
+
+    // Builds the table up to `maxLength` so later solve() calls do not grow it
+    void reserve(double maxLength);
+
+    // Best mix covering at most `length`. The reference stays valid until the table grows.
+    const Mix& solve(double length);
+
+    // Placement order of `mix` along a run, as catalogue indices: full panels from both ends
+    // with the compensators gathered in the middle, away from the corners. Linear in the
+    // number of pieces; `order` is overwritten.
+    void arrange(const Mix& mix, std::vector<int>& order) const;
+
+    bool isCompensator(int index) const { return catalogue[index] <= compensatorWidth; }
+
+    const std::vector<int>& widths() const { return catalogue; }
+    int step() const { return stepSize; }
+
+private:
+    void extend(int units);
+
+    std::vector<int> catalogue;
+    int compensatorWidth;
+    int stepSize;
+    std::vector<Mix> table;             // pieces < 0 marks an unreachable length
+    std::vector<int> bestReachable;     // largest reachable unit count <= index
+
+    static std::map<std::vector<int>, std::unique_ptr<PanelFillSolver>> solvers;
+};
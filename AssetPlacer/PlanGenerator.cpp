@@ -0,0 +1,184 @@
+#include "PlanGenerator.h"
+#include <cmath>
+
+
+PlanGenerator::PlanGenerator(std::uint32_t seed, double wallThickness)
+    : state(seed ? seed : 0x9E3779B9u), thickness(wallThickness) {
+}
+
+
+std::uint32_t PlanGenerator::next() {
+    // xorshift32, so the sequence does not depend on the standard library
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+
+int PlanGenerator::pick(int low, int high, int step) {
+    int choices = (high - low) / step + 1;
+    return low + static_cast<int>(next() % static_cast<std::uint32_t>(choices)) * step;
+}
+
+
+PlanLoop PlanGenerator::insetOrthogonal(const PlanLoop& loop, double distance) {
+    // Inward normal of a counter-clockwise edge is its direction turned left
+    double sign = signedLoopArea(loop) >= 0 ? 1.0 : -1.0;
+    size_t count = loop.size();
+
+    PlanLoop result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const PlanPoint& prev = loop[(i + count - 1) % count];
+        const PlanPoint& current = loop[i];
+        const PlanPoint& next = loop[(i + 1) % count];
+
+        double inX = current.x - prev.x;
+        double inY = current.y - prev.y;
+        double inLength = std::sqrt(inX * inX + inY * inY);
+        double outX = next.x - current.x;
+        double outY = next.y - current.y;
+        double outLength = std::sqrt(outX * outX + outY * outY);
+
+        PlanPoint point = current;
+        if (inLength > 0) {
+            point.x += -inY / inLength * distance * sign;
+            point.y += inX / inLength * distance * sign;
+        }
+        if (outLength > 0) {
+            point.x += -outY / outLength * distance * sign;
+            point.y += outX / outLength * distance * sign;
+        }
+        result.push_back(point);
+    }
+    return result;
+}
+
+
+void PlanGenerator::addRing(PlanInput& plan, const PlanLoop& outer) {
+    plan.loops.push_back(outer);
+    plan.loops.push_back(insetOrthogonal(outer, thickness));
+}
+
+
+PlanInput PlanGenerator::ring(const PlanLoop& outer) {
+    PlanInput plan;
+    plan.wallThickness = thickness;
+    addRing(plan, outer);
+    return plan;
+}
+
+
+PlanInput PlanGenerator::rectangle() {
+    double w = pick(3000, 20000);
+    double h = pick(3000, 20000);
+    return ring({ makePlanPoint(0, 0), makePlanPoint(w, 0), makePlanPoint(w, h), makePlanPoint(0, h) });
+}
+
+
+PlanInput PlanGenerator::lShape() {
+    double w = pick(6000, 20000);
+    double h = pick(6000, 20000);
+    double cutW = pick(2000, static_cast<int>(w) - 3000);
+    double cutH = pick(2000, static_cast<int>(h) - 3000);
+    return ring({ makePlanPoint(0, 0), makePlanPoint(w, 0), makePlanPoint(w, h - cutH),
+        makePlanPoint(w - cutW, h - cutH), makePlanPoint(w - cutW, h), makePlanPoint(0, h) });
+}
+
+
+PlanInput PlanGenerator::uShape() {
+    double w = pick(9000, 24000);
+    double h = pick(6000, 20000);
+    double arm = pick(2000, static_cast<int>(w / 3));
+    double depth = pick(2000, static_cast<int>(h) - 3000);
+    return ring({ makePlanPoint(0, 0), makePlanPoint(w, 0), makePlanPoint(w, h), makePlanPoint(w - arm, h),
+        makePlanPoint(w - arm, h - depth), makePlanPoint(arm, h - depth), makePlanPoint(arm, h), makePlanPoint(0, h) });
+}
+
+
+PlanInput PlanGenerator::tShape() {
+    double w = pick(9000, 24000);
+    double h = pick(6000, 20000);
+    double stem = pick(2000, static_cast<int>(w / 3));
+    double bar = pick(2000, static_cast<int>(h) - 3000);
+    double left = std::floor((w - stem) / 100.0) * 50.0;
+    return ring({ makePlanPoint(left, 0), makePlanPoint(left + stem, 0), makePlanPoint(left + stem, h - bar),
+        makePlanPoint(w, h - bar), makePlanPoint(w, h), makePlanPoint(0, h), makePlanPoint(0, h - bar), makePlanPoint(left, h - bar) });
+}
+
+
+PlanInput PlanGenerator::courtyard() {
+    double w = pick(12000, 30000);
+    double h = pick(12000, 30000);
+    double margin = pick(3000, 5000);
+
+    PlanInput plan = ring({ makePlanPoint(0, 0), makePlanPoint(w, 0), makePlanPoint(w, h), makePlanPoint(0, h) });
+    PlanLoop yard = { makePlanPoint(margin, margin), makePlanPoint(w - margin, margin),
+        makePlanPoint(w - margin, h - margin), makePlanPoint(margin, h - margin) };
+    plan.loops.push_back(insetOrthogonal(yard, -thickness));
+    plan.loops.push_back(yard);
+    return plan;
+}
+
+
+PlanInput PlanGenerator::apartments(int rows, int columns) {
+    PlanInput plan;
+    plan.wallThickness = thickness;
+
+    std::vector<double> widths;
+    std::vector<double> depths;
+    double totalW = thickness;
+    double totalH = thickness;
+    for (int c = 0; c < columns; ++c) {
+        widths.push_back(pick(2500, 6000));
+        totalW += widths.back() + thickness;
+    }
+    for (int r = 0; r < rows; ++r) {
+        depths.push_back(pick(2500, 6000));
+        totalH += depths.back() + thickness;
+    }
+
+    plan.loops.push_back({ makePlanPoint(0, 0), makePlanPoint(totalW, 0), makePlanPoint(totalW, totalH), makePlanPoint(0, totalH) });
+    double y = thickness;
+    for (int r = 0; r < rows; ++r) {
+        double x = thickness;
+        for (int c = 0; c < columns; ++c) {
+            plan.loops.push_back({ makePlanPoint(x, y), makePlanPoint(x + widths[c], y),
+                makePlanPoint(x + widths[c], y + depths[r]), makePlanPoint(x, y + depths[r]) });
+            x += widths[c] + thickness;
+        }
+        y += depths[r] + thickness;
+    }
+    return plan;
+}
+
+
+PlanInput PlanGenerator::site(int buildings) {
+    PlanInput plan;
+    plan.wallThickness = thickness;
+
+    int perRow = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(buildings))));
+    const double pitch = 25000.0;
+    for (int i = 0; i < buildings; ++i) {
+        double x0 = (i % perRow) * pitch;
+        double y0 = (i / perRow) * pitch;
+        double w = pick(3000, 20000);
+        double h = pick(3000, 20000);
+        addRing(plan, { makePlanPoint(x0, y0), makePlanPoint(x0 + w, y0), makePlanPoint(x0 + w, y0 + h), makePlanPoint(x0, y0 + h) });
+    }
+    return plan;
+}
+
+
+std::vector<PlanCase> PlanGenerator::standardSuite() {
+    std::vector<PlanCase> cases;
+    cases.push_back({ "rectangle", rectangle() });
+    cases.push_back({ "l-shape", lShape() });
+    cases.push_back({ "u-shape", uShape() });
+    cases.push_back({ "t-shape", tShape() });
+    cases.push_back({ "courtyard", courtyard() });
+    cases.push_back({ "apartments-20x20", apartments(20, 20) });
+    cases.push_back({ "site-5000", site(5000) });
+    return cases;
+}
@@ -0,0 +1,38 @@
+// PlanGenerator.h
+#pragma once
+
+#include "LayoutDriver.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Seedable generator of synthetic orthogonal floor plans for timing the layout stages.
+// Every wall is a ring of an outer face loop and its inset inner face loop. The same seed
+// gives the same plans on every platform. No BRX dependencies.
+class PlanGenerator {
+public:
+    explicit PlanGenerator(std::uint32_t seed, double wallThickness = 200.0);
+
+    PlanInput rectangle();
+    PlanInput lShape();
+    PlanInput uShape();
+    PlanInput tShape();
+    PlanInput courtyard();
+    PlanInput apartments(int rows, int columns);
+    PlanInput site(int buildings);
+
+    // Rectangle, L/U/T shapes, courtyard, a 20 x 20 room block and a 10,000 loop site
+    std::vector<PlanCase> standardSuite();
+
+    // Moves every vertex of an orthogonal loop `distance` towards its inside
+    static PlanLoop insetOrthogonal(const PlanLoop& loop, double distance);
+
+private:
+    std::uint32_t next();
+    int pick(int low, int high, int step = 50);
+    PlanInput ring(const PlanLoop& outer);
+    void addRing(PlanInput& plan, const PlanLoop& outer);
+
+    std::uint32_t state;
+    double thickness;
+};
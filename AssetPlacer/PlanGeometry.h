@@ -0,0 +1,84 @@
+// PlanGeometry.h
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cmath>
+
+// Plain plan-view point used by the layout modules that build without the BRX SDK.
+// Coordinates are drawing units (mm).
+struct PlanPoint {
+    double x;
+    double y;
+    double z;
+};
+
+typedef std::vector<PlanPoint> PlanLoop;
+
+inline PlanPoint makePlanPoint(double x, double y, double z = 0.0) {
+    PlanPoint point = { x, y, z };
+    return point;
+}
+
+// Shoelace area, positive for counter-clockwise loops
+inline double signedLoopArea(const PlanLoop& loop) {
+    double area = 0.0;
+    for (size_t i = 0; i < loop.size(); ++i) {
+        const PlanPoint& p1 = loop[i];
+        const PlanPoint& p2 = loop[(i + 1) % loop.size()];
+        area += (p1.x * p2.y - p2.x * p1.y);
+    }
+    return area / 2.0;
+}
+
+// Even-odd ray cast, same rule as isPointInsidePolygon in WallAssetPlacer.cpp
+inline bool isPointInsideLoop(const PlanPoint& point, const PlanLoop& loop) {
+    int crossings = 0;
+    for (size_t i = 0; i < loop.size(); ++i) {
+        const PlanPoint& p1 = loop[i];
+        const PlanPoint& p2 = loop[(i + 1) % loop.size()];
+
+        if (((p1.y > point.y) != (p2.y > point.y)) &&
+            (point.x < (p2.x - p1.x) * (point.y - p1.y) / (p2.y - p1.y) + p1.x)) {
+            crossings++;
+        }
+    }
+    return (crossings % 2) == 1;
+}
+
+// Point just inside a loop beside the middle of its first edge, for containment tests that a
+// vertex lying on the other loop's boundary (a shared wall face) would get wrong. Offset toward
+// the inside by a thousandth of the edge, at most 1 mm; the first vertex when no edge has length.
+inline PlanPoint loopInteriorPoint(const PlanLoop& loop) {
+    double orientation = signedLoopArea(loop) < 0.0 ? -1.0 : 1.0;
+    for (size_t i = 0; i < loop.size(); ++i) {
+        const PlanPoint& p1 = loop[i];
+        const PlanPoint& p2 = loop[(i + 1) % loop.size()];
+        double dx = p2.x - p1.x;
+        double dy = p2.y - p1.y;
+        double length = std::sqrt(dx * dx + dy * dy);
+        if (length <= 0.0) continue;
+        // Inside is on the left of a counter-clockwise edge
+        double offset = (length * 0.001 < 1.0 ? length * 0.001 : 1.0) * orientation / length;
+        return makePlanPoint((p1.x + p2.x) / 2.0 - dy * offset, (p1.y + p2.y) / 2.0 + dx * offset, p1.z);
+    }
+    return loop.empty() ? makePlanPoint(0.0, 0.0) : loop[0];
+}
+
+// Snaps an angle (radians) onto 0, 90, 180 or 270 degrees when it is within `tolerance`.
+// The angle is normalised to [0, 2pi) either way; returns false when no right angle was close.
+inline bool snapToRightAngle(double& angle, double tolerance) {
+    const double pi = 3.141592653589793238462643383279;
+    const double snapAngles[] = { 0, pi / 2, pi, 3 * pi / 2, 2 * pi };
+
+    angle = std::fmod(angle, 2 * pi);
+    if (angle < 0) angle += 2 * pi;
+
+    for (double snapAngle : snapAngles) {
+        if (std::fabs(angle - snapAngle) < tolerance) {
+            angle = snapAngle;
+            return true;
+        }
+    }
+    return false;
+}
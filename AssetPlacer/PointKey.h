@@ -0,0 +1,159 @@
+// PointKey.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+// Point quantised to a fixed grid (0.1 mm by default). Coordinates that differ only by
+// floating point noise round to the same key, so keys can be compared exactly and hashed.
+struct PointKey {
+    std::int64_t x;
+    std::int64_t y;
+    std::int64_t z;
+
+    static constexpr double defaultResolution = 0.1;
+
+    static PointKey of(double px, double py, double pz, double resolution = defaultResolution) {
+        PointKey key = {
+            static_cast<std::int64_t>(std::llround(px / resolution)),
+            static_cast<std::int64_t>(std::llround(py / resolution)),
+            static_cast<std::int64_t>(std::llround(pz / resolution))
+        };
+        return key;
+    }
+
+    // Any point type with x, y and z members (AcGePoint3d, PlanPoint)
+    template <typename Point>
+    static PointKey of(const Point& point, double resolution = defaultResolution) {
+        return of(point.x, point.y, point.z, resolution);
+    }
+
+    bool operator==(const PointKey& other) const { return x == other.x && y == other.y && z == other.z; }
+    bool operator!=(const PointKey& other) const { return !(*this == other); }
+};
+
+struct PointKeyHash {
+    std::size_t operator()(const PointKey& key) const {
+        std::uint64_t h = static_cast<std::uint64_t>(key.x) * 0x9E3779B97F4A7C15ULL;
+        h ^= static_cast<std::uint64_t>(key.y) + 0xC2B2AE3D27D4EB4FULL + (h << 6) + (h >> 2);
+        h ^= static_cast<std::uint64_t>(key.z) + 0x165667B19E3779F9ULL + (h << 6) + (h >> 2);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h);
+    }
+};
+
+// Open-addressing (linear probing) hash map keyed by PointKey. Entries live in one flat
+// array, so a lookup is a hash and a short scan of neighbouring slots.
+template <typename Value>
+class PointMap {
+public:
+    typedef std::pair<PointKey, Value> Entry;
+
+    PointMap() : count(0) {}
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void clear() {
+        slots.clear();
+        used.clear();
+        count = 0;
+    }
+
+    void reserve(std::size_t entries) {
+        std::size_t capacity = 16;
+        while (capacity * 7 < entries * 10) {
+            capacity *= 2;
+        }
+        if (capacity > slots.size()) {
+            rehash(capacity);
+        }
+    }
+
+    Value* find(const PointKey& key) {
+        std::size_t slot = locate(key);
+        return slot == npos ? nullptr : &slots[slot].second;
+    }
+
+    const Value* find(const PointKey& key) const {
+        std::size_t slot = locate(key);
+        return slot == npos ? nullptr : &slots[slot].second;
+    }
+
+    bool contains(const PointKey& key) const { return locate(key) != npos; }
+
+    // Inserts a default value when the key is missing
+    Value& operator[](const PointKey& key) {
+        if ((count + 1) * 10 > slots.size() * 7) {
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+        }
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t slot = PointKeyHash()(key) & mask;; slot = (slot + 1) & mask) {
+            if (!used[slot]) {
+                used[slot] = 1;
+                slots[slot] = Entry(key, Value());
+                count++;
+                return slots[slot].second;
+            }
+            if (slots[slot].first == key) {
+                return slots[slot].second;
+            }
+        }
+    }
+
+    // Calls fn(key, value) for every entry, in slot order
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (std::size_t slot = 0; slot < slots.size(); ++slot) {
+            if (used[slot]) {
+                fn(slots[slot].first, slots[slot].second);
+            }
+        }
+    }
+
+private:
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::size_t locate(const PointKey& key) const {
+        if (slots.empty()) {
+            return npos;
+        }
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t slot = PointKeyHash()(key) & mask; used[slot]; slot = (slot + 1) & mask) {
+            if (slots[slot].first == key) {
+                return slot;
+            }
+        }
+        return npos;
+    }
+
+    void rehash(std::size_t capacity) {
+        std::vector<Entry> oldSlots;
+        std::vector<unsigned char> oldUsed;
+        oldSlots.swap(slots);
+        oldUsed.swap(used);
+
+        slots.resize(capacity);
+        used.assign(capacity, 0);
+        std::size_t mask = capacity - 1;
+        for (std::size_t i = 0; i < oldSlots.size(); ++i) {
+            if (!oldUsed[i]) continue;
+
+            std::size_t slot = PointKeyHash()(oldSlots[i].first) & mask;
+            while (used[slot]) {
+                slot = (slot + 1) & mask;
+            }
+            used[slot] = 1;
+            slots[slot] = std::move(oldSlots[i]);
+        }
+    }
+
+    std::vector<Entry> slots;
+    std::vector<unsigned char> used;
+    std::size_t count;
+};
@@ -0,0 +1,48 @@
+#include "PolylineGeometry.h"
+#include <cmath>
+
+
+static double distanceBetween(const PlanPoint& a, const PlanPoint& b) {
+    return std::sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
+}
+
+
+void filterClosePoints(PlanLoop& vertices, double tolerance) {
+    // In place: `previous` keeps the vertex before i, which may already be overwritten
+    size_t kept = 0;
+    PlanPoint previous = makePlanPoint(0.0, 0.0);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        PlanPoint vertex = vertices[i];
+        if (i == 0 || distanceBetween(vertex, previous) > tolerance) {
+            vertices[kept++] = vertex;
+        }
+        previous = vertex;
+    }
+    vertices.resize(kept);
+
+    if (vertices.size() > 1 && distanceBetween(vertices.back(), vertices.front()) <= tolerance) {
+        vertices.pop_back();
+    }
+}
+
+
+bool isPolylineClockwise(const PlanLoop& points) {
+    const double tolerance = 1e-6;
+    double sum = 0.0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const PlanPoint& current = points[i];
+        const PlanPoint& next = points[(i + 1) % points.size()];
+        sum += (next.x - current.x) * (next.y + current.y);
+    }
+    return sum > tolerance;
+}
+
+
+void processPolyline(const PlanLoop& vertices, PlanLoop& corners, double tolerance) {
+    PlanLoop filtered(vertices);
+    filterClosePoints(filtered, tolerance);
+    if (filtered.size() < 3) {
+        return;
+    }
+    corners.insert(corners.end(), filtered.begin(), filtered.end());
+}
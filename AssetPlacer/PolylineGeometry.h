@@ -0,0 +1,18 @@
+// PolylineGeometry.h
+#pragma once
+
+#include "PlanGeometry.h"
+
+// Corner extraction of the placers on plan points, so it builds and is timed without the
+// BRX SDK. GeometryUtils keeps the AcGePoint3d forms and runs them through these.
+
+// Drops every vertex within `tolerance` of the vertex before it, and the last one when it
+// closes onto the first
+void filterClosePoints(PlanLoop& vertices, double tolerance);
+
+// Sign of the edge sum (x2 - x1)(y2 + y1); false for a loop with no area
+bool isPolylineClockwise(const PlanLoop& points);
+
+// Corners of a closed polyline from its vertices: every vertex left by filterClosePoints,
+// whatever the angle there. Nothing under three vertices.
+void processPolyline(const PlanLoop& vertices, PlanLoop& corners, double tolerance);
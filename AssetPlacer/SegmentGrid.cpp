@@ -0,0 +1,69 @@
+#include "SegmentGrid.h"
+#include <algorithm>
+#include <cmath>
+
+
+SegmentGrid::SegmentGrid(double cellSize)
+    : cellSize(cellSize > 0.0 ? cellSize : 1.0) {
+}
+
+
+long long SegmentGrid::cellCoord(double value) const {
+    return static_cast<long long>(std::floor(value / cellSize));
+}
+
+
+long long SegmentGrid::cellKey(long long cx, long long cy) const {
+    return (cx << 32) ^ (cy & 0xffffffffLL);
+}
+
+
+void SegmentGrid::insert(int id, double x0, double y0, double x1, double y1) {
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    long long minX = cellCoord(x0);
+    long long maxX = cellCoord(x1);
+
+    // Supercover walk: one column at a time, the cells between the heights of the segment where
+    // it enters and leaves the column. A diagonal wall touches O(length) cells, not its whole box.
+    double slope = maxX > minX ? (y1 - y0) / (x1 - x0) : 0.0;
+    double enterY = y0;
+    for (long long cx = minX; cx <= maxX; ++cx) {
+        double leaveY = cx == maxX ? y1 : y0 + slope * (static_cast<double>(cx + 1) * cellSize - x0);
+        long long minY = cellCoord(std::min(enterY, leaveY));
+        long long maxY = cellCoord(std::max(enterY, leaveY));
+        for (long long cy = minY; cy <= maxY; ++cy) {
+            cells[cellKey(cx, cy)].push_back(id);
+        }
+        enterY = leaveY;
+    }
+}
+
+
+void SegmentGrid::query(double x, double y, double radius, std::vector<int>& ids) const {
+    ids.clear();
+
+    long long minX = cellCoord(x - radius);
+    long long maxX = cellCoord(x + radius);
+    long long minY = cellCoord(y - radius);
+    long long maxY = cellCoord(y + radius);
+
+    for (long long cx = minX; cx <= maxX; ++cx) {
+        for (long long cy = minY; cy <= maxY; ++cy) {
+            auto it = cells.find(cellKey(cx, cy));
+            if (it != cells.end()) {
+                ids.insert(ids.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
+
+void SegmentGrid::clear() {
+    cells.clear();
+}
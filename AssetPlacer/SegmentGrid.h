@@ -0,0 +1,29 @@
+// SegmentGrid.h
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+// Uniform grid over wall segments. Used to find the wall segments near a point
+// without testing every segment of every loop. Has no BRX dependencies.
+class SegmentGrid {
+public:
+    explicit SegmentGrid(double cellSize);
+
+    // Registers segment `id` in every cell the segment crosses
+    void insert(int id, double x0, double y0, double x1, double y1);
+
+    // Fills `ids` with the segments whose cells lie within `radius` of (x, y), sorted and unique
+    void query(double x, double y, double radius, std::vector<int>& ids) const;
+
+    void clear();
+    std::size_t cellCount() const { return cells.size(); }
+
+private:
+    long long cellKey(long long cx, long long cy) const;
+    long long cellCoord(double value) const;
+
+    double cellSize;
+    std::unordered_map<long long, std::vector<int>> cells;
+};
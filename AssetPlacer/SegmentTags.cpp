@@ -0,0 +1,286 @@
+#include "StdAfx.h"
+#include "SegmentTags.h"
+#include "dbdict.h"
+#include "dbxrecrd.h"
+#include "acutads.h"
+#include <map>
+#include <string>
+#include "Profiler.h"
+
+static const ACHAR* segmentDictionary = _T("PERI_SEGMENTS");
+static const ACHAR* layoutRecord = _T("LAYOUT");     // not a handle, so it cannot clash with a polyline
+
+
+static std::wstring handleKey(const AcDbObjectId& id) {
+    ACHAR buffer[17] = { 0 };
+    id.handle().getIntoAsciiBuffer(buffer);
+    return buffer;
+}
+
+
+// PERI_SEGMENTS, created when `create` is set; nullptr when it is missing or cannot be opened
+static AcDbDictionary* openSegments(AcDbDatabase* pDb, AcDb::OpenMode mode, bool create) {
+    AcDbDictionary* pNamedObjects;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (!pDb || pDb->getNamedObjectsDictionary(pNamedObjects, create ? AcDb::kForWrite : AcDb::kForRead) != Acad::eOk) {
+        return nullptr;
+    }
+
+    AcDbDictionary* pSegments = nullptr;
+    AcDbObject* pObject;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (pNamedObjects->getAt(segmentDictionary, pObject, mode) == Acad::eOk) {
+        pSegments = AcDbDictionary::cast(pObject);
+        if (!pSegments) {
+            pObject->close();
+        }
+    }
+    else if (create) {
+        pSegments = new AcDbDictionary();
+        AcDbObjectId segmentsId;
+        if (pNamedObjects->setAt(segmentDictionary, pSegments, segmentsId) != Acad::eOk) {
+            delete pSegments;
+            pSegments = nullptr;
+        }
+    }
+    pNamedObjects->close();
+    return pSegments;
+}
+
+
+static bool readRecord(const resbuf* pItem, SegmentTags::Record& record) {
+    auto next = [&pItem](short type) -> const resbuf* {
+        const resbuf* pCurrent = pItem;
+        if (!pCurrent || pCurrent->restype != type) {
+            return nullptr;
+        }
+        pItem = pItem->rbnext;
+        return pCurrent;
+    };
+
+    const resbuf* pOuter = next(AcDb::kDxfInt16);
+    const resbuf* pClockwise = next(AcDb::kDxfInt16);
+    const resbuf* pCount = next(AcDb::kDxfInt32);
+    if (!pOuter || !pClockwise || !pCount || pCount->resval.rlong < 0) {
+        return false;
+    }
+    record.loop.isOuter = pOuter->resval.rint != 0;
+    record.loop.isClockwise = pClockwise->resval.rint != 0;
+
+    size_t cornerCount = static_cast<size_t>(pCount->resval.rlong);
+    record.loop.corners.clear();
+    for (size_t cornerNum = 0; cornerNum < cornerCount; ++cornerNum) {
+        const resbuf* pX = next(AcDb::kDxfReal);
+        const resbuf* pY = next(AcDb::kDxfReal);
+        if (!pX || !pY) {
+            return false;
+        }
+        record.loop.corners.push_back(makePlanPoint(pX->resval.rreal, pY->resval.rreal));
+    }
+
+    record.loop.runThickness.assign(cornerCount, 0.0);
+    record.components.assign(cornerCount, std::vector<AcDbObjectId>());
+    for (size_t edgeNum = 0; edgeNum < cornerCount; ++edgeNum) {
+        const resbuf* pThickness = next(AcDb::kDxfReal);
+        const resbuf* pComponents = next(AcDb::kDxfInt32);
+        if (!pThickness || !pComponents) {
+            return false;
+        }
+        record.loop.runThickness[edgeNum] = pThickness->resval.rreal;
+        for (long componentNum = 0; componentNum < pComponents->resval.rlong; ++componentNum) {
+            const resbuf* pComponent = next(AcDb::kDxfSoftPointerId);
+            if (!pComponent) {
+                return false;
+            }
+            AcDbObjectId componentId;
+            if (acdbGetObjectId(componentId, pComponent->resval.rlname) == Acad::eOk) {
+                record.components[edgeNum].push_back(componentId);
+            }
+        }
+    }
+    return true;
+}
+
+
+static resbuf* buildRecord(const SegmentTags::Record& record) {
+    resbuf* pData = nullptr;
+    resbuf* pTail = nullptr;
+    auto append = [&pData, &pTail](short type) -> resbuf* {
+        resbuf* pItem = acutNewRb(type);
+        if (pTail) {
+            pTail->rbnext = pItem;
+        }
+        else {
+            pData = pItem;
+        }
+        pTail = pItem;
+        return pItem;
+    };
+
+    append(AcDb::kDxfInt16)->resval.rint = record.loop.isOuter ? 1 : 0;
+    append(AcDb::kDxfInt16)->resval.rint = record.loop.isClockwise ? 1 : 0;
+    append(AcDb::kDxfInt32)->resval.rlong = static_cast<int>(record.loop.corners.size());
+    for (const PlanPoint& corner : record.loop.corners) {
+        append(AcDb::kDxfReal)->resval.rreal = corner.x;
+        append(AcDb::kDxfReal)->resval.rreal = corner.y;
+    }
+    for (size_t edgeNum = 0; edgeNum < record.loop.corners.size(); ++edgeNum) {
+        append(AcDb::kDxfReal)->resval.rreal = edgeNum < record.loop.runThickness.size() ? record.loop.runThickness[edgeNum] : 0.0;
+        const std::vector<AcDbObjectId>* components = edgeNum < record.components.size() ? &record.components[edgeNum] : nullptr;
+        append(AcDb::kDxfInt32)->resval.rlong = components ? static_cast<int>(components->size()) : 0;
+        for (size_t componentNum = 0; components && componentNum < components->size(); ++componentNum) {
+            acdbGetAdsName(append(AcDb::kDxfSoftPointerId)->resval.rlname, (*components)[componentNum]);
+        }
+    }
+    return pData;
+}
+
+
+bool SegmentTags::loadLayout(AcDbDatabase* pDb, double& wallThickness, int& wallHeight) {
+    AcDbDictionary* pSegments = openSegments(pDb, AcDb::kForRead, false);
+    if (!pSegments) {
+        return false;
+    }
+
+    bool found = false;
+    AcDbObject* pRecordObject;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (pSegments->getAt(layoutRecord, pRecordObject, AcDb::kForRead) == Acad::eOk) {
+        AcDbXrecord* pRecord = AcDbXrecord::cast(pRecordObject);
+        resbuf* pData = nullptr;
+        if (pRecord && pRecord->rbChain(&pData) == Acad::eOk && pData) {
+            if (pData->restype == AcDb::kDxfReal && pData->rbnext && pData->rbnext->restype == AcDb::kDxfInt32) {
+                wallThickness = pData->resval.rreal;
+                wallHeight = static_cast<int>(pData->rbnext->resval.rlong);
+                found = true;
+            }
+            acutRelRb(pData);
+        }
+        pRecordObject->close();
+    }
+    pSegments->close();
+    return found;
+}
+
+
+void SegmentTags::load(AcDbDatabase* pDb, const std::vector<AcDbObjectId>& polylineIds, const std::vector<char>& wanted,
+    std::vector<Record>& records, std::vector<char>& found) {
+
+    records.resize(polylineIds.size());
+    found.resize(polylineIds.size(), 0);
+    AcDbDictionary* pSegments = openSegments(pDb, AcDb::kForRead, false);
+    if (!pSegments) {
+        return;
+    }
+
+    for (size_t loopNum = 0; loopNum < polylineIds.size(); ++loopNum) {
+        if (loopNum >= wanted.size() || !wanted[loopNum]) {
+            continue;
+        }
+        found[loopNum] = 0;
+        AcDbObject* pRecordObject;
+        Profiler::count(ProfileCounter::ObjectsOpened);
+        if (pSegments->getAt(handleKey(polylineIds[loopNum]).c_str(), pRecordObject, AcDb::kForRead) != Acad::eOk) {
+            continue;
+        }
+        AcDbXrecord* pRecord = AcDbXrecord::cast(pRecordObject);
+        resbuf* pData = nullptr;
+        if (pRecord && pRecord->rbChain(&pData) == Acad::eOk && pData) {
+            found[loopNum] = readRecord(pData, records[loopNum]) ? 1 : 0;
+            acutRelRb(pData);
+        }
+        pRecordObject->close();
+    }
+    pSegments->close();
+}
+
+
+void SegmentTags::save(AcDbDatabase* pDb, const std::vector<AcDbObjectId>& polylineIds, const std::vector<char>& changed,
+    const std::vector<Record>& records, double wallThickness, int wallHeight) {
+
+    AcDbDictionary* pSegments = openSegments(pDb, AcDb::kForWrite, true);
+    if (!pSegments) {
+        acutPrintf(_T("\nFailed to store the wall panel tags in the drawing."));
+        return;
+    }
+
+    auto write = [pSegments](const ACHAR* key, resbuf* pData) {
+        AcDbXrecord* pRecord = nullptr;
+        AcDbObject* pRecordObject;
+        Profiler::count(ProfileCounter::ObjectsOpened);
+        if (pSegments->getAt(key, pRecordObject, AcDb::kForWrite) == Acad::eOk) {
+            pRecord = AcDbXrecord::cast(pRecordObject);
+            if (!pRecord) {
+                pRecordObject->close();
+            }
+        }
+        else {
+            pRecord = new AcDbXrecord();
+            AcDbObjectId recordId;
+            if (pSegments->setAt(key, pRecord, recordId) != Acad::eOk) {
+                delete pRecord;
+                pRecord = nullptr;
+            }
+        }
+        if (pRecord) {
+            if (pData) {
+                pRecord->setFromRbChain(*pData);
+            }
+            pRecord->close();
+        }
+        if (pData) {
+            acutRelRb(pData);
+        }
+    };
+
+    write(layoutRecord, acutBuildList(AcDb::kDxfReal, wallThickness, AcDb::kDxfInt32, wallHeight, RTNONE));
+    for (size_t loopNum = 0; loopNum < polylineIds.size() && loopNum < records.size(); ++loopNum) {
+        if (loopNum < changed.size() && changed[loopNum]) {
+            write(handleKey(polylineIds[loopNum]).c_str(), buildRecord(records[loopNum]));
+        }
+    }
+    pSegments->close();
+}
+
+
+void SegmentTags::purge(AcDbDatabase* pDb, const std::vector<AcDbObjectId>& polylineIds, std::vector<AcDbObjectId>* components) {
+    AcDbDictionary* pSegments = openSegments(pDb, AcDb::kForWrite, false);
+    if (!pSegments) {
+        return;
+    }
+
+    std::map<std::wstring, int> loopOfKey;
+    for (size_t loopNum = 0; loopNum < polylineIds.size(); ++loopNum) {
+        loopOfKey[handleKey(polylineIds[loopNum])] = static_cast<int>(loopNum);
+    }
+    std::vector<std::wstring> orphans;
+    AcDbDictionaryIterator* pIter = pSegments->newIterator();
+    for (; pIter && !pIter->done(); pIter->next()) {
+        std::wstring name = pIter->name();
+        if (name != layoutRecord && loopOfKey.find(name) == loopOfKey.end()) {
+            orphans.push_back(name);
+        }
+    }
+    delete pIter;
+
+    Record record;
+    for (const auto& orphan : orphans) {
+        AcDbObject* pRecordObject;
+        Profiler::count(ProfileCounter::ObjectsOpened);
+        if (components && pSegments->getAt(orphan.c_str(), pRecordObject, AcDb::kForRead) == Acad::eOk) {
+            AcDbXrecord* pRecord = AcDbXrecord::cast(pRecordObject);
+            resbuf* pData = nullptr;
+            if (pRecord && pRecord->rbChain(&pData) == Acad::eOk && pData) {
+                if (readRecord(pData, record)) {
+                    for (const auto& edgeComponents : record.components) {
+                        components->insert(components->end(), edgeComponents.begin(), edgeComponents.end());
+                    }
+                }
+                acutRelRb(pData);
+            }
+            pRecordObject->close();
+        }
+        pSegments->remove(orphan.c_str());
+    }
+    pSegments->close();
+}
@@ -0,0 +1,35 @@
+// SegmentTags.h
+#pragma once
+
+#include <vector>
+#include "dbmain.h"
+#include "LayoutUpdate.h"
+
+// Wall panels placed from each polyline edge, saved with the drawing so PeriUpdate can replace
+// the panels of edited edges only. The PERI_SEGMENTS dictionary in the named object dictionary
+// holds one Xrecord per wall polyline, keyed by the polyline handle: the loop as it was laid
+// out and the block references placed from each of its edges. A LAYOUT record keeps the wall
+// height and thickness of the layout.
+class SegmentTags {
+public:
+    struct Record {
+        PlacedLoop loop;
+        std::vector<std::vector<AcDbObjectId>> components;     // per edge
+    };
+
+    // False when nothing was tagged in this drawing
+    static bool loadLayout(AcDbDatabase* pDb, double& wallThickness, int& wallHeight);
+
+    // Reads the records of the polylines flagged in `wanted`; `found` flags the ones that had one.
+    // Entries of the other polylines are left as they are.
+    static void load(AcDbDatabase* pDb, const std::vector<AcDbObjectId>& polylineIds, const std::vector<char>& wanted,
+        std::vector<Record>& records, std::vector<char>& found);
+
+    // Writes the records of the polylines flagged in `changed`, and the layout record
+    static void save(AcDbDatabase* pDb, const std::vector<AcDbObjectId>& polylineIds, const std::vector<char>& changed,
+        const std::vector<Record>& records, double wallThickness, int wallHeight);
+
+    // Removes the records of polylines that are not in `polylineIds`; their components are
+    // appended to `components` when given
+    static void purge(AcDbDatabase* pDb, const std::vector<AcDbObjectId>& polylineIds, std::vector<AcDbObjectId>* components);
+};
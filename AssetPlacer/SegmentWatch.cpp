@@ -0,0 +1,131 @@
+#include "StdAfx.h"
+#include "SegmentWatch.h"
+#include "dbents.h"
+
+std::map<const AcDbDatabase*, SegmentWatch::DatabaseWatch> SegmentWatch::watches;
+SegmentPolylineReactor* SegmentWatch::polylineReactor = nullptr;
+
+
+class SegmentPolylineReactor : public AcDbObjectReactor {
+public:
+    void modified(const AcDbObject* pObj) override {
+        SegmentWatch::note(pObj->database(), pObj->objectId());
+    }
+
+    void erased(const AcDbObject* pObj, Adesk::Boolean erasing) override {
+        SegmentWatch::note(pObj->database(), pObj->objectId());
+    }
+
+    void goodbye(const AcDbObject* pObj) override {
+        SegmentWatch::unwatch(pObj->database(), pObj->objectId());
+    }
+};
+
+
+class SegmentDatabaseReactor : public AcDbDatabaseReactor {
+public:
+    void objectAppended(const AcDbDatabase* pDb, const AcDbObject* pObj) override {
+        AcDbPolyline* pPolyline = AcDbPolyline::cast(pObj);
+        if (pPolyline && pPolyline->isClosed()) {
+            SegmentWatch::note(pDb, pObj->objectId());
+        }
+    }
+
+    void goodbye(const AcDbDatabase* pDb) override {
+        SegmentWatch::forget(pDb);
+    }
+};
+
+
+void SegmentWatch::watch(AcDbDatabase* pDb, const std::vector<AcDbObjectId>& polylineIds) {
+    if (!pDb) {
+        return;
+    }
+
+    auto watchIt = watches.find(pDb);
+    if (watchIt == watches.end()) {
+        DatabaseWatch databaseWatch;
+        databaseWatch.reactor = new SegmentDatabaseReactor();
+        pDb->addReactor(databaseWatch.reactor);
+        watchIt = watches.emplace(pDb, databaseWatch).first;
+    }
+    if (!polylineReactor) {
+        polylineReactor = new SegmentPolylineReactor();
+    }
+
+    DatabaseWatch& databaseWatch = watchIt->second;
+    for (const auto& polylineId : polylineIds) {
+        if (databaseWatch.watched.count(polylineId)) {
+            continue;
+        }
+        AcDbPolyline* pPolyline;
+        if (acdbOpenObject(pPolyline, polylineId, AcDb::kForRead) != Acad::eOk) {
+            continue;
+        }
+        pPolyline->addReactor(polylineReactor);
+        pPolyline->close();
+        databaseWatch.watched.insert(polylineId);
+    }
+}
+
+
+bool SegmentWatch::watching(const AcDbDatabase* pDb) {
+    return watches.find(pDb) != watches.end();
+}
+
+
+void SegmentWatch::takeEdited(const AcDbDatabase* pDb, std::set<AcDbObjectId>& edited) {
+    edited.clear();
+    auto watchIt = watches.find(pDb);
+    if (watchIt != watches.end()) {
+        edited.swap(watchIt->second.edited);
+    }
+}
+
+
+void SegmentWatch::note(const AcDbDatabase* pDb, const AcDbObjectId& polylineId) {
+    auto watchIt = watches.find(pDb);
+    if (watchIt != watches.end()) {
+        watchIt->second.edited.insert(polylineId);
+    }
+}
+
+
+void SegmentWatch::unwatch(const AcDbDatabase* pDb, const AcDbObjectId& polylineId) {
+    auto watchIt = watches.find(pDb);
+    if (watchIt != watches.end()) {
+        watchIt->second.watched.erase(polylineId);
+    }
+}
+
+
+void SegmentWatch::forget(const AcDbDatabase* pDb) {
+    auto watchIt = watches.find(pDb);
+    if (watchIt == watches.end()) {
+        return;
+    }
+
+    // Called from the reactor's goodbye: take it off the database before it is deleted
+    SegmentDatabaseReactor* pReactor = watchIt->second.reactor;
+    watches.erase(watchIt);
+    const_cast<AcDbDatabase*>(pDb)->removeReactor(pReactor);
+    delete pReactor;
+}
+
+
+void SegmentWatch::shutdown() {
+    for (auto& databaseWatch : watches) {
+        for (const auto& polylineId : databaseWatch.second.watched) {
+            AcDbPolyline* pPolyline;
+            if (acdbOpenObject(pPolyline, polylineId, AcDb::kForRead) == Acad::eOk) {
+                pPolyline->removeReactor(polylineReactor);
+                pPolyline->close();
+            }
+        }
+        const_cast<AcDbDatabase*>(databaseWatch.first)->removeReactor(databaseWatch.second.reactor);
+        delete databaseWatch.second.reactor;
+    }
+    watches.clear();
+    delete polylineReactor;
+    polylineReactor = nullptr;
+}
@@ -0,0 +1,43 @@
+// SegmentWatch.h
+#pragma once
+
+#include <map>
+#include <set>
+#include <vector>
+#include "dbmain.h"
+
+class SegmentPolylineReactor;
+class SegmentDatabaseReactor;
+
+// Wall polylines edited since the last PlaceWalls or PeriUpdate, per database, so PeriUpdate
+// only compares those with their tags. An object reactor on every wall polyline notes edits
+// and erasures; a database reactor notes closed polylines added since. Nothing is kept across
+// sessions: without a watch, PeriUpdate compares every polyline.
+class SegmentWatch {
+public:
+    // Starts watching the polylines in `polylineIds` that are not watched yet
+    static void watch(AcDbDatabase* pDb, const std::vector<AcDbObjectId>& polylineIds);
+
+    static bool watching(const AcDbDatabase* pDb);
+
+    // Polylines edited, erased or added since the last call; the list starts over
+    static void takeEdited(const AcDbDatabase* pDb, std::set<AcDbObjectId>& edited);
+
+    static void shutdown();
+
+private:
+    struct DatabaseWatch {
+        std::set<AcDbObjectId> watched;
+        std::set<AcDbObjectId> edited;
+        SegmentDatabaseReactor* reactor;
+    };
+
+    friend class SegmentPolylineReactor;
+    friend class SegmentDatabaseReactor;
+    static void note(const AcDbDatabase* pDb, const AcDbObjectId& polylineId);
+    static void unwatch(const AcDbDatabase* pDb, const AcDbObjectId& polylineId);
+    static void forget(const AcDbDatabase* pDb);
+
+    static std::map<const AcDbDatabase*, DatabaseWatch> watches;
+    static SegmentPolylineReactor* polylineReactor;
+};
@@ -0,0 +1,108 @@
+#include "StackingPlanner.h"
+#include <algorithm>
+
+std::map<std::tuple<int, int, std::vector<int>>, StackRecipe> StackingPlanner::recipes;
+
+
+int StackRecipe::count(int height) const {
+    return static_cast<int>(std::count(stack.begin(), stack.end(), height));
+}
+
+
+static int greatestCommonDivisor(int a, int b) {
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+
+const StackRecipe& StackingPlanner::recipe(int wallHeight, int baseHeight, const std::vector<int>& heights) {
+    std::tuple<int, int, std::vector<int>> key(wallHeight, baseHeight, heights);
+    auto it = recipes.find(key);
+    if (it == recipes.end()) {
+        it = recipes.emplace(key, plan(wallHeight, baseHeight, heights)).first;
+    }
+    return it->second;
+}
+
+
+const StackRecipe& StackingPlanner::column(int wallHeight, const std::vector<int>& heights) {
+    int baseHeight = 0;
+    for (int height : heights) {
+        if (height > 0 && height <= wallHeight) {
+            baseHeight = height;
+            break;
+        }
+    }
+    return recipe(wallHeight, baseHeight, heights);
+}
+
+
+void StackingPlanner::clear() {
+    recipes.clear();
+}
+
+
+StackRecipe StackingPlanner::plan(int wallHeight, int baseHeight, const std::vector<int>& heights) {
+    StackRecipe result;
+    result.baseHeight = baseHeight;
+    result.totalHeight = baseHeight;
+
+    int remaining = wallHeight - baseHeight;
+    if (baseHeight <= 0 || remaining <= 0) {
+        result.totalHeight = std::max(baseHeight, 0);
+        return result;
+    }
+
+    std::vector<int> sorted;
+    for (int height : heights) {
+        if (height > 0) {
+            sorted.push_back(height);
+        }
+    }
+    if (sorted.empty()) {
+        return result;
+    }
+    std::sort(sorted.begin(), sorted.end(), [](int a, int b) { return a > b; });
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    
+    int unit = 0;
+    for (int height : sorted) {
+        unit = greatestCommonDivisor(unit, height);
+    }
+
+    int units = remaining / unit;
+    std::vector<int> pieces(units + 1, -1);
+    std::vector<int> choice(units + 1, -1);
+    pieces[0] = 0;
+
+    for (int n = 1; n <= units; ++n) {
+        for (size_t i = 0; i < sorted.size(); ++i) {
+            int heightUnits = sorted[i] / unit;
+            if (heightUnits > n || pieces[n - heightUnits] < 0) continue;
+
+            int candidate = pieces[n - heightUnits] + 1;
+            if (pieces[n] < 0 || candidate < pieces[n]) {
+                pieces[n] = candidate;
+                choice[n] = static_cast<int>(i);
+            }
+        }
+    }
+
+    int best = units;
+    while (best > 0 && pieces[best] < 0) {
+        --best;
+    }
+
+    for (int n = best; n > 0; n -= sorted[choice[n]] / unit) {
+        result.stack.push_back(sorted[choice[n]]);
+    }
+    std::sort(result.stack.begin(), result.stack.end(), [](int a, int b) { return a > b; });
+
+    result.totalHeight = baseHeight + best * unit;
+    return result;
+}
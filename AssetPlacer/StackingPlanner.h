@@ -0,0 +1,36 @@
+// StackingPlanner.h
+#pragma once
+
+#include <vector>
+#include <map>
+#include <tuple>
+
+// Vertical make-up of one panel column: the base row panel plus the panels stacked on it
+struct StackRecipe {
+    int baseHeight;
+    std::vector<int> stack;     // stacked panel heights, bottom to top, tallest first
+    int totalHeight;
+
+    // Number of stacked panels (base excluded) of the given height
+    int count(int height) const;
+};
+
+// Plans the vertical panel stack for a wall height. The stack reaches as high as possible
+// without exceeding the wall, with the fewest panels and the tallest panels at the bottom.
+// Recipes are cached, so each (wall height, base, available heights) set is solved once.
+// Has no BRX dependencies.
+class StackingPlanner {
+public:
+    // Column on a base row of `baseHeight`, topped up from `heights` (mm, tallest first)
+    static const StackRecipe& recipe(int wallHeight, int baseHeight, const std::vector<int>& heights);
+
+    // Column whose base is the tallest of `heights` that fits under the wall
+    static const StackRecipe& column(int wallHeight, const std::vector<int>& heights);
+
+    static void clear();
+
+private:
+    static StackRecipe plan(int wallHeight, int baseHeight, const std::vector<int>& heights);
+
+    static std::map<std::tuple<int, int, std::vector<int>>, StackRecipe> recipes;
+};
@@ -0,0 +1,63 @@
+#include "TransformComposer.h"
+#include <cmath>
+
+// Angles closer than this share a cache entry
+static const double angleResolution = 1e-9;
+
+
+static long long quantize(double value) {
+    return std::llround(value / angleResolution);
+}
+
+
+// Quarter turns give exact 0 and +-1 instead of 6e-17 and friends
+static double clean(double value) {
+    const double tolerance = 1e-12;
+    if (std::fabs(value) < tolerance) return 0.0;
+    if (std::fabs(value - 1.0) < tolerance) return 1.0;
+    if (std::fabs(value + 1.0) < tolerance) return -1.0;
+    return value;
+}
+
+
+static LinearTransform axisRotation(int axis, double angle) {
+    double c = clean(std::cos(angle));
+    double s = clean(std::sin(angle));
+    LinearTransform r = { { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } } };
+    int i = (axis + 1) % 3;
+    int j = (axis + 2) % 3;
+    r.m[i][i] = c;
+    r.m[i][j] = -s;
+    r.m[j][i] = s;
+    r.m[j][j] = c;
+    return r;
+}
+
+
+static LinearTransform multiply(const LinearTransform& a, const LinearTransform& b) {
+    LinearTransform product;
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            product.m[row][column] = a.m[row][0] * b.m[0][column] + a.m[row][1] * b.m[1][column] + a.m[row][2] * b.m[2][column];
+        }
+    }
+    return product;
+}
+
+
+const LinearTransform& TransformComposer::compose(double rotation, double rotationX, double rotationY, double rotationZ, double scale) {
+    std::array<long long, 5> key = { { quantize(rotation), quantize(rotationX), quantize(rotationY), quantize(rotationZ), quantize(scale) } };
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    LinearTransform linear = multiply(axisRotation(2, rotationZ),
+        multiply(axisRotation(1, rotationY), multiply(axisRotation(0, rotationX), axisRotation(2, rotation))));
+    for (auto& row : linear.m) {
+        for (double& value : row) {
+            value = clean(value) * scale;
+        }
+    }
+    return cache.emplace(key, linear).first->second;
+}
@@ -0,0 +1,41 @@
+// TransformComposer.h
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <map>
+
+// Rotation and scale part of a block placement, row-major, acting on column vectors
+struct LinearTransform {
+    double m[3][3];
+};
+
+// Builds the placement of a block turned by `rotation` in plan and then about the X, Y and Z
+// axes through its insertion point, as one matrix. Connectors use a handful of angle
+// combinations, so each is composed once and cached. No BRX dependencies: the result is
+// written into any matrix type with a (row, column) accessor, AcGeMatrix3d included.
+class TransformComposer {
+public:
+    // Rz(rotationZ) * Ry(rotationY) * Rx(rotationX) * Rz(rotation) * scale, the same as
+    // setRotation, setScaleFactors and rotateAroundX/Y/ZAxis applied in that order
+    const LinearTransform& compose(double rotation, double rotationX, double rotationY, double rotationZ, double scale);
+
+    size_t size() const { return cache.size(); }
+
+    // 4x4 placement at (x, y, z)
+    template <typename Matrix>
+    static void write(const LinearTransform& linear, double x, double y, double z, Matrix& matrix) {
+        const double translation[3] = { x, y, z };
+        for (unsigned row = 0; row < 3; ++row) {
+            for (unsigned column = 0; column < 3; ++column) {
+                matrix(row, column) = linear.m[row][column];
+            }
+            matrix(row, 3) = translation[row];
+            matrix(3, row) = 0.0;
+        }
+        matrix(3, 3) = 1.0;
+    }
+
+private:
+    std::map<std::array<long long, 5>, LinearTransform> cache;
+};
@@ -9,7 +9,17 @@
 #include "StdAfx.h"
 #include "WallAssetPlacer.h"
 #include "SharedDefinations.h"
+#include "Blocks/AssetRegistry.h"
+#include "Blocks/BlockBatch.h"
+#include "Blocks/PanelStack.h"
 #include "GeometryUtils.h"
+#include "SegmentGrid.h"
+#include "WallLayout.h"
+#include "GeometryStore.h"
+#include "LayoutCache.h"
+#include "LayoutUpdate.h"
+#include "SegmentTags.h"
+#include "SegmentWatch.h"
 #include <vector>
 #include <limits>
 #include "dbapserv.h"
@@ -28,14 +38,15 @@
 #include <thread>
 #include <chrono>
 #include <map>
+#include <set>
+#include "actrans.h"
 #include "Timber/TimberAssetCreator.h"
+#include "Profiler.h"
 
-std::map<AcGePoint3d, std::vector<AcGePoint3d>, WallPlacer::Point3dComparator> WallPlacer::wallMap;
 const int BATCH_SIZE = 1000; 
 
 const double TOLERANCE = 0.1; 
 double proximityTolerance = 1.0; 
-std::vector<AcGePoint3d> processedCorners; 
 double distanceBetweenPolylines = 0.0;
 
 struct Panel {
@@ -44,29 +55,11 @@ struct Panel {
 };
 
 
-struct PolylineCorners {
-	AcDbObjectId polylineId;          
-	std::vector<AcGePoint3d> corners; 
-
-	PolylineCorners(AcDbObjectId id) : polylineId(id) {}
-};
-
-
 bool isInteger(double value, double tolerance = 1e-9) {
 	return std::abs(value - std::round(value)) < tolerance;
 }
 
 
-bool isCloseToProcessedCorners(const AcGePoint3d& point, const std::vector<AcGePoint3d>& processedCorners, double tolerance) {
-	for (const auto& processedCorner : processedCorners) {
-		if (point.distanceTo(processedCorner) < tolerance) {
-			return true; 
-		}
-	}
-	return false;
-}
-
-
 bool isCornerConcave(const AcGePoint3d& prev, const AcGePoint3d& current, const AcGePoint3d& next) {
 	
 	AcGeVector3d v1 = current - prev;
@@ -116,65 +109,6 @@ bool isClockwise(const AcGePoint3d& p0, const AcGePoint3d& p1, const AcGePoint3d
 	
 	
 	return crossProduct.z < 0;
-}
-
-
-void detectClosedPolylinesAndCorners(std::vector<PolylineCorners>& polylineCornerGroups) {
-	polylineCornerGroups.clear();
-
-	
-	AcDbBlockTable* pBlockTable = nullptr;
-	acdbHostApplicationServices()->workingDatabase()->getBlockTable(pBlockTable, AcDb::kForRead);
-
-	
-	AcDbObjectId blockId;
-	pBlockTable->getAt(ACDB_MODEL_SPACE, blockId);
-	pBlockTable->close();
-	
-	AcDbBlockTableRecord* pBlockTableRecord = nullptr;
-	acdbOpenObject(pBlockTableRecord, blockId, AcDb::kForRead);
-
-	
-	AcDbEntity* pEntity = nullptr;
-	AcDbBlockTableRecordIterator* pIterator = nullptr;
-	pBlockTableRecord->newIterator(pIterator);
-	pBlockTableRecord->close();
-
-	for (pIterator->start(); !pIterator->done(); pIterator->step()) {
-		pIterator->getEntity(pEntity, AcDb::kForRead);
-
-		if (pEntity && pEntity->isKindOf(AcDbPolyline::desc())) {
-			AcDbPolyline* pPolyline = AcDbPolyline::cast(pEntity);
-			if (pPolyline && pPolyline->isClosed()) {
-				std::vector<AcGePoint3d> corners;
-				int numVerts = pPolyline->numVerts();
-				for (int i = 0; i < numVerts; ++i) {
-					AcGePoint3d corner;
-					if (pPolyline->getPointAt(i, corner) == Acad::eOk) {
-						corners.push_back(corner);
-					}
-				}
-				PolylineCorners polylineGroup(pEntity->objectId());
-				polylineGroup.corners = corners;
-				polylineCornerGroups.push_back(polylineGroup);
-			}
-		}
-		
-
-		pEntity->close();
-
-	}
-
-	delete pIterator;
-
-	
-	
-	
-	
-	
-	
-	
-	
 }
 
 
@@ -284,72 +218,6 @@ bool directionOfDrawing(std::vector<AcGePoint3d>& points) {
 }
 
 
-void classifyLoopsMultiCheck(const std::vector<std::vector<AcGePoint3d>>& allPolylines,
-	std::vector<std::vector<AcGePoint3d>>& outerLoops,
-	std::vector<std::vector<AcGePoint3d>>& innerLoops, std::vector<bool>& loopIsClockwise) {
-	std::vector<bool> isProcessed(allPolylines.size(), false);
-
-	
-	size_t outermostIndex = -1;
-	double maxArea = -1.0;
-
-	for (size_t i = 0; i < allPolylines.size(); ++i) {
-		double area = calculatePolygonArea(allPolylines[i]);
-		if (area > maxArea) {
-			maxArea = area;
-			outermostIndex = i;
-		}
-	}
-
-	if (outermostIndex != -1) {
-		outerLoops.push_back(allPolylines[outermostIndex]);
-		isProcessed[outermostIndex] = true;
-	}
-
-	
-	for (size_t i = 0; i < allPolylines.size(); ++i) {
-		if (isProcessed[i]) continue;
-		bool isClockwise = directionOfDrawing(const_cast<std::vector<AcGePoint3d>&>(allPolylines[i]));
-		loopIsClockwise.push_back(isClockwise); 
-
-		bool isOuter = false;
-		for (size_t j = 0; j < outerLoops.size(); ++j) {
-			if (isPointInsidePolygon(allPolylines[i][0], outerLoops[j])) {
-				
-				isOuter = true;
-
-				
-				bool containsInner = false;
-				for (size_t k = 0; k < allPolylines.size(); ++k) {
-					if (k == i || isProcessed[k]) continue;
-
-					if (isPointInsidePolygon(allPolylines[k][0], allPolylines[i])) {
-						containsInner = true;
-						break;
-					}
-				}
-
-				if (containsInner) {
-					outerLoops.push_back(allPolylines[i]);
-				}
-				else {
-					innerLoops.push_back(allPolylines[i]);
-				}
-
-				isProcessed[i] = true;
-				break;
-			}
-		}
-
-		
-		if (!isOuter) {
-			outerLoops.push_back(allPolylines[i]);
-			isProcessed[i] = true;
-		}
-	}
-}
-
-
 struct TJoint {
 	AcGePoint3d position;      
 	AcGePoint3d segmentStart;  
@@ -392,32 +260,45 @@ bool isPointNearSegment(const AcGePoint3d& point,
 void detectTJoints(const std::vector<std::vector<AcGePoint3d>>& allLoops,
 	std::vector<TJoint>& detectedTJoints,
 	double threshold = 150.0) {
+	Profiler::Phase phase("tjoints");
 	
 	detectedTJoints.reserve(allLoops.size() * 10); 
 
+	struct LoopSegment {
+		size_t loopIndex;
+		AcGePoint3d start;
+		AcGePoint3d end;
+	};
+
 	
-	for (size_t i = 0; i < allLoops.size(); ++i) {
-		const auto& currentLoop = allLoops[i];
+	std::vector<LoopSegment> loopSegments;
+	// Cells a few thresholds wide: a query still reads at most four cells, and long walls fill fewer cells
+	SegmentGrid segmentGrid(threshold * 4);
+	for (size_t j = 0; j < allLoops.size(); ++j) {
+		const auto& comparisonLoop = allLoops[j];
+		size_t segmentCount = comparisonLoop.size();
 
-		
-		for (const AcGePoint3d& corner : currentLoop) {
-			
-			for (size_t j = 0; j < allLoops.size(); ++j) {
-				if (i == j) continue; 
+		for (size_t segIdx = 0; segIdx < segmentCount; ++segIdx) {
+			const AcGePoint3d& start = comparisonLoop[segIdx];
+			const AcGePoint3d& end = comparisonLoop[(segIdx + 1) % segmentCount];
+
+			segmentGrid.insert(static_cast<int>(loopSegments.size()), start.x, start.y, end.x, end.y);
+			loopSegments.push_back({ j, start, end });
+		}
+	}
 
-				const auto& comparisonLoop = allLoops[j];
-				size_t segmentCount = comparisonLoop.size();
+	
+	std::vector<int> candidates;
+	for (size_t i = 0; i < allLoops.size(); ++i) {
+		for (const AcGePoint3d& corner : allLoops[i]) {
+			segmentGrid.query(corner.x, corner.y, threshold, candidates);
 
-				
-				for (size_t segIdx = 0; segIdx < segmentCount; ++segIdx) {
-					const AcGePoint3d& start = comparisonLoop[segIdx];
-					const AcGePoint3d& end = comparisonLoop[(segIdx + 1) % segmentCount];
+			for (int candidate : candidates) {
+				const LoopSegment& segment = loopSegments[candidate];
+				if (segment.loopIndex == i) continue; 
 
-					
-					if (isPointNearSegment(corner, start, end, threshold)) {
-						
-						detectedTJoints.emplace_back(corner, start, end);
-					}
+				if (isPointNearSegment(corner, segment.start, segment.end, threshold)) {
+					detectedTJoints.emplace_back(corner, segment.start, segment.end);
 				}
 			}
 		}
@@ -426,22 +307,7 @@ void detectTJoints(const std::vector<std::vector<AcGePoint3d>>& allLoops,
 
 
 AcDbObjectId WallPlacer::loadAsset(const wchar_t* blockName) {
-	
-	AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-	if (!pDb) return AcDbObjectId::kNull;
-
-	AcDbBlockTable* pBlockTable;
-	if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) return AcDbObjectId::kNull;
-
-	AcDbObjectId blockId;
-	if (pBlockTable->getAt(blockName, blockId) != Acad::eOk) {
-		pBlockTable->close();
-		return AcDbObjectId::kNull;
-	}
-
-	pBlockTable->close();
-	
-	return blockId;
+	return AssetRegistry::resolve(blockName);
 }
 
 
@@ -453,107 +319,28 @@ void convertToClockwise(std::vector<AcGePoint3d>& polylinePoints) {
 }
 
 
-void WallPlacer::placeWalls() {
-	
-	
-	std::vector<PolylineCorners> polylineCornerGroups;
-	std::vector<TJoint> detectedTJoints;
-	std::vector<std::vector<AcGePoint3d>> outerLoops;
-	std::vector<std::vector<AcGePoint3d>> innerLoops;
-	std::vector<std::vector<AcGePoint3d>> allPolylines;
-	std::vector<bool> loopIsClockwise;
-	struct WallPanel {
-		AcGePoint3d position;
-		AcDbObjectId assetId;
-		double rotation;
-		int length;
-		int height;
-		int loopIndex;
-		bool isOuterLoop;
-
-	};
-	struct LoopInfo {
-		std::vector<AcGePoint3d> points;  
-		bool isOuter;                    
-		bool isClockwise;                
-		double area;                     
-	};
-	std::vector<LoopInfo> loopData;
-	bool ranLoopData = false;
-
-	std::vector<WallPanel> wallPanels;
-	std::vector<std::pair<AcGePoint3d, AcGePoint3d>> Rawsegments;
-	std::vector<std::pair<AcGePoint3d, AcGePoint3d>> segments;
-
-	
-	
-	detectClosedPolylinesAndCorners(polylineCornerGroups);
-
-	
-	if (polylineCornerGroups.empty()) {
+bool WallPlacer::readLoops(std::vector<std::vector<AcGePoint3d>>& allPolylines, WallGeometry& geometry, std::vector<char>* measured) {
+	// The polylines are analysed once per session, from the analysis saved in the drawing, and
+	// kept until a polyline changes
+	const WallGeometry* stored = GeometryStore::geometry(acdbHostApplicationServices()->workingDatabase(), measured);
+	if (!stored || stored->loops.empty()) {
 		acutPrintf(L"\nNo closed polylines detected.\n");
-		return;
+		return false;
 	}
+	geometry = *stored;
 
-	
-	std::vector<AcGePoint3d> corners;
-	for (const auto& polylineGroup : polylineCornerGroups) {
-		corners.insert(corners.end(), polylineGroup.corners.begin(), polylineGroup.corners.end());
-	}
-
-	for (const auto& polylineGroup : polylineCornerGroups) {
-		allPolylines.push_back(polylineGroup.corners);
-	}
-
-	classifyLoopsMultiCheck(allPolylines, outerLoops, innerLoops, loopIsClockwise);
-	
-	double maxArea = -1.0;
-	size_t outerIndex = -1;
-	
-	for (size_t j = 0; j < allPolylines.size(); ++j) {
-		double area = calculatePolygonArea(allPolylines[j]);
-		if (area > maxArea) {
-			maxArea = area;
-			outerIndex = j;
+	for (const PlanLoop& loop : geometry.loops) {
+		std::vector<AcGePoint3d> polyline;
+		for (const PlanPoint& vertex : loop) {
+			polyline.push_back(AcGePoint3d(vertex.x, vertex.y, vertex.z));
 		}
+		allPolylines.push_back(polyline);
 	}
+	return true;
+}
 
-	
-	for (size_t i = 0; i < allPolylines.size(); ++i) {
-		LoopInfo loop;
-		
-		loop.points = allPolylines[i]; 
-		loop.isOuter = (i == outerIndex); 
-		loop.isClockwise = loopIsClockwise[i]; 
-		loop.area = calculatePolygonArea(allPolylines[i]); 
-		
-		loopData.push_back(loop); 
-	}
-
-	
-	
-	
-	
-	
-	
-	
-	
-	
-
-	
-	
-	
-	
-	
-	
-	
-	
-
-	
-	detectTJoints(allPolylines, detectedTJoints);
 
-	int wallHeight = globalVarHeight;
-	int currentHeight = 0;
+WallLayoutSettings WallPlacer::layoutSettings(int wallHeight, std::map<std::pair<int, int>, AcDbObjectId>& panelAssets) {
 	int panelHeights[] = { 1350, 1200, 600 };
 
 	std::vector<Panel> panelSizes = {
@@ -564,501 +351,383 @@ void WallPlacer::placeWalls() {
 		{100, {L"128292X", L"Null", L"129884X"}},
 		{50, {L"128287X", L"Null", L"129879X"}}
 	};
-	struct PanelPlacement {
-		int numPanels;   
-		int panelLength; 
-	};
-
-	int closeLoopCounter = 0;
-	int outerLoopIndexValue = 0;
-	int loopIndex = 0;
-	int loopIndexLastPanel = 0;
-	 closeLoopCounter = -1;
-	distanceBetweenPolylines = getDistanceFromUser();
-
-	double totalPanelsPlaced = 0;
-	std::vector<int> cornerLocations;
-	AcGePoint3d first_start;
 
 	
-	for (size_t cornerNum = 0; cornerNum < corners.size(); ++cornerNum) {
-
-		closeLoopCounter++;
-		cornerLocations.push_back(static_cast<int>(totalPanelsPlaced));
-		AcGePoint3d start = corners[cornerNum];
-		AcGePoint3d end = corners[cornerNum + 1];
-		if (cornerNum == 0) {
-			first_start = start;
-		}
+	WallLayoutSettings layoutSettings;
+	layoutSettings.wallHeight = wallHeight;
+	layoutSettings.angleTolerance = TOLERANCE;
+	for (const auto& panel : panelSizes) {
+		for (int panelNum = 0; panelNum < 3; panelNum++) {
+			AcDbObjectId assetId = loadAsset(panel.id[panelNum].c_str());
+			if (assetId == AcDbObjectId::kNull) continue;
 
-		AcGeVector3d direction = (end - start).normal();
-		direction.normalize();
-		AcGeVector3d reverseDirection = (start - end).normal();
-
-		if (!isInteger(direction.x) || !isInteger(direction.y)) {
-			if (cornerNum < corners.size() - 1) {
-				start = corners[cornerNum];
-				end = corners[cornerNum - closeLoopCounter];
-				closeLoopCounter = -1;
-				loopIndexLastPanel = 1;
-			}
-			else {
-				start = corners[cornerNum];
-				end = corners[cornerNum - closeLoopCounter];
-			}
-		}
-
-		AcGePoint3d prev = corners[(cornerNum + corners.size() - 1) % corners.size()];
-		AcGePoint3d current = corners[cornerNum];
-		AcGePoint3d next;
-		AcGePoint3d nextNext;
-		if (cornerNum + 1 < corners.size()) {
-			
-			next = corners[(cornerNum + 1) % corners.size()];
-		}
-		else {
-			
-			next = corners[cornerNum + 1 - closeLoopCounter];
-		}
-		if (cornerNum + 2 < corners.size()) {
-			nextNext = corners[(cornerNum + 2) % corners.size()]; 
-		}
-		else {
-			nextNext = corners[cornerNum + 2 - (corners.size() / 2)];
-		}
-
-		
-		if (isCloseToProcessedCorners(current, processedCorners, proximityTolerance)) {
-			continue; 
-		}
-
-		bool isConcave = isCornerConcave(prev, current, next);
-		bool isConvex = !isConcave && isCornerConvex(prev, current, next);
-
-		bool isAdjacentConcave = isCornerConcave(current, next, nextNext);
-		bool isAdjacentConvex = !isAdjacentConcave && isCornerConvex(current, next, nextNext);
-
-		if (isConvex) {
-			
-			
-			size_t prevIndex = (cornerNum + corners.size() - 1) % corners.size();
-			size_t nextIndex = (cornerNum + 1) % corners.size();
-
-			
-			
-			
+			panelAssets[std::make_pair(panel.length, panelHeights[panelNum])] = assetId;
+			layoutSettings.stackHeights[panel.length].push_back(panelHeights[panelNum]);
 		}
-		else if (isConcave) {
-			
-			
-			
-		}
-
-		bool prevClockwise = isClockwise(prev, start, end);
-		bool nextClockwise = isClockwise(start, end, next);
 
-		bool isInner = loopIndex != outerLoopIndexValue;
-		bool isOuter = !isInner;  
-		if (!loopIsClockwise[loopIndex]) {
-			isInner = !isInner;
-			isOuter = !isOuter;
-		}
+		int currentHeight = 0;
+		for (int panelNum = 0; panelNum < 3; panelNum++) {
+			if (loadAsset(panel.id[panelNum].c_str()) == AcDbObjectId::kNull) continue;
 
-		direction = (end - start).normal();
-		
-		reverseDirection = (start - end).normal();
-		double rotation = atan2(direction.y, direction.x);
-		int adjustment = 0;
-		LoopInfo loop = loopData[loopIndex];
-		if (loop.isOuter) {
-
-			if (distanceBetweenPolylines == 150 || distanceBetweenPolylines == 200) {
-				adjustment = 550;
-			}
-			else if (distanceBetweenPolylines == 250) {
-				adjustment = 600;
-			}
-			else if (distanceBetweenPolylines == 300) {
-				adjustment = 650;
-			}
-			else if (distanceBetweenPolylines == 350) {
-				adjustment = 700;
-			}
-			else if (distanceBetweenPolylines == 400) {
-				adjustment = 750;
-			}
-			else if (distanceBetweenPolylines == 450) {
-				adjustment = 800;
-			}
-			else if (distanceBetweenPolylines == 500) {
-				adjustment = 850;
-			}
-			else if (distanceBetweenPolylines == 550) {
-				adjustment = 900;
-			}
-			else if (distanceBetweenPolylines == 600) {
-				adjustment = 950;
-			}
-			else if (distanceBetweenPolylines == 650) {
-				adjustment = 1000;
-			}
-			else if (distanceBetweenPolylines == 700) {
-				adjustment = 1050;
-			}
-			else if (distanceBetweenPolylines == 750) {
-				adjustment = 1100;
-			}
-			else if (distanceBetweenPolylines == 800) {
-				adjustment = 1150;
-			}
-			else if (distanceBetweenPolylines == 850) {
-				adjustment = 1200;
-			}
-			else if (distanceBetweenPolylines == 900) {
-				adjustment = 1250;
-			}
-			else if (distanceBetweenPolylines == 950) {
-				adjustment = 1300;
-			}
-			else if (distanceBetweenPolylines == 1000) {
-				adjustment = 1350;
-			}
-			else if (distanceBetweenPolylines == 1050) {
-				adjustment = 1400;
-			}
-			else if (distanceBetweenPolylines == 1100) {
-				adjustment = 1450;
-			}
-			else if (distanceBetweenPolylines == 1150) {
-				adjustment = 1500;
-			}
-			else if (distanceBetweenPolylines == 1200) {
-				adjustment = 1550;
-			}
-			else if (distanceBetweenPolylines == 1250) {
-				adjustment = 1600;
-			}
-			else if (distanceBetweenPolylines == 1300) {
-				adjustment = 1650;
-			}
-			else if (distanceBetweenPolylines == 1350) {
-				adjustment = 1700;
-			}
-			else if (distanceBetweenPolylines == 1400) {
-				adjustment = 1750;
-			}
-			else if (distanceBetweenPolylines == 1450) {
-				adjustment = 1800;
-			}
-			else if (distanceBetweenPolylines == 1500) {
-				adjustment = 1850;
-			}
-			else if (distanceBetweenPolylines == 1550) {
-				adjustment = 1900;
-			}
-			else if (distanceBetweenPolylines == 1600) {
-				adjustment = 1950;
-			}
-			else if (distanceBetweenPolylines == 1650) {
-				adjustment = 2000;
-			}
-			else if (distanceBetweenPolylines == 1700) {
-				adjustment = 2050;
-			}
-			else if (distanceBetweenPolylines == 1750) {
-				adjustment = 2100;
-			}
-			else if (distanceBetweenPolylines == 1800) {
-				adjustment = 2150;
-			}
-			else if (distanceBetweenPolylines == 1850) {
-				adjustment = 2200;
-			}
-			else if (distanceBetweenPolylines == 1900) {
-				adjustment = 2250;
-			}
-			else if (distanceBetweenPolylines == 1950) {
-				adjustment = 2300;
-			}
-			else if (distanceBetweenPolylines == 2000) {
-				adjustment = 2350;
-			}
-			else if (distanceBetweenPolylines == 2050) {
-				adjustment = 2400;
-			}
-			else if (distanceBetweenPolylines == 2100) {
-				adjustment = 2450;
-			}
-			else {
-				adjustment = 150; 
+			if ((wallHeight - currentHeight) / panelHeights[panelNum] > 0) {
+				layoutSettings.baseRows.push_back({ panel.length, panelHeights[panelNum], currentHeight });
+				break;
 			}
-			adjustment -= 100; 
-			int forStartadjustment = 600;
 
-
-			start += direction * adjustment;
-			
-			end += reverseDirection * adjustment;
-
-		}
-		else {
-			if (distanceBetweenPolylines == 150) {
-				start += direction * 300;
-				end += reverseDirection * 300;
-			}
-			else {
-				start += direction * 250;
-				end += reverseDirection * 250;
+			currentHeight += panelHeights[panelNum];
+			if (currentHeight >= wallHeight) {
+				break;
 			}
 		}
+	}
+	return layoutSettings;
+}
 
-		processedCorners.push_back(current); 
 
-		double distance = start.distanceTo(end);
-		
-		AcGePoint3d currentPoint = start;
+double WallPlacer::detectThickness(const WallGeometry& geometry, WallLayoutSettings& settings) {
+	// Edges without a facing edge take the thickness of most of the walls
+	const std::vector<std::vector<FaceThickness>>& faces = geometry.graph.faces();
+	settings.wallThickness = geometry.graph.dominantThickness();
+	settings.edgeThickness.assign(faces.size(), std::vector<double>());
+	for (size_t loopNum = 0; loopNum < faces.size(); ++loopNum) {
+		for (const auto& face : faces[loopNum]) {
+			settings.edgeThickness[loopNum].push_back(face.thickness);
+		}
+	}
+	if (settings.wallThickness > 0) {
+		acutPrintf(_T("\nWall thickness from the polylines: %.0f"), settings.wallThickness);
+	}
+	return settings.wallThickness;
+}
 
-		rotation += M_PI;
-		bool flagInitialPanelLength = false;
-		int panelIndex = 1;
-		std::vector<PanelPlacement> panelPlan; 
-		double remainingDistance = distance; 
 
+bool WallPlacer::computeLayout(LayoutPlan& layoutPlan, double& wallThickness) {
+	std::vector<std::vector<AcGePoint3d>> allPolylines;
+	WallGeometry geometry;
+	if (!readLoops(allPolylines, geometry)) {
+		return false;
+	}
 
-		for (const auto& panel : panelSizes) {
-			currentHeight = 0;
-			
-			
+	std::map<std::pair<int, int>, AcDbObjectId> panelAssets;
+	WallLayoutSettings settings = layoutSettings(globalVarHeight, panelAssets);
 
-			for (int panelNum = 0; panelNum < 3; panelNum++) {
-				AcDbObjectId assetId = loadAsset(panel.id[panelNum].c_str());
-
-				if (assetId != AcDbObjectId::kNull) {
-					int numPanelsHeight = static_cast<int>((wallHeight - currentHeight) / panelHeights[panelNum]);
-
-					
-					
-					if (numPanelsHeight > 0) {
-
-						int numPanels = static_cast<int>(distance / panel.length);
-						double remainingDistance = distance - (numPanels * panel.length);
-						
-						for (int i = 0; i < numPanels; i++) {
-
-							currentPoint += direction * panel.length;
-							
-							AcGePoint3d currentPointWithHeight = currentPoint;
-							currentPointWithHeight.z += currentHeight;
-
-							
-							
-							
-
-							
-							
-							rotation = snapToExactAngle(rotation, TOLERANCE);
-
-							
-							wallPanels.push_back({
-								currentPointWithHeight,  
-								assetId,                 
-								rotation,                
-								panel.length,            
-								panelHeights[panelNum],  
-								loopIndex,               
-								isOuter                  
-								});
-
-							
-							totalPanelsPlaced++;
-							panelIndex++;
-
-							
-
-						}
-						distance = remainingDistance; 
-					}
+	wallThickness = detectThickness(geometry, settings);
+	if (wallThickness <= 0) {
+		acutPrintf(_T("\nNo facing wall polylines to measure the wall thickness from."));
+		return false;
+	}
+	CornerRegistry processedCorners(proximityTolerance);
+	Profiler::Phase phase("wall_layout");
+	WallLayout::build(geometry.loops, geometry.hierarchy, settings, processedCorners, layoutPlan);
+	return true;
+}
 
-					
-					currentHeight += panelHeights[panelNum];
-					
 
-					
-					if (currentHeight >= wallHeight) {
-						
-						break;
+// Queues the panels of wall runs; with panel stacks on, a base panel and the panels stacked
+// on it go in as one stack reference
+struct PanelQueue {
+	AcDbDatabase* pDb;
+	bool useStacks;
+	const std::map<std::pair<int, int>, AcDbObjectId>& panelAssets;
+	std::map<std::vector<int>, AcDbObjectId> stackBlocks;
+	std::vector<int> recipe;
+
+	PanelQueue(AcDbDatabase* pDb, const std::map<std::pair<int, int>, AcDbObjectId>& panelAssets)
+		: pDb(pDb), useStacks(PanelStack::enabled(pDb)), panelAssets(panelAssets) {}
+
+	void queueRun(const LayoutPlan& layoutPlan, const LayoutRun& run, BlockBatch& batch) {
+		size_t runEnd = run.firstItem + run.itemCount;
+		for (size_t itemNum = run.firstItem; itemNum < runEnd; ++itemNum) {
+			const LayoutItem& item = layoutPlan.items[itemNum];
+			AcGePoint3d position(item.position.x, item.position.y, item.position.z);
+
+			if (useStacks && item.type == LayoutComponent::WallPanel) {
+				size_t columnEnd = itemNum + 1;
+				while (columnEnd < runEnd && layoutPlan.items[columnEnd].type == LayoutComponent::StackedPanel) {
+					columnEnd++;
+				}
+				if (columnEnd - itemNum > 1) {
+					recipe.assign(1, item.width);
+					for (size_t partNum = itemNum; partNum < columnEnd; ++partNum) {
+						recipe.push_back(layoutPlan.items[partNum].height);
+					}
+					auto stack = stackBlocks.find(recipe);
+					if (stack == stackBlocks.end()) {
+						std::vector<int> heights(recipe.begin() + 1, recipe.end());
+						stack = stackBlocks.emplace(recipe, PanelStack::definition(pDb, item.width, heights, panelAssets)).first;
+					}
+					if (!stack->second.isNull()) {
+						batch.add(stack->second, position, item.rotation);
+						itemNum = columnEnd - 1;
+						continue;
 					}
 				}
 			}
-		}
-		segments.push_back(std::make_pair(start, end)); 
-		loopIndex = loopIndexLastPanel;
 
+			auto asset = panelAssets.find(std::make_pair(item.width, item.height));
+			if (asset == panelAssets.end()) continue;
 
-		
-		std::vector<AcDbObjectId> centerAssets = {
-			loadAsset(L"128285X"),
-			loadAsset(L"129842X"),
-			loadAsset(L"129879X"),
-			loadAsset(L"129884X"),
-			loadAsset(L"128287X"),
-			loadAsset(L"128292X")
-		};
-
-		int prevStartCornerIndex = -1;
-		int movedCompensators = 0;
+			batch.add(asset->second, position, item.rotation);
+		}
+	}
+};
 
-		
-		
-		
 
-		
-		
-		
-		
-		
-		
+void WallPlacer::placeWalls() {
+	
+	
+	std::vector<TJoint> detectedTJoints;
+	std::vector<std::vector<AcGePoint3d>> allPolylines;
+	WallGeometry geometry;
 
-		
+	if (!readLoops(allPolylines, geometry)) {
+		return;
+	}
+	const std::vector<AcDbObjectId>& polylineIds = geometry.polylineIds;
+	const std::vector<PlanLoop>& planLoops = geometry.loops;
+	const LoopHierarchy& loopHierarchy = geometry.hierarchy;
 
+	
+	detectTJoints(allPolylines, detectedTJoints);
 
-		
+	int wallHeight = globalVarHeight;
+	std::map<std::pair<int, int>, AcDbObjectId> panelAssets;
+	WallLayoutSettings layoutSettings = WallPlacer::layoutSettings(wallHeight, panelAssets);
+
+	// The thickness is only asked for when no wall face has another one across from it
+	distanceBetweenPolylines = detectThickness(geometry, layoutSettings);
+	if (distanceBetweenPolylines <= 0) {
+		acutPrintf(_T("\nNo facing wall polylines found."));
+		distanceBetweenPolylines = getDistanceFromUser();
+		layoutSettings.wallThickness = distanceBetweenPolylines;
+	}
+	CornerRegistry processedCorners(proximityTolerance);
+	LayoutPlan layoutPlan;
+	{
+		Profiler::Phase phase("wall_layout");
+		WallLayout::build(planLoops, loopHierarchy, layoutSettings, processedCorners, layoutPlan);
+	}
 
-		
-		
+	
+	AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
+	PanelQueue panelQueue(pDb, panelAssets);
+
+	// Batch entries [runBlocks[i], runBlocks[i + 1]) hold the panels of run i
+	BlockBatch wallBatch(_T("wall panel"));
+	wallBatch.reserve(layoutPlan.items.size());
+	std::vector<size_t> runBlocks(1, 0);
+	for (const LayoutRun& run : layoutPlan.runs) {
+		panelQueue.queueRun(layoutPlan, run, wallBatch);
+		runBlocks.push_back(wallBatch.size());
+	}
+	std::vector<AcDbObjectId> placedIds;
+	if (wallBatch.commit(&placedIds) > 0) {
+		// Ties and other accessories are placed from this layout instead of laying the walls out again
+		LayoutCache::store(pDb, layoutPlan, distanceBetweenPolylines, wallHeight);
+
+		// Every panel is tagged with the polyline edge it was laid out from, for PeriUpdate
+		std::vector<std::vector<double>> runThickness;
+		LayoutUpdate::runThickness(layoutPlan, planLoops, runThickness);
+		std::vector<SegmentTags::Record> records(planLoops.size());
+		for (size_t loopNum = 0; loopNum < planLoops.size(); ++loopNum) {
+			records[loopNum].loop = LayoutUpdate::placed(planLoops[loopNum], loopNum, loopHierarchy, runThickness);
+			records[loopNum].components.assign(planLoops[loopNum].size(), std::vector<AcDbObjectId>());
+		}
+		for (size_t runNum = 0; runNum < layoutPlan.runs.size(); ++runNum) {
+			const LayoutRun& run = layoutPlan.runs[runNum];
+			records[run.loop].components[run.edge].assign(placedIds.begin() + runBlocks[runNum], placedIds.begin() + runBlocks[runNum + 1]);
+		}
+		SegmentTags::purge(pDb, polylineIds, nullptr);
+		SegmentTags::save(pDb, polylineIds, std::vector<char>(planLoops.size(), 1), records, distanceBetweenPolylines, wallHeight);
+		SegmentWatch::watch(pDb, polylineIds);
+	}
 
-		
-		
-		
-		
-		
-		
-		
-		
-		
-		
-		
-		
-		
-		
+	acutPrintf(_T("\nCompleted placing walls."));
+}
 
 
-		
-		
-		
-		
+// Erases the block references in `componentIds` inside the running command transaction, so
+// they come back when the command is rolled back
+static int eraseComponents(const std::vector<AcDbObjectId>& componentIds) {
+	int erased = 0;
+	for (const auto& componentId : componentIds) {
+		if (componentId.isNull() || componentId.isErased()) continue;
 
-		
-		
-		
-		
+		AcDbObject* pObject = nullptr;
+		Profiler::count(ProfileCounter::ObjectsOpened);
+		if (actrTransactionManager->getObject(pObject, componentId, AcDb::kForWrite) != Acad::eOk) continue;
+		if (pObject->erase() == Acad::eOk) {
+			erased++;
+		}
+	}
+	return erased;
+}
 
-		
-		
 
-		
-		
+void WallPlacer::updateWalls() {
+	AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
+	double placedThickness = 0.0;
+	int placedHeight = 0;
+	if (!SegmentTags::loadLayout(pDb, placedThickness, placedHeight)) {
+		acutPrintf(_T("\nNo tagged wall panels in this drawing; run PlaceWalls first."));
+		return;
+	}
 
-		
+	std::vector<std::vector<AcGePoint3d>> allPolylines;
+	WallGeometry geometry;
+	std::vector<char> measured;
+	if (!readLoops(allPolylines, geometry, &measured)) {
+		return;
+	}
+	const std::vector<AcDbObjectId>& polylineIds = geometry.polylineIds;
+	const std::vector<PlanLoop>& planLoops = geometry.loops;
+	const LoopHierarchy& loopHierarchy = geometry.hierarchy;
 
-		
-		
-		
-		
-		
-		
-		
-		
-		
-		
+	int wallHeight = globalVarHeight;
+	std::map<std::pair<int, int>, AcDbObjectId> panelAssets;
+	WallLayoutSettings layoutSettings = WallPlacer::layoutSettings(wallHeight, panelAssets);
+
+	// Without facing polylines the thickness PlaceWalls was given still holds
+	distanceBetweenPolylines = detectThickness(geometry, layoutSettings);
+	if (distanceBetweenPolylines <= 0) {
+		distanceBetweenPolylines = placedThickness;
+		layoutSettings.wallThickness = distanceBetweenPolylines;
+	}
 
+	// The layout itself is cheap next to the drawing writes, so it is computed in full and
+	// only the runs whose corners, thickness or corner skipping changed are placed again
+	CornerRegistry processedCorners(proximityTolerance);
+	LayoutPlan layoutPlan;
+	{
+		Profiler::Phase phase("wall_layout");
+		WallLayout::build(planLoops, loopHierarchy, layoutSettings, processedCorners, layoutPlan);
+	}
+	std::vector<std::vector<double>> runThickness;
+	LayoutUpdate::runThickness(layoutPlan, planLoops, runThickness);
+
+	// Polylines compared with their tags: the ones edited since the last placement and the ones
+	// whose faces were measured again. All of them when nothing was watched in this session
+	// or the wall height or thickness changed.
+	bool compareAll = !SegmentWatch::watching(pDb) || wallHeight != placedHeight ||
+		std::fabs(distanceBetweenPolylines - placedThickness) > 0.5;
+	std::set<AcDbObjectId> edited;
+	SegmentWatch::takeEdited(pDb, edited);
+	std::vector<char> candidates(planLoops.size(), compareAll ? 1 : 0);
+	for (size_t loopNum = 0; loopNum < planLoops.size(); ++loopNum) {
+		if (edited.count(polylineIds[loopNum]) || (loopNum < measured.size() && measured[loopNum])) {
+			candidates[loopNum] = 1;
+		}
+	}
 
-		
-		
-		
-		
-		
-		
-		
-		
-		
+	// Panels of polylines that were erased or opened
+	std::vector<AcDbObjectId> staleComponents;
+	SegmentTags::purge(pDb, polylineIds, &staleComponents);
+
+	// Corner skipping can change at corners near a moved one, so those loops are compared as well
+	std::vector<SegmentTags::Record> records;
+	std::vector<char> tagged;
+	std::vector<char> compared(planLoops.size(), 0);
+	std::vector<char> changed(planLoops.size(), 0);
+	std::vector<std::vector<char>> dirty(planLoops.size());
+	std::vector<PlanPoint> moved;
+	for (;;) {
+		std::vector<char> wanted(planLoops.size(), 0);
+		bool anyWanted = false;
+		for (size_t loopNum = 0; loopNum < planLoops.size(); ++loopNum) {
+			if (candidates[loopNum] && !compared[loopNum]) {
+				wanted[loopNum] = 1;
+				anyWanted = true;
+			}
+		}
+		if (!anyWanted) {
+			break;
+		}
 
-		
-		
-		for (size_t i = 0; i < cornerLocations.size(); ++i) {
-			
+		SegmentTags::load(pDb, polylineIds, wanted, records, tagged);
+		for (size_t loopNum = 0; loopNum < planLoops.size(); ++loopNum) {
+			if (!wanted[loopNum]) continue;
+
+			compared[loopNum] = 1;
+			PlacedLoop current = LayoutUpdate::placed(planLoops[loopNum], loopNum, loopHierarchy, runThickness);
+			if (!tagged[loopNum] || wallHeight != placedHeight) {
+				// A new polyline, or every panel changes height
+				dirty[loopNum].assign(planLoops[loopNum].size(), 1);
+				moved.insert(moved.end(), planLoops[loopNum].begin(), planLoops[loopNum].end());
+				changed[loopNum] = 1;
+			}
+			else if (LayoutUpdate::compare(records[loopNum].loop, current, 0.05, dirty[loopNum], moved) > 0) {
+				changed[loopNum] = 1;
+			}
 		}
-		
-		wallHeight = globalVarHeight;
-		currentHeight = globalVarHeight;
-	}
-	
-	AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-	if (!pDb) {
-		acutPrintf(_T("\nNo working database found."));
-		return;
+		LayoutUpdate::loopsNear(planLoops, moved, proximityTolerance, candidates);
 	}
 
-	AcDbBlockTable* pBlockTable;
-	if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
-		acutPrintf(_T("\nFailed to get block table."));
+	std::vector<size_t> dirtyRuns;
+	LayoutUpdate::dirtyRuns(layoutPlan, dirty, dirtyRuns);
+	int comparedCount = 0;
+	int changedCount = 0;
+	for (size_t loopNum = 0; loopNum < planLoops.size(); ++loopNum) {
+		comparedCount += compared[loopNum] ? 1 : 0;
+		changedCount += changed[loopNum] ? 1 : 0;
+	}
+	if (changedCount == 0 && staleComponents.empty()) {
+		acutPrintf(_T("\nThe wall panels are up to date (%d of %d polylines compared)."), comparedCount, static_cast<int>(planLoops.size()));
+		LayoutCache::store(pDb, layoutPlan, distanceBetweenPolylines, wallHeight);
+		SegmentWatch::watch(pDb, polylineIds);
 		return;
 	}
 
-	AcDbBlockTableRecord* pModelSpace;
-	if (pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForWrite) != Acad::eOk) {
-		acutPrintf(_T("\nFailed to get model space."));
-		pBlockTable->close();
+	// The panels of the changed edges make way for the ones laid out now
+	for (size_t loopNum = 0; loopNum < planLoops.size(); ++loopNum) {
+		if (!changed[loopNum] || !tagged[loopNum]) continue;
+
+		for (size_t edgeNum = 0; edgeNum < dirty[loopNum].size() && edgeNum < records[loopNum].components.size(); ++edgeNum) {
+			if (dirty[loopNum][edgeNum]) {
+				const auto& components = records[loopNum].components[edgeNum];
+				staleComponents.insert(staleComponents.end(), components.begin(), components.end());
+			}
+		}
+	}
+	int erased = eraseComponents(staleComponents);
+
+	PanelQueue panelQueue(pDb, panelAssets);
+	BlockBatch wallBatch(_T("wall panel"));
+	std::vector<size_t> runBlocks(1, 0);
+	for (size_t runNum : dirtyRuns) {
+		panelQueue.queueRun(layoutPlan, layoutPlan.runs[runNum], wallBatch);
+		runBlocks.push_back(wallBatch.size());
+	}
+	std::vector<AcDbObjectId> placedIds;
+	if (!wallBatch.empty() && wallBatch.commit(&placedIds) == 0) {
+		// The command transaction puts the erased panels back
 		return;
 	}
-	int timberHeight;
-	for (const auto& panel : wallPanels) {
 
-		AcDbBlockReference* pBlockRef = new AcDbBlockReference();
-		pBlockRef->setPosition(panel.position);
-		pBlockRef->setBlockTableRecord(panel.assetId);
-		pBlockRef->setRotation(panel.rotation);
-		pBlockRef->setScaleFactors(AcGeScale3d(globalVarScale));
+	for (size_t loopNum = 0; loopNum < planLoops.size(); ++loopNum) {
+		if (!changed[loopNum]) continue;
 
-		if (pModelSpace->appendAcDbEntity(pBlockRef) != Acad::eOk) {
-			acutPrintf(_T("\nFailed to place wall segment."));
+		SegmentTags::Record& record = records[loopNum];
+		record.loop = LayoutUpdate::placed(planLoops[loopNum], loopNum, loopHierarchy, runThickness);
+		if (!tagged[loopNum] || record.components.size() != planLoops[loopNum].size()) {
+			record.components.assign(planLoops[loopNum].size(), std::vector<AcDbObjectId>());
 		}
-		pBlockRef->close();
-		currentHeight = panel.height;
-		timberHeight = panel.height;
-		for (const auto& panel2 : panelSizes) {
-			if (panel2.length == panel.length) {
-				for (int panelNum = 0; panelNum < 3; panelNum++) {
-					AcDbObjectId assetId = loadAsset(panel2.id[panelNum].c_str());
-
-					if (assetId != AcDbObjectId::kNull) {
-						int numPanelsHeight = static_cast<int>((wallHeight - currentHeight) / panelHeights[panelNum]);
-
-						for (int x = 0; x < numPanelsHeight; x++) {
-
-							AcGePoint3d currentPointWithHeight = panel.position;
-							currentPointWithHeight.z += currentHeight;
-
-							AcDbBlockReference* pBlockRef = new AcDbBlockReference();
-							pBlockRef->setPosition(currentPointWithHeight);
-							pBlockRef->setBlockTableRecord(assetId);
-							pBlockRef->setRotation(panel.rotation);
-							pBlockRef->setScaleFactors(AcGeScale3d(globalVarScale));
-
-							if (pModelSpace->appendAcDbEntity(pBlockRef) != Acad::eOk) {
-								acutPrintf(_T("\nFailed to place wall segment."));
-							}
-							pBlockRef->close();
-							currentHeight += panelHeights[panelNum];
-						}
-					}
-				}
+		for (size_t edgeNum = 0; edgeNum < dirty[loopNum].size(); ++edgeNum) {
+			if (dirty[loopNum][edgeNum]) {
+				record.components[edgeNum].clear();
 			}
 		}
 	}
-
-	pModelSpace->close();
-	pBlockTable->close();
-
-	acutPrintf(_T("\nCompleted placing walls."));
+	for (size_t dirtyNum = 0; dirtyNum < dirtyRuns.size(); ++dirtyNum) {
+		const LayoutRun& run = layoutPlan.runs[dirtyRuns[dirtyNum]];
+		records[run.loop].components[run.edge].assign(placedIds.begin() + runBlocks[dirtyNum], placedIds.begin() + runBlocks[dirtyNum + 1]);
+	}
+	SegmentTags::save(pDb, polylineIds, changed, records, distanceBetweenPolylines, wallHeight);
+	LayoutCache::store(pDb, layoutPlan, distanceBetweenPolylines, wallHeight);
+	SegmentWatch::watch(pDb, polylineIds);
+
+	acutPrintf(_T("\nReplaced the panels of %d of %d wall runs on %d polylines (%d panels removed, %d of %d polylines compared)."),
+		static_cast<int>(dirtyRuns.size()), static_cast<int>(layoutPlan.runs.size()), changedCount, erased,
+		comparedCount, static_cast<int>(planLoops.size()));
+	// Only wall panels are tagged per run; the other placers do not know which of theirs stand there
+	acutPrintf(_T("\nTies, corner assets and connectors of the replaced runs are not updated: run PlaceTies, PlaceInsideCorners, PlaceOutsideCorners and PlaceConnectors again."));
 }
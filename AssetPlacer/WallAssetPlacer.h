@@ -4,6 +4,8 @@
 #pragma once
 #include <vector>
 #include "gepnt3d.h"
+#include "WallLayout.h"
+#include <map>
 
 #ifdef max
 #undef max
@@ -30,25 +32,27 @@ struct PolylineInfo {
 
 extern double distanceBetweenPolylines;
 
+struct WallGeometry;
+
 class WallPlacer {
 public:
     static void placeWalls();
 
+    // Replaces the panels of the wall runs whose polyline edges changed since PlaceWalls (or
+    // the last update), using the segment tags PlaceWalls saved in the drawing
+    static void updateWalls();
+
+    // Wall layout of the closed polylines in the drawing without placing anything, for
+    // commands that need the panels when the last PlaceWalls layout is not cached.
+    // `wallThickness` receives the thickness covering most of the walls.
+    static bool computeLayout(LayoutPlan& layoutPlan, double& wallThickness);
+
 private:
     
     static AcDbObjectId loadAsset(const wchar_t* blockName);
-    // Comparator for AcGePoint3d to be used in the map
-    struct Point3dComparator {
-		bool operator()(const AcGePoint3d& lhs, const AcGePoint3d& rhs) const {
-			if (lhs.x != rhs.x)
-				return lhs.x < rhs.x;
-			if (lhs.y != rhs.y)
-				return lhs.y < rhs.y;
-			return lhs.z < rhs.z;
-		}
-	};
-	
-	// Static member to hold the wall mapping
-	static std::map<AcGePoint3d, std::vector<AcGePoint3d>, Point3dComparator> wallMap;
+    // Closed polylines of the drawing with their analysis; `measured` as in GeometryStore::geometry
+    static bool readLoops(std::vector<std::vector<AcGePoint3d>>& allPolylines, WallGeometry& geometry, std::vector<char>* measured = nullptr);
+    static WallLayoutSettings layoutSettings(int wallHeight, std::map<std::pair<int, int>, AcDbObjectId>& panelAssets);
+    static double detectThickness(const WallGeometry& geometry, WallLayoutSettings& settings);
 };
 // Path: WallPlacer.cpp
\ No newline at end of file
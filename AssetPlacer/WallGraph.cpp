@@ -0,0 +1,371 @@
+#include "WallGraph.h"
+#include "PointKey.h"
+#include "SegmentGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
+static const double pi = 3.141592653589793238462643383279;
+
+// Same orientation grouping as WallThickness, so axis aligned walls share an exact direction
+static const long long orientationCount = 3600;
+static const double orientationStep = pi / orientationCount;
+
+// Segment ends and joints closer than this (mm) are the same point
+static const double jointTolerance = 5.0;
+
+// Nodes are merged on a 1 mm grid
+static const double nodeResolution = 1.0;
+
+
+namespace {
+
+// Straight wall centreline: points u * s + n * offset for s in [from, to], n = (-uy, ux)
+struct CentreLine {
+    double ux, uy;
+    double offset;
+    double from, to;
+    double thickness;
+    std::vector<WallFaceRef> left;
+    std::vector<WallFaceRef> right;
+};
+
+PlanPoint pointAt(const CentreLine& line, double s) {
+    return makePlanPoint(line.ux * s - line.uy * line.offset, line.uy * s + line.ux * line.offset);
+}
+
+void addFace(std::vector<WallFaceRef>& faces, const WallFaceRef& face) {
+    for (const WallFaceRef& existing : faces) {
+        if (existing.loop == face.loop && existing.edge == face.edge) {
+            return;
+        }
+    }
+    faces.push_back(face);
+}
+
+}
+
+
+void WallGraph::clear() {
+    nodeList.clear();
+    walls.clear();
+    faceList.clear();
+    faceWalls.clear();
+    dominant = 0.0;
+}
+
+
+void WallGraph::build(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy) {
+    std::vector<std::vector<FaceThickness>> faces;
+    WallThickness::measure(loops, hierarchy, faces);
+    build(loops, hierarchy, faces);
+}
+
+
+void WallGraph::build(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy,
+    const std::vector<std::vector<FaceThickness>>& faces) {
+
+    clear();
+    faceList = faces;
+    dominant = WallThickness::dominant(loops, faceList);
+
+    // Centreline segment where each paired face overlaps the face across from it
+    std::map<std::pair<long long, long long>, std::vector<CentreLine>> groups;
+    for (size_t loopNum = 0; loopNum < loops.size(); ++loopNum) {
+        const PlanLoop& loop = loops[loopNum];
+        for (size_t edgeNum = 0; edgeNum < loop.size(); ++edgeNum) {
+            const FaceThickness& face = faceList[loopNum][edgeNum];
+            if (face.oppositeLoop < 0 || face.thickness <= 0) {
+                continue;
+            }
+            const PlanLoop& opposite = loops[face.oppositeLoop];
+            const PlanPoint& p1 = loop[edgeNum];
+            const PlanPoint& p2 = loop[(edgeNum + 1) % loop.size()];
+            const PlanPoint& q1 = opposite[face.oppositeEdge];
+            const PlanPoint& q2 = opposite[(face.oppositeEdge + 1) % opposite.size()];
+
+            // Directions are taken modulo a half turn, pointing right or straight up
+            long long key = std::llround(std::atan2(p2.y - p1.y, p2.x - p1.x) / orientationStep);
+            key = ((key % orientationCount) + orientationCount) % orientationCount;
+            if (key > orientationCount / 2) {
+                key -= orientationCount;
+            }
+
+            CentreLine line;
+            line.ux = std::cos(key * orientationStep);
+            line.uy = std::sin(key * orientationStep);
+            double pFrom = line.ux * p1.x + line.uy * p1.y;
+            double pTo = line.ux * p2.x + line.uy * p2.y;
+            double qFrom = line.ux * q1.x + line.uy * q1.y;
+            double qTo = line.ux * q2.x + line.uy * q2.y;
+            line.from = std::max(std::min(pFrom, pTo), std::min(qFrom, qTo));
+            line.to = std::min(std::max(pFrom, pTo), std::max(qFrom, qTo));
+            if (line.to - line.from <= jointTolerance) {
+                continue;
+            }
+
+            double pOffset = -line.uy * p1.x + line.ux * p1.y;
+            double qOffset = -line.uy * q1.x + line.ux * q1.y;
+            line.offset = (pOffset + qOffset) / 2;
+            line.thickness = face.thickness;
+
+            WallFaceRef own = { static_cast<int>(loopNum), static_cast<int>(edgeNum), hierarchy.isOuter(loopNum) };
+            WallFaceRef across = { face.oppositeLoop, face.oppositeEdge, hierarchy.isOuter(face.oppositeLoop) };
+            (pOffset > line.offset ? line.left : line.right).push_back(own);
+            (pOffset > line.offset ? line.right : line.left).push_back(across);
+
+            groups[std::make_pair(key, std::llround(line.offset))].push_back(line);
+        }
+    }
+
+    // Both faces of a wall give the same segment, and a long face pairs with several short ones
+    std::vector<CentreLine> lines;
+    for (auto& group : groups) {
+        std::vector<CentreLine>& segments = group.second;
+        std::sort(segments.begin(), segments.end(), [](const CentreLine& a, const CentreLine& b) {
+            return a.from < b.from || (a.from == b.from && a.thickness < b.thickness);
+        });
+
+        // Last line of each thickness on this centreline
+        std::map<double, size_t> open;
+        for (const CentreLine& segment : segments) {
+            auto openIt = open.find(segment.thickness);
+            if (openIt == open.end() || segment.from > lines[openIt->second].to + jointTolerance) {
+                open[segment.thickness] = lines.size();
+                lines.push_back(segment);
+                continue;
+            }
+            CentreLine* merged = &lines[openIt->second];
+            merged->to = std::max(merged->to, segment.to);
+            for (const WallFaceRef& face : segment.left) addFace(merged->left, face);
+            for (const WallFaceRef& face : segment.right) addFace(merged->right, face);
+        }
+    }
+    if (lines.empty()) {
+        return;
+    }
+
+    // A centreline stops short of the wall it runs into by half that wall's thickness; the end is
+    // pulled onto the other centreline, which is split there unless the two meet at its end
+    double reach = 0.0;
+    for (const CentreLine& line : lines) {
+        reach = std::max(reach, line.thickness);
+    }
+    SegmentGrid grid(std::max(reach, 100.0) * 2);
+    for (size_t lineNum = 0; lineNum < lines.size(); ++lineNum) {
+        PlanPoint a = pointAt(lines[lineNum], lines[lineNum].from);
+        PlanPoint b = pointAt(lines[lineNum], lines[lineNum].to);
+        grid.insert(static_cast<int>(lineNum), a.x, a.y, b.x, b.y);
+    }
+
+    std::vector<double> newFrom(lines.size());
+    std::vector<double> newTo(lines.size());
+    std::vector<std::vector<double>> splits(lines.size());
+    std::vector<int> nearby;
+    for (size_t lineNum = 0; lineNum < lines.size(); ++lineNum) {
+        const CentreLine& line = lines[lineNum];
+        newFrom[lineNum] = line.from;
+        newTo[lineNum] = line.to;
+
+        for (int side = 0; side < 2; ++side) {
+            double s = side == 0 ? line.from : line.to;
+            double outward = side == 0 ? -1.0 : 1.0;
+            PlanPoint end = pointAt(line, s);
+            grid.query(end.x, end.y, reach, nearby);
+
+            double bestDistance = std::numeric_limits<double>::max();
+            double bestStep = 0.0;
+            double bestAlong = 0.0;
+            int bestLine = -1;
+            for (int otherNum : nearby) {
+                const CentreLine& other = lines[otherNum];
+                double normalDot = -other.uy * line.ux + other.ux * line.uy;
+                if (otherNum == static_cast<int>(lineNum) || std::fabs(normalDot) < 0.1) {
+                    continue;
+                }
+
+                double step = (other.offset - (-other.uy * end.x + other.ux * end.y)) / normalDot;
+                double distance = step * outward;
+                if (distance < -jointTolerance || distance > other.thickness / 2 + jointTolerance) {
+                    continue;
+                }
+                double along = other.ux * (end.x + line.ux * step) + other.uy * (end.y + line.uy * step);
+                if (along < other.from - line.thickness / 2 - jointTolerance ||
+                    along > other.to + line.thickness / 2 + jointTolerance) {
+                    continue;
+                }
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    bestStep = step;
+                    bestAlong = along;
+                    bestLine = otherNum;
+                }
+            }
+            if (bestLine < 0) {
+                continue;
+            }
+
+            (side == 0 ? newFrom : newTo)[lineNum] = s + bestStep;
+            const CentreLine& other = lines[bestLine];
+            if (bestAlong > other.from + jointTolerance && bestAlong < other.to - jointTolerance) {
+                splits[bestLine].push_back(bestAlong);
+            }
+        }
+    }
+
+    // Cut the centrelines into walls between joints and hook them up to the nodes
+    PointMap<int> nodeIndex;
+    auto nodeAt = [&](const PlanPoint& point) {
+        int& index = nodeIndex[PointKey::of(point, nodeResolution)];
+        if (index == 0) {
+            nodeList.push_back({ point, WallNodeType::End, {} });
+            index = static_cast<int>(nodeList.size());
+        }
+        return index - 1;
+    };
+
+    // Per face: overlap with its longest piece, and how far its first and last corner are from
+    // the pieces found for them so far
+    struct FaceFit {
+        double overlap;
+        double firstGap;
+        double lastGap;
+    };
+    const double noFit = std::numeric_limits<double>::max();
+    faceWalls.assign(loops.size(), std::vector<FaceWalls>());
+    std::vector<std::vector<FaceFit>> faceFit(loops.size());
+    for (size_t loopNum = 0; loopNum < loops.size(); ++loopNum) {
+        faceWalls[loopNum].assign(loops[loopNum].size(), { -1, -1, -1 });
+        faceFit[loopNum].assign(loops[loopNum].size(), { 0.0, noFit, noFit });
+    }
+
+    std::vector<double> cuts;
+    for (size_t lineNum = 0; lineNum < lines.size(); ++lineNum) {
+        const CentreLine& line = lines[lineNum];
+        cuts.assign(1, newFrom[lineNum]);
+        std::sort(splits[lineNum].begin(), splits[lineNum].end());
+        for (double split : splits[lineNum]) {
+            if (split > cuts.back() + jointTolerance && split < newTo[lineNum] - jointTolerance) {
+                cuts.push_back(split);
+            }
+        }
+        cuts.push_back(newTo[lineNum]);
+
+        for (size_t cutNum = 0; cutNum + 1 < cuts.size(); ++cutNum) {
+            double from = cuts[cutNum];
+            double to = cuts[cutNum + 1];
+            if (to - from <= jointTolerance) {
+                continue;
+            }
+
+            WallEdge wall;
+            wall.start = pointAt(line, from);
+            wall.end = pointAt(line, to);
+            wall.from = nodeAt(wall.start);
+            wall.to = nodeAt(wall.end);
+            wall.thickness = line.thickness;
+            int wallNum = static_cast<int>(walls.size());
+
+            for (int side = 0; side < 2; ++side) {
+                for (const WallFaceRef& face : side == 0 ? line.left : line.right) {
+                    const PlanLoop& loop = loops[face.loop];
+                    const PlanPoint& p1 = loop[face.edge];
+                    const PlanPoint& p2 = loop[(face.edge + 1) % loop.size()];
+                    double a = line.ux * p1.x + line.uy * p1.y;
+                    double b = line.ux * p2.x + line.uy * p2.y;
+                    double overlap = std::min(to, std::max(a, b)) - std::max(from, std::min(a, b));
+                    if (overlap <= jointTolerance) {
+                        continue;
+                    }
+                    (side == 0 ? wall.leftFaces : wall.rightFaces).push_back(face);
+                    FaceFit& fit = faceFit[face.loop][face.edge];
+                    FaceWalls& faceWall = faceWalls[face.loop][face.edge];
+                    if (overlap > fit.overlap) {
+                        fit.overlap = overlap;
+                        faceWall.longest = wallNum;
+                    }
+                    double firstGap = std::max(0.0, std::max(from - a, a - to));
+                    double lastGap = std::max(0.0, std::max(from - b, b - to));
+                    if (firstGap < fit.firstGap) {
+                        fit.firstGap = firstGap;
+                        faceWall.first = wallNum;
+                    }
+                    if (lastGap < fit.lastGap) {
+                        fit.lastGap = lastGap;
+                        faceWall.last = wallNum;
+                    }
+                }
+            }
+
+            nodeList[wall.from].walls.push_back(wallNum);
+            nodeList[wall.to].walls.push_back(wallNum);
+            walls.push_back(wall);
+        }
+    }
+
+    for (WallNode& node : nodeList) {
+        if (node.walls.size() >= 4) {
+            node.type = WallNodeType::Cross;
+        }
+        else if (node.walls.size() == 3) {
+            node.type = WallNodeType::TJoint;
+        }
+        else if (node.walls.size() == 2) {
+            const WallEdge& a = walls[node.walls[0]];
+            const WallEdge& b = walls[node.walls[1]];
+            double cross = (a.end.x - a.start.x) * (b.end.y - b.start.y) - (a.end.y - a.start.y) * (b.end.x - b.start.x);
+            double lengths = std::hypot(a.end.x - a.start.x, a.end.y - a.start.y) * std::hypot(b.end.x - b.start.x, b.end.y - b.start.y);
+            node.type = std::fabs(cross) < 0.1 * lengths ? WallNodeType::Inline : WallNodeType::Corner;
+        }
+    }
+}
+
+
+int WallGraph::wallOf(int loop, int edge) const {
+    if (loop < 0 || loop >= static_cast<int>(faceWalls.size()) ||
+        edge < 0 || edge >= static_cast<int>(faceWalls[loop].size())) {
+        return -1;
+    }
+    return faceWalls[loop][edge].longest;
+}
+
+
+int WallGraph::jointOf(int loop, int vertex, const PlanPoint& position) const {
+    if (loop < 0 || loop >= static_cast<int>(faceWalls.size()) ||
+        vertex < 0 || vertex >= static_cast<int>(faceWalls[loop].size())) {
+        return -1;
+    }
+    int count = static_cast<int>(faceWalls[loop].size());
+    int incoming = faceWalls[loop][(vertex + count - 1) % count].last;
+    int outgoing = faceWalls[loop][vertex].first;
+    if (incoming >= 0 && outgoing >= 0 && incoming != outgoing) {
+        const WallEdge& a = walls[incoming];
+        const WallEdge& b = walls[outgoing];
+        if (a.from == b.from || a.from == b.to) {
+            return a.from;
+        }
+        if (a.to == b.from || a.to == b.to) {
+            return a.to;
+        }
+    }
+
+    // A step or a wall end: the edge without a wall across from it belongs to the joint the
+    // other wall ends in
+    int joint = -1;
+    double nearest = std::numeric_limits<double>::max();
+    for (int wall : { incoming, outgoing }) {
+        if (wall < 0) {
+            continue;
+        }
+        for (int node : { walls[wall].from, walls[wall].to }) {
+            const PlanPoint& point = nodeList[node].position;
+            double distance = std::hypot(point.x - position.x, point.y - position.y);
+            if (distance < nearest) {
+                nearest = distance;
+                joint = node;
+            }
+        }
+    }
+    return joint;
+}
@@ -0,0 +1,88 @@
+// WallGraph.h
+#pragma once
+
+#include "PlanGeometry.h"
+#include "LoopHierarchy.h"
+#include "WallThickness.h"
+#include <vector>
+
+enum class WallNodeType {
+    End = 0,        // free wall end
+    Corner = 1,     // L-joint of two walls
+    Inline = 2,     // two collinear walls of different thickness
+    TJoint = 3,
+    Cross = 4       // four or more walls
+};
+
+struct WallNode {
+    PlanPoint position;
+    WallNodeType type;
+    std::vector<int> walls;
+};
+
+// Loop edge forming one face of a wall
+struct WallFaceRef {
+    int loop;
+    int edge;
+    bool outerFace;         // face of a loop at even depth (outside of a wall ring)
+};
+
+// Centreline of one straight wall between two nodes
+struct WallEdge {
+    int from;
+    int to;
+    PlanPoint start;        // centreline at `from`
+    PlanPoint end;          // centreline at `to`
+    double thickness;
+    std::vector<WallFaceRef> leftFaces;     // faces left of start -> end
+    std::vector<WallFaceRef> rightFaces;
+};
+
+// Wall centrelines of a plan and the joints between them, built from the closed wall
+// loops. Facing loop edges (paired by WallThickness) give the centreline segments; collinear
+// segments are merged, segment ends are pulled onto the wall they run into, and walls are
+// split where another one meets them. O(n log n) in the number of loop edges; pure geometry,
+// no BRX dependencies.
+class WallGraph {
+public:
+    void build(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy);
+
+    // Same, from faces already measured by WallThickness (e.g. restored from the drawing)
+    void build(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy,
+        const std::vector<std::vector<FaceThickness>>& faces);
+
+    void clear();
+
+    bool empty() const { return walls.empty(); }
+    const std::vector<WallNode>& nodes() const { return nodeList; }
+    const std::vector<WallEdge>& edges() const { return walls; }
+
+    // Wall behind edge `edge` of `loop` (the longest piece when a joint splits it), -1 when the
+    // edge has no face across from it
+    int wallOf(int loop, int edge) const;
+
+    // Joint at corner `vertex` of `loop` (at `position`): the node where the walls behind the two
+    // edges meeting there join, else the nearest end of either wall; -1 when neither edge has a wall
+    int jointOf(int loop, int vertex, const PlanPoint& position) const;
+
+    // Thickness measured from edge `edge` of `loop`
+    const FaceThickness& face(int loop, int edge) const { return faceList[loop][edge]; }
+    const std::vector<std::vector<FaceThickness>>& faces() const { return faceList; }
+
+    // Thickness covering the most wall length, 0 when no faces pair up
+    double dominantThickness() const { return dominant; }
+
+private:
+    std::vector<WallNode> nodeList;
+    std::vector<WallEdge> walls;
+    std::vector<std::vector<FaceThickness>> faceList;
+    // Walls behind one loop edge: the longest piece, and the pieces at its first and last corner
+    // when a joint splits the wall along it
+    struct FaceWalls {
+        int longest;
+        int first;
+        int last;
+    };
+    std::vector<std::vector<FaceWalls>> faceWalls;
+    double dominant = 0.0;
+};
@@ -0,0 +1,229 @@
+#include "WallLayout.h"
+#include "PanelFillSolver.h"
+#include "StackingPlanner.h"
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <thread>
+
+
+// Fewer runs than this per worker are not worth a thread
+static const size_t minRunsPerThread = 64;
+
+
+static void unitDirection(const PlanPoint& from, const PlanPoint& to, double& dx, double& dy, double& dz) {
+    dx = to.x - from.x;
+    dy = to.y - from.y;
+    dz = to.z - from.z;
+    double length = std::sqrt(dx * dx + dy * dy + dz * dz);
+    if (length > 0) {
+        dx /= length;
+        dy /= length;
+        dz /= length;
+    }
+}
+
+
+int WallLayout::outerCornerAdjustment(double wallThickness) {
+    int adjustment = 150;
+    if (wallThickness == 150 || wallThickness == 200) {
+        adjustment = 550;
+    }
+    else if (wallThickness >= 250 && wallThickness <= 2100 && std::fmod(wallThickness, 50.0) == 0) {
+        adjustment = static_cast<int>(wallThickness) + 350;
+    }
+    return adjustment - 100;
+}
+
+
+int WallLayout::innerCornerAdjustment(double wallThickness) {
+    return wallThickness == 150 ? 300 : 250;
+}
+
+
+void WallLayout::build(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy,
+    const WallLayoutSettings& settings, CornerRegistry& processedCorners, LayoutPlan& plan) {
+
+    std::vector<PlanPoint> corners;
+    std::vector<int> cornerLoop;
+    std::vector<size_t> loopStart;
+    for (size_t i = 0; i < loops.size(); ++i) {
+        loopStart.push_back(corners.size());
+        corners.insert(corners.end(), loops[i].begin(), loops[i].end());
+        cornerLoop.insert(cornerLoop.end(), loops[i].size(), static_cast<int>(i));
+    }
+    if (corners.empty()) {
+        return;
+    }
+
+    // Corner skipping depends on the order corners are registered, so the runs are
+    // extracted serially; only the panel fill below runs in parallel
+    std::vector<LayoutRun> runs;
+    runs.reserve(corners.size());
+    double longestRun = 0.0;
+
+    // Corners of all loops are walked as one list; the last corner of a loop closes back
+    // to its first one
+    for (size_t cornerNum = 0; cornerNum < corners.size(); ++cornerNum) {
+
+        int loopIndex = cornerLoop[cornerNum];
+        size_t edgeNum = cornerNum - loopStart[loopIndex];
+        const PlanPoint& current = corners[cornerNum];
+        PlanPoint start = current;
+        PlanPoint end = edgeNum + 1 < loops[loopIndex].size() ? corners[cornerNum + 1] : corners[loopStart[loopIndex]];
+
+        if (processedCorners.isNear(current)) {
+            continue;
+        }
+
+        bool isOuter = hierarchy.isOuter(loopIndex) == hierarchy.isClockwise(loopIndex);
+
+        double dx, dy, dz;
+        unitDirection(start, end, dx, dy, dz);
+        double rotation = std::atan2(dy, dx);
+
+        double thickness = settings.wallThickness;
+        if (static_cast<size_t>(loopIndex) < settings.edgeThickness.size() &&
+            edgeNum < settings.edgeThickness[loopIndex].size() && settings.edgeThickness[loopIndex][edgeNum] > 0) {
+            thickness = settings.edgeThickness[loopIndex][edgeNum];
+        }
+
+        int adjustment = hierarchy.isOuter(loopIndex)
+            ? outerCornerAdjustment(thickness)
+            : innerCornerAdjustment(thickness);
+        start.x += dx * adjustment;
+        start.y += dy * adjustment;
+        start.z += dz * adjustment;
+        end.x -= dx * adjustment;
+        end.y -= dy * adjustment;
+        end.z -= dz * adjustment;
+
+        processedCorners.add(current);
+
+        double distance = std::sqrt((end.x - start.x) * (end.x - start.x) +
+            (end.y - start.y) * (end.y - start.y) + (end.z - start.z) * (end.z - start.z));
+
+        rotation += 3.141592653589793238462643383279;
+        snapToRightAngle(rotation, settings.angleTolerance);
+
+        runs.push_back({ start, dx, dy, dz, rotation, distance, thickness, loopIndex, static_cast<int>(edgeNum), isOuter, !hierarchy.isOuter(loopIndex), 0, 0 });
+        longestRun = std::max(longestRun, distance);
+    }
+
+    // Grow the shared fill table and plan the stacks up front, so the workers only read them
+    std::vector<int> fillWidths;
+    for (const auto& row : settings.baseRows) {
+        fillWidths.push_back(row.width);
+    }
+    PanelFillSolver& panelFill = PanelFillSolver::shared(fillWidths);
+    panelFill.reserve(longestRun);
+
+    std::vector<const StackRecipe*> rowStacks;
+    for (const auto& row : settings.baseRows) {
+        auto stackIt = settings.stackHeights.find(row.width);
+        rowStacks.push_back(&StackingPlanner::recipe(settings.wallHeight, row.height,
+            stackIt != settings.stackHeights.end() ? stackIt->second : std::vector<int>()));
+    }
+
+    // Every run gets a fixed slice of the plan, so the output order matches the serial walk
+    size_t itemCount = plan.items.size();
+    for (auto& run : runs) {
+        run.firstItem = itemCount;
+        const PanelFillSolver::Mix& panelMix = panelFill.solve(run.distance);
+        for (size_t rowNum = 0; rowNum < settings.baseRows.size(); ++rowNum) {
+            run.itemCount += panelMix.counts[rowNum] * (1 + rowStacks[rowNum]->stack.size());
+        }
+        itemCount += run.itemCount;
+    }
+    plan.items.resize(itemCount);
+    size_t firstRun = plan.runs.size();
+    plan.runs.insert(plan.runs.end(), runs.begin(), runs.end());
+
+    auto fillRuns = [&](size_t first, size_t last) {
+        std::vector<int> order;
+        for (size_t runNum = first; runNum < last; ++runNum) {
+            const LayoutRun& run = plan.runs[firstRun + runNum];
+            LayoutItem* item = &plan.items[run.firstItem];
+            PlanPoint currentPoint = run.start;
+            panelFill.arrange(panelFill.solve(run.distance), order);
+            for (int rowNum : order) {
+                const LayoutBaseRow& row = settings.baseRows[rowNum];
+                const StackRecipe& stack = *rowStacks[rowNum];
+
+                currentPoint.x += run.dx * row.width;
+                currentPoint.y += run.dy * row.width;
+                currentPoint.z += run.dz * row.width;
+
+                PlanPoint position = currentPoint;
+                position.z += row.elevation;
+                *item++ = { LayoutComponent::WallPanel, row.width, row.height, position, run.rotation, run.loop, run.isOuterLoop };
+
+                position.z += row.height;
+                for (int height : stack.stack) {
+                    *item++ = { LayoutComponent::StackedPanel, row.width, height, position, run.rotation, run.loop, run.isOuterLoop };
+                    position.z += height;
+                }
+            }
+        }
+    };
+
+    unsigned threads = settings.threads > 0 ? settings.threads : std::thread::hardware_concurrency();
+    threads = static_cast<unsigned>(std::min<size_t>(std::max(threads, 1u), runs.size() / minRunsPerThread + 1));
+    if (threads <= 1) {
+        fillRuns(0, runs.size());
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    size_t chunk = (runs.size() + threads - 1) / threads;
+    for (unsigned t = 1; t < threads; ++t) {
+        size_t first = std::min(runs.size(), t * chunk);
+        size_t last = std::min(runs.size(), first + chunk);
+        workers.emplace_back(fillRuns, first, last);
+    }
+    fillRuns(0, std::min(runs.size(), chunk));
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+
+void LayoutPlan::write(std::ostream& out) const {
+    std::streamsize precision = out.precision(17);
+    out << "PERI-LAYOUT 1 " << items.size() << "\n";
+    for (const auto& item : items) {
+        out << static_cast<int>(item.type) << ' ' << item.width << ' ' << item.height << ' '
+            << item.position.x << ' ' << item.position.y << ' ' << item.position.z << ' '
+            << item.rotation << ' ' << item.loop << ' ' << (item.isOuterLoop ? 1 : 0) << "\n";
+    }
+    out.precision(precision);
+}
+
+
+bool LayoutPlan::read(std::istream& in) {
+    std::string tag;
+    int version = 0;
+    size_t count = 0;
+    if (!(in >> tag >> version >> count) || tag != "PERI-LAYOUT" || version != 1) {
+        return false;
+    }
+
+    std::vector<LayoutItem> loaded;
+    loaded.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        LayoutItem item;
+        int type = 0;
+        int outer = 0;
+        if (!(in >> type >> item.width >> item.height >> item.position.x >> item.position.y >> item.position.z
+            >> item.rotation >> item.loop >> outer)) {
+            return false;
+        }
+        item.type = static_cast<LayoutComponent>(type);
+        item.isOuterLoop = outer != 0;
+        loaded.push_back(item);
+    }
+    items.swap(loaded);
+    return true;
+}
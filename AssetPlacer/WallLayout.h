@@ -0,0 +1,87 @@
+// WallLayout.h
+#pragma once
+
+#include "PlanGeometry.h"
+#include "LoopHierarchy.h"
+#include "CornerRegistry.h"
+#include <vector>
+#include <map>
+#include <iosfwd>
+
+enum class LayoutComponent {
+    WallPanel = 0,      // base row panel standing on the slab
+    StackedPanel = 1    // panel stacked on top of a base row panel
+};
+
+// One component of the layout. Panels are identified by width and height (mm);
+// the commit phase maps them to block definitions.
+struct LayoutItem {
+    LayoutComponent type;
+    int width;
+    int height;
+    PlanPoint position;
+    double rotation;
+    int loop;               // index of the wall loop the component belongs to
+    bool isOuterLoop;
+};
+
+// One straight wall run between two corners and the components laid along it
+struct LayoutRun {
+    PlanPoint start;        // after the corner adjustment
+    double dx, dy, dz;      // unit direction of the run
+    double rotation;        // rotation of the panels on the run
+    double distance;        // length available for panels
+    double thickness;       // wall thickness behind the run
+    int loop;
+    int edge;               // loop edge the run follows (corner edge to edge + 1), the key into WallGraph::wallOf
+    bool isOuterLoop;
+    bool insideFace;        // run on a loop nested in another one (odd depth), e.g. the inner face of a wall ring
+    size_t firstItem;       // the run's components are items [firstItem, firstItem + itemCount)
+    size_t itemCount;
+};
+
+// Flat result of the layout phase, ready to be written to model space in one batch
+struct LayoutPlan {
+    std::vector<LayoutItem> items;
+    std::vector<LayoutRun> runs;
+
+    void clear() { items.clear(); runs.clear(); }
+
+    // Plain text, one component per line. Runs are not written; read() leaves them empty.
+    void write(std::ostream& out) const;
+    bool read(std::istream& in);
+};
+
+// Base row panel for one catalogue width
+struct LayoutBaseRow {
+    int width;
+    int height;
+    int elevation;
+};
+
+struct WallLayoutSettings {
+    double wallThickness = 0.0;
+    std::vector<std::vector<double>> edgeThickness; // per loop and edge (corner i to i + 1); missing or 0 = wallThickness
+    int wallHeight = 0;
+    std::vector<LayoutBaseRow> baseRows;            // widest first
+    std::map<int, std::vector<int>> stackHeights;   // width -> heights available for stacking, tallest first
+    double angleTolerance = 0.1;
+    unsigned threads = 0;                           // panel fill workers, 0 = one per hardware thread
+};
+
+// Layout phase of PlaceWalls: runs panels along every wall loop and stacks them to the wall
+// height. Pure geometry, no BRX dependencies.
+class WallLayout {
+public:
+    // Appends the components for `loops` to `plan`. Corners near one already in
+    // `processedCorners` are skipped, and every corner laid out is added to it.
+    // Runs are filled on `settings.threads` workers; the plan is the same for any thread count.
+    static void build(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy,
+        const WallLayoutSettings& settings, CornerRegistry& processedCorners, LayoutPlan& plan);
+
+    // Distance a wall run on the outer face starts away from its corner
+    static int outerCornerAdjustment(double wallThickness);
+
+    // Distance a wall run on the inner face starts away from its corner
+    static int innerCornerAdjustment(double wallThickness);
+};
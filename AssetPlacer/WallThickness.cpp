@@ -0,0 +1,203 @@
+#include "WallThickness.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+static const double pi = 3.141592653589793238462643383279;
+
+static const double minThickness = 150.0;
+static const double maxThickness = 2100.0;
+static const double thicknessStep = 50.0;
+
+// Edges are grouped by orientation in steps of a twentieth of a degree, so that axis aligned
+// edges land exactly on a group direction
+static const long long orientationCount = 3600;
+static const double orientationStep = pi / orientationCount;
+
+// Faces must overlap by more than this along the wall to be paired
+static const double overlapTolerance = 1.0;
+
+
+namespace {
+
+struct FaceEdge {
+    double offset;          // signed distance of the edge line from the origin along the group normal
+    double x, y;            // start of the edge
+    double nx, ny;          // unit normal of the edge itself
+    double from, to;        // extent along the group direction, from <= to
+    bool wallPositive;      // the wall lies on the side of increasing offset
+    int loop;
+    int edge;
+};
+
+}
+
+
+void WallThickness::measure(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy,
+    std::vector<std::vector<FaceThickness>>& faces) {
+
+    std::vector<char> stale(loops.size(), 1);
+    faces.clear();
+    measure(loops, hierarchy, faces, stale);
+}
+
+
+void WallThickness::measure(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy,
+    std::vector<std::vector<FaceThickness>>& faces, std::vector<char>& stale) {
+
+    const double reach = maxThickness + thicknessStep / 2;
+    faces.resize(loops.size());
+    stale.resize(loops.size(), 1);
+
+    std::vector<int> staleLoops;
+    for (size_t loopNum = 0; loopNum < loops.size(); ++loopNum) {
+        if (stale[loopNum] || faces[loopNum].size() != loops[loopNum].size()) {
+            stale[loopNum] = 1;
+            staleLoops.push_back(static_cast<int>(loopNum));
+        }
+    }
+
+    // A kept loop is measured again when a face it paired with is stale, or when a stale
+    // loop is close enough to become a nearer face
+    std::vector<char> affected(stale);
+    for (size_t loopNum = 0; loopNum < loops.size(); ++loopNum) {
+        if (affected[loopNum]) {
+            continue;
+        }
+        for (const FaceThickness& face : faces[loopNum]) {
+            if (face.oppositeLoop >= 0 && (face.oppositeLoop >= static_cast<int>(loops.size()) || stale[face.oppositeLoop])) {
+                affected[loopNum] = 1;
+                break;
+            }
+        }
+        const LoopNode& node = hierarchy.node(loopNum);
+        for (size_t staleNum = 0; staleNum < staleLoops.size() && !affected[loopNum]; ++staleNum) {
+            const LoopNode& other = hierarchy.node(staleLoops[staleNum]);
+            if (node.minX - reach <= other.maxX && other.minX <= node.maxX + reach &&
+                node.minY - reach <= other.maxY && other.minY <= node.maxY + reach) {
+                affected[loopNum] = 1;
+            }
+        }
+    }
+    stale = affected;
+
+    std::map<long long, std::vector<FaceEdge>> groups;
+    for (size_t loopNum = 0; loopNum < loops.size(); ++loopNum) {
+        const PlanLoop& loop = loops[loopNum];
+        if (stale[loopNum]) {
+            faces[loopNum].assign(loop.size(), { 0.0, 0.0, -1, -1 });
+        }
+
+        // Outer faces have the wall inside the loop, inner faces outside it
+        bool wallLeft = hierarchy.isOuter(loopNum) != hierarchy.isClockwise(loopNum);
+
+        for (size_t edgeNum = 0; edgeNum < loop.size(); ++edgeNum) {
+            const PlanPoint& p1 = loop[edgeNum];
+            const PlanPoint& p2 = loop[(edgeNum + 1) % loop.size()];
+            double dx = p2.x - p1.x;
+            double dy = p2.y - p1.y;
+            if (dx == 0.0 && dy == 0.0) {
+                continue;
+            }
+
+            long long key = std::llround(std::atan2(dy, dx) / orientationStep);
+            key = ((key % orientationCount) + orientationCount) % orientationCount;
+            double angle = key * orientationStep;
+            double ux = std::cos(angle);
+            double uy = std::sin(angle);
+
+            double along1 = ux * p1.x + uy * p1.y;
+            double along2 = ux * p2.x + uy * p2.y;
+            bool leftIsPositive = (-dy * -uy + dx * ux) > 0.0;
+
+            FaceEdge face;
+            double length = std::hypot(dx, dy);
+            face.offset = -uy * p1.x + ux * p1.y;
+            face.x = p1.x;
+            face.y = p1.y;
+            face.nx = -dy / length;
+            face.ny = dx / length;
+            face.from = std::min(along1, along2);
+            face.to = std::max(along1, along2);
+            face.wallPositive = wallLeft == leftIsPositive;
+            face.loop = static_cast<int>(loopNum);
+            face.edge = static_cast<int>(edgeNum);
+            groups[key].push_back(face);
+        }
+    }
+
+    // Offsets are along the group normal; the gap itself is measured square to each edge
+    for (auto& group : groups) {
+        std::vector<FaceEdge>& edges = group.second;
+        std::sort(edges.begin(), edges.end(), [](const FaceEdge& a, const FaceEdge& b) {
+            return a.offset < b.offset;
+        });
+
+        for (size_t edgeNum = 0; edgeNum < edges.size(); ++edgeNum) {
+            const FaceEdge& face = edges[edgeNum];
+            if (!stale[face.loop]) {
+                continue;
+            }
+            int step = face.wallPositive ? 1 : -1;
+
+            // Walk away from the edge on its wall side; the first match is the nearest face
+            for (long long other = static_cast<long long>(edgeNum) + step;
+                other >= 0 && other < static_cast<long long>(edges.size()); other += step) {
+                const FaceEdge& candidate = edges[other];
+                if (std::fabs(candidate.offset - face.offset) > reach + thicknessStep) {
+                    break;
+                }
+                double gap = std::fabs(face.nx * (candidate.x - face.x) + face.ny * (candidate.y - face.y));
+                if (candidate.wallPositive == face.wallPositive || gap < overlapTolerance) {
+                    continue;
+                }
+                if (std::min(face.to, candidate.to) - std::max(face.from, candidate.from) <= overlapTolerance) {
+                    continue;
+                }
+
+                FaceThickness& result = faces[face.loop][face.edge];
+                result.measured = gap;
+                result.thickness = snap(gap);
+                result.oppositeLoop = candidate.loop;
+                result.oppositeEdge = candidate.edge;
+                break;
+            }
+        }
+    }
+}
+
+
+double WallThickness::snap(double distance) {
+    if (distance < minThickness - thicknessStep / 2 || distance > maxThickness + thicknessStep / 2) {
+        return 0.0;
+    }
+    double snapped = std::round(distance / thicknessStep) * thicknessStep;
+    return std::min(std::max(snapped, minThickness), maxThickness);
+}
+
+
+double WallThickness::dominant(const std::vector<PlanLoop>& loops, const std::vector<std::vector<FaceThickness>>& faces) {
+    std::map<double, double> lengthByThickness;
+    for (size_t loopNum = 0; loopNum < loops.size() && loopNum < faces.size(); ++loopNum) {
+        const PlanLoop& loop = loops[loopNum];
+        for (size_t edgeNum = 0; edgeNum < loop.size() && edgeNum < faces[loopNum].size(); ++edgeNum) {
+            double thickness = faces[loopNum][edgeNum].thickness;
+            if (thickness <= 0.0) {
+                continue;
+            }
+            const PlanPoint& p1 = loop[edgeNum];
+            const PlanPoint& p2 = loop[(edgeNum + 1) % loop.size()];
+            lengthByThickness[thickness] += std::hypot(p2.x - p1.x, p2.y - p1.y);
+        }
+    }
+
+    double best = 0.0;
+    double bestLength = 0.0;
+    for (const auto& entry : lengthByThickness) {
+        if (entry.second > bestLength) {
+            best = entry.first;
+            bestLength = entry.second;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,37 @@
+// WallThickness.h
+#pragma once
+
+#include "PlanGeometry.h"
+#include "LoopHierarchy.h"
+#include <vector>
+
+// Thickness of the wall behind one loop edge, measured to the facing edge across the wall
+struct FaceThickness {
+    double measured;        // distance to the opposite face, 0 when none was found
+    double thickness;       // measured distance snapped to the catalogue, 0 when none was found
+    int oppositeLoop;       // -1 when none was found
+    int oppositeEdge;
+};
+
+// Wall thickness from the drawn wall faces alone. Edges are grouped by orientation and sorted by
+// their offset from the origin; each edge then sweeps away from itself on the wall side for the
+// nearest parallel edge that overlaps it and faces back. O(n log n) for n edges; pure geometry,
+// no BRX dependencies.
+class WallThickness {
+public:
+    // `faces[loop][edge]` for the edge from corner `edge` to the next corner of `loop`
+    static void measure(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy,
+        std::vector<std::vector<FaceThickness>>& faces);
+
+    // Measures again only the loops flagged in `stale` and the loops whose faces they can
+    // change (faces paired with a stale loop, or within reach of one); the other entries of
+    // `faces` are kept. On return `stale` flags every loop that was measured.
+    static void measure(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy,
+        std::vector<std::vector<FaceThickness>>& faces, std::vector<char>& stale);
+
+    // Nearest catalogue thickness (150 to 2100 in 50 steps), 0 when `distance` is off the table
+    static double snap(double distance);
+
+    // Thickness covering the most wall length, 0 when no edge was paired
+    static double dominant(const std::vector<PlanLoop>& loops, const std::vector<std::vector<FaceThickness>>& faces);
+};
@@ -0,0 +1,175 @@
+#include "StdAfx.h"
+#include "AssetRegistry.h"
+#include "dbapserv.h"
+#include "dbmain.h"
+#include "acutads.h"
+#include "Profiler.h"
+
+std::map<const AcDbDatabase*, AssetRegistry::DatabaseCache> AssetRegistry::caches;
+AssetRegistry::Counters AssetRegistry::commandCounters = { 0, 0, 0 };
+int AssetRegistry::definitionScopes = 0;
+
+
+class AssetRegistryReactor : public AcDbDatabaseReactor {
+public:
+    void objectAppended(const AcDbDatabase* pDb, const AcDbObject* pObj) override {
+        checkObject(pDb, pObj);
+    }
+
+    void objectModified(const AcDbDatabase* pDb, const AcDbObject* pObj) override {
+        checkObject(pDb, pObj);
+    }
+
+    void objectErased(const AcDbDatabase* pDb, const AcDbObject* pObj, Adesk::Boolean erased) override {
+        checkObject(pDb, pObj);
+    }
+
+    void goodbye(const AcDbDatabase* pDb) override {
+        AssetRegistry::forget(pDb);
+    }
+
+private:
+    
+    void checkObject(const AcDbDatabase* pDb, const AcDbObject* pObj) {
+        AcDbBlockTableRecord* pRecord = AcDbBlockTableRecord::cast(pObj);
+        if (pRecord && !pRecord->isLayout()) {
+            AssetRegistry::blockChanged(pDb, pRecord);
+        }
+    }
+};
+
+
+AssetRegistry::CommandScope::CommandScope(const ACHAR* commandName)
+    : commandName(commandName) {
+    AssetRegistry::resetCounters();
+}
+
+
+AssetRegistry::CommandScope::~CommandScope() {
+    AssetRegistry::reportCounters(commandName);
+}
+
+
+AssetRegistry::DefinitionScope::DefinitionScope() {
+    AssetRegistry::definitionScopes++;
+}
+
+
+AssetRegistry::DefinitionScope::~DefinitionScope() {
+    AssetRegistry::definitionScopes--;
+}
+
+
+AcDbObjectId AssetRegistry::resolve(const wchar_t* blockName) {
+    return resolve(acdbHostApplicationServices()->workingDatabase(), blockName);
+}
+
+
+AcDbObjectId AssetRegistry::resolve(AcDbDatabase* pDb, const wchar_t* blockName) {
+    if (!pDb || !blockName || wcslen(blockName) == 0) {
+        return AcDbObjectId::kNull;
+    }
+
+    auto cacheIt = caches.find(pDb);
+    if (cacheIt == caches.end()) {
+        DatabaseCache cache;
+        cache.reactor = new AssetRegistryReactor();
+        pDb->addReactor(cache.reactor);
+        cacheIt = caches.emplace(pDb, cache).first;
+    }
+
+    std::unordered_map<std::wstring, AcDbObjectId>& ids = cacheIt->second.ids;
+    auto idIt = ids.find(blockName);
+    if (idIt != ids.end() && (idIt->second.isNull() || !idIt->second.isErased())) {
+        commandCounters.hits++;
+        return idIt->second;
+    }
+
+    commandCounters.misses++;
+    commandCounters.blockTableOpens++;
+
+    AcDbBlockTable* pBlockTable;
+    Profiler::count(ProfileCounter::BlockTableOpens);
+    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
+        return AcDbObjectId::kNull;
+    }
+
+    AcDbObjectId blockId;
+    if (pBlockTable->getAt(blockName, blockId) != Acad::eOk) {
+        blockId = AcDbObjectId::kNull;
+    }
+    pBlockTable->close();
+
+    
+    ids[blockName] = blockId;
+    return blockId;
+}
+
+
+void AssetRegistry::invalidate(const AcDbDatabase* pDb) {
+    auto cacheIt = caches.find(pDb);
+    if (cacheIt != caches.end()) {
+        cacheIt->second.ids.clear();
+    }
+}
+
+
+void AssetRegistry::blockChanged(const AcDbDatabase* pDb, const AcDbBlockTableRecord* pRecord) {
+    auto cacheIt = caches.find(pDb);
+    if (cacheIt == caches.end()) {
+        return;
+    }
+
+    // The plugin's own definitions only change while they are filled, and an erased one
+    // fails the isErased check in resolve
+    DatabaseCache& cache = cacheIt->second;
+    AcDbObjectId recordId = pRecord->objectId();
+    if (cache.created.count(recordId)) {
+        return;
+    }
+    if (definitionScopes > 0) {
+        cache.created.insert(recordId);
+        const ACHAR* blockName = nullptr;
+        if (pRecord->getName(blockName) == Acad::eOk && blockName) {
+            cache.ids[blockName] = recordId;
+        }
+        return;
+    }
+    cache.ids.clear();
+}
+
+
+void AssetRegistry::forget(const AcDbDatabase* pDb) {
+    auto cacheIt = caches.find(pDb);
+    if (cacheIt == caches.end()) {
+        return;
+    }
+
+    // Called from the reactor's goodbye: take it off the database before it is deleted
+    AssetRegistryReactor* pReactor = cacheIt->second.reactor;
+    caches.erase(cacheIt);
+    const_cast<AcDbDatabase*>(pDb)->removeReactor(pReactor);
+    delete pReactor;
+}
+
+
+void AssetRegistry::shutdown() {
+    for (auto& cache : caches) {
+        const_cast<AcDbDatabase*>(cache.first)->removeReactor(cache.second.reactor);
+        delete cache.second.reactor;
+    }
+    caches.clear();
+}
+
+
+void AssetRegistry::resetCounters() {
+    commandCounters.hits = 0;
+    commandCounters.misses = 0;
+    commandCounters.blockTableOpens = 0;
+}
+
+
+void AssetRegistry::reportCounters(const ACHAR* commandName) {
+    acutPrintf(_T("\n%s asset lookups: %lu hits, %lu misses, %lu block table opens."),
+        commandName, commandCounters.hits, commandCounters.misses, commandCounters.blockTableOpens);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include "dbsymtb.h"
+
+class AssetRegistryReactor;
+
+// Resolves block names to AcDbObjectIds once per database and shares the result
+// between all placers. Entries are dropped when a block definition is added,
+// renamed or erased, and the whole cache for a database goes with the database.
+// Definitions the plugin builds itself (tie assemblies, panel stacks) are created
+// under a DefinitionScope: they are added to the cache and never clear it.
+class AssetRegistry {
+public:
+    struct Counters {
+        unsigned long hits;
+        unsigned long misses;
+        unsigned long blockTableOpens;
+    };
+
+    // Resets the counters on construction and prints them on destruction
+    class CommandScope {
+    public:
+        explicit CommandScope(const ACHAR* commandName);
+        ~CommandScope();
+
+    private:
+        const ACHAR* commandName;
+    };
+
+    // Open while the plugin creates a block definition and fills it
+    class DefinitionScope {
+    public:
+        DefinitionScope();
+        ~DefinitionScope();
+    };
+
+    static AcDbObjectId resolve(const wchar_t* blockName);
+    static AcDbObjectId resolve(AcDbDatabase* pDb, const wchar_t* blockName);
+
+    static void invalidate(const AcDbDatabase* pDb);
+    static void shutdown();
+
+    static const Counters& counters() { return commandCounters; }
+    static void resetCounters();
+    static void reportCounters(const ACHAR* commandName);
+
+private:
+    struct DatabaseCache {
+        std::unordered_map<std::wstring, AcDbObjectId> ids;
+        std::set<AcDbObjectId> created;     // definitions made under a DefinitionScope
+        AssetRegistryReactor* reactor;
+    };
+
+    friend class AssetRegistryReactor;
+    static void blockChanged(const AcDbDatabase* pDb, const AcDbBlockTableRecord* pRecord);
+    static void forget(const AcDbDatabase* pDb);
+
+    static int definitionScopes;
+    static std::map<const AcDbDatabase*, DatabaseCache> caches;
+    static Counters commandCounters;
+};
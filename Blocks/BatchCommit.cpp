@@ -0,0 +1,64 @@
+#include "BatchCommit.h"
+
+CommandRollback* CommandRollback::current = nullptr;
+
+
+CommandRollback::CommandRollback(TransactionPort& port)
+    : port(port), ownsTransaction(false), failed(false) {
+    if (current || !port.start()) {
+        return;
+    }
+    ownsTransaction = true;
+    current = this;
+}
+
+
+CommandRollback::~CommandRollback() {
+    finish();
+}
+
+
+bool CommandRollback::finish() {
+    if (!ownsTransaction) {
+        return true;
+    }
+    ownsTransaction = false;
+    current = nullptr;
+
+    if (failed) {
+        port.abort();
+        return false;
+    }
+    port.end();
+    return true;
+}
+
+
+void CommandRollback::fail() {
+    if (current) {
+        current->failed = true;
+    }
+}
+
+
+bool BatchCommit::commit(TransactionPort& port, BatchEntities& entities, size_t count) {
+    bool started = port.start();
+    size_t appended = 0;
+    while (started && appended < count && entities.append(appended)) {
+        appended++;
+    }
+    if (started && appended == count) {
+        port.end();
+        return true;
+    }
+
+    // Entities already appended belong to the transaction and go with the abort
+    for (size_t i = appended; i < count; ++i) {
+        entities.discard(i);
+    }
+    if (started) {
+        port.abort();
+    }
+    CommandRollback::fail();
+    return false;
+}
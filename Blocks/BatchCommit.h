@@ -0,0 +1,64 @@
+// BatchCommit.h
+#pragma once
+
+#include <cstddef>
+
+// Transaction manager calls made by the commit layer. The plugin implements them over
+// actrTransactionManager; Tests/ uses a recording mock.
+class TransactionPort {
+public:
+    virtual ~TransactionPort() {}
+
+    // Starts a transaction, nested in the running one if any; false when none was started
+    virtual bool start() = 0;
+    virtual void end() = 0;
+    virtual void abort() = 0;
+};
+
+// Entities of one batch, all built before the batch transaction starts
+class BatchEntities {
+public:
+    virtual ~BatchEntities() {}
+
+    // Appends entity `index` to model space inside the running transaction
+    virtual bool append(size_t index) = 0;
+
+    // Frees entity `index`, which was built but never appended
+    virtual void discard(size_t index) = 0;
+};
+
+// Outer transaction of one command. A command started inside another joins the outer one.
+// When fail() was called while it was open, finish() aborts it and every batch committed in
+// it goes too.
+class CommandRollback {
+public:
+    explicit CommandRollback(TransactionPort& port);
+    ~CommandRollback();
+
+    // False when this command joined an outer one or the transaction could not start
+    bool started() const { return ownsTransaction; }
+
+    // Ends or aborts the transaction; false when it was aborted. Later calls do nothing.
+    bool finish();
+
+    static bool active() { return current != nullptr; }
+
+    // Marks the running command for rollback. Does nothing outside a command.
+    static void fail();
+
+private:
+    TransactionPort& port;
+    bool ownsTransaction;
+    bool failed;
+
+    static CommandRollback* current;
+};
+
+// Commit and rollback rules of BlockBatch. No BRX dependencies.
+class BatchCommit {
+public:
+    // Appends entities [0, count) in one transaction. On the first failed append the entities
+    // not appended are discarded, the transaction is aborted (taking the appended ones with it)
+    // and the running command is marked failed. False when the batch was rolled back.
+    static bool commit(TransactionPort& port, BatchEntities& entities, size_t count);
+};
@@ -0,0 +1,151 @@
+#include "StdAfx.h"
+#include "BlockBatch.h"
+#include "DefineScale.h"
+#include "AssetPlacer/TransformComposer.h"
+#include "dbapserv.h"
+#include "dbents.h"
+#include "dbsymtb.h"
+#include "acutads.h"
+#include "actrans.h"
+#include "CommandTransaction.h"
+#include <chrono>
+#include "Profiler.h"
+
+
+// Built references of one batch, appended to model space inside the batch transaction.
+// Model space is opened on the first append.
+class ModelSpaceEntities : public BatchEntities {
+public:
+    ModelSpaceEntities(AcDbObjectId modelSpaceId, std::vector<AcDbBlockReference*>& blockRefs,
+        std::vector<AcDbObjectId>* placedIds)
+        : modelSpaceId(modelSpaceId), blockRefs(blockRefs), placedIds(placedIds), pModelSpace(nullptr) {
+    }
+
+    bool append(size_t index) override {
+        if (!pModelSpace) {
+            AcDbObject* pObject = nullptr;
+            Profiler::count(ProfileCounter::ObjectsOpened);
+            if (actrTransactionManager->getObject(pObject, modelSpaceId, AcDb::kForWrite) != Acad::eOk) {
+                return false;
+            }
+            pModelSpace = AcDbBlockTableRecord::cast(pObject);
+            if (!pModelSpace) {
+                return false;
+            }
+        }
+        if (pModelSpace->appendAcDbEntity(blockRefs[index]) != Acad::eOk) {
+            return false;
+        }
+        actrTransactionManager->addNewlyCreatedDBRObject(blockRefs[index]);
+        if (placedIds) {
+            placedIds->push_back(blockRefs[index]->objectId());
+        }
+        return true;
+    }
+
+    void discard(size_t index) override {
+        delete blockRefs[index];
+    }
+
+private:
+    AcDbObjectId modelSpaceId;
+    std::vector<AcDbBlockReference*>& blockRefs;
+    std::vector<AcDbObjectId>* placedIds;
+    AcDbBlockTableRecord* pModelSpace;
+};
+
+
+BlockBatch::BlockBatch(const ACHAR* label)
+    : label(label) {
+}
+
+
+void BlockBatch::add(AcDbObjectId assetId, const AcGePoint3d& position, double rotation) {
+    placements.push_back({ assetId, position, rotation, 0.0, 0.0, 0.0, globalVarScale });
+}
+
+
+void BlockBatch::add(AcDbObjectId assetId, const AcGePoint3d& position, double rotationX, double rotationY, double rotationZ) {
+    placements.push_back({ assetId, position, 0.0, rotationX, rotationY, rotationZ, globalVarScale });
+}
+
+
+void BlockBatch::add(AcDbObjectId assetId, const AcGePoint3d& position, double rotation, const AcGeScale3d& scale) {
+    placements.push_back({ assetId, position, rotation, 0.0, 0.0, 0.0, scale });
+}
+
+
+int BlockBatch::commit(std::vector<AcDbObjectId>* placedIds) {
+    Profiler::Phase phase("block_commit");
+    if (placedIds) {
+        placedIds->clear();
+    }
+    if (placements.empty()) {
+        return 0;
+    }
+    auto startTime = std::chrono::steady_clock::now();
+
+    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
+    if (!pDb) {
+        acutPrintf(_T("\nNo working database found."));
+        return 0;
+    }
+
+    AcDbBlockTable* pBlockTable;
+    Profiler::count(ProfileCounter::BlockTableOpens);
+    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to get block table."));
+        return 0;
+    }
+
+    AcDbObjectId modelSpaceId;
+    if (pBlockTable->getAt(ACDB_MODEL_SPACE, modelSpaceId) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to get model space."));
+        pBlockTable->close();
+        return 0;
+    }
+    pBlockTable->close();
+
+    // Build every reference before model space is opened, then append them in one pass.
+    // Axis rotations go in as one composed transform per reference.
+    TransformComposer composer;
+    AcGeMatrix3d blockTransform;
+    std::vector<AcDbBlockReference*> blockRefs;
+    blockRefs.reserve(placements.size());
+    for (const auto& placement : placements) {
+        AcDbBlockReference* pBlockRef = new AcDbBlockReference();
+        pBlockRef->setBlockTableRecord(placement.assetId);
+
+        if (placement.rotationX != 0.0 || placement.rotationY != 0.0 || placement.rotationZ != 0.0) {
+            const LinearTransform& linear = composer.compose(placement.rotation,
+                placement.rotationX, placement.rotationY, placement.rotationZ, placement.scale.sx);
+            TransformComposer::write(linear, placement.position.x, placement.position.y, placement.position.z, blockTransform);
+            pBlockRef->setBlockTransform(blockTransform);
+        }
+        else {
+            pBlockRef->setPosition(placement.position);
+            pBlockRef->setRotation(placement.rotation);
+            pBlockRef->setScaleFactors(placement.scale);
+        }
+        blockRefs.push_back(pBlockRef);
+    }
+
+    // Appended through the commit layer, which aborts the batch and marks the command failed
+    // when an append fails
+    ModelSpaceEntities entities(modelSpaceId, blockRefs, placedIds);
+    if (!BatchCommit::commit(CommandTransaction::port(), entities, blockRefs.size())) {
+        if (placedIds) {
+            placedIds->clear();
+        }
+        acutPrintf(_T("\nFailed to place %s blocks; the batch of %d was rolled back."), label, static_cast<int>(placements.size()));
+        placements.clear();
+        return 0;
+    }
+    int placed = static_cast<int>(blockRefs.size());
+
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    acutPrintf(_T("\nPlaced %d of %d %s blocks in %.1f ms."), placed, static_cast<int>(placements.size()), label, elapsed);
+
+    placements.clear();
+    return placed;
+}
@@ -0,0 +1,48 @@
+// BlockBatch.h
+#pragma once
+
+#include <vector>
+#include "dbid.h"
+#include "gepnt3d.h"
+#include "gescl3d.h"
+
+// One block reference waiting to be appended to model space
+struct BlockPlacement {
+    AcDbObjectId assetId;
+    AcGePoint3d position;
+    double rotation;        // in-plane rotation (setRotation)
+    double rotationX;       // rotations about the insertion point, applied X, then Y, then Z
+    double rotationY;
+    double rotationZ;
+    AcGeScale3d scale;      // the drawing scale unless the block brings its own
+};
+
+// Collects block references and appends them all in one transaction on model space,
+// instead of opening the block table and model space once per block.
+class BlockBatch {
+public:
+    // `label` names the batch in messages, e.g. _T("wall connector")
+    explicit BlockBatch(const ACHAR* label);
+
+    void reserve(size_t count) { placements.reserve(count); }
+
+    void add(AcDbObjectId assetId, const AcGePoint3d& position, double rotation);
+    void add(AcDbObjectId assetId, const AcGePoint3d& position, double rotationX, double rotationY, double rotationZ);
+
+    // Block with its own scale factors, e.g. a part of a column definition
+    void add(AcDbObjectId assetId, const AcGePoint3d& position, double rotation, const AcGeScale3d& scale);
+
+    size_t size() const { return placements.size(); }
+    bool empty() const { return placements.empty(); }
+
+    // Appends every queued block to model space of the working database and prints the
+    // batch timing. If any append fails the whole batch is rolled back and the running
+    // CommandTransaction is marked failed. Returns the number of blocks placed; the batch
+    // is empty afterwards. `placedIds`, when given, receives the references in the order
+    // they were added (none when the batch was rolled back).
+    int commit(std::vector<AcDbObjectId>* placedIds = nullptr);
+
+private:
+    const ACHAR* label;
+    std::vector<BlockPlacement> placements;
+};
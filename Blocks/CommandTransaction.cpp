@@ -0,0 +1,42 @@
+#include "StdAfx.h"
+#include "CommandTransaction.h"
+#include "actrans.h"
+#include "acutads.h"
+
+
+class ManagerTransactionPort : public TransactionPort {
+public:
+    bool start() override {
+        return actrTransactionManager->startTransaction() != nullptr;
+    }
+
+    void end() override {
+        actrTransactionManager->endTransaction();
+    }
+
+    void abort() override {
+        actrTransactionManager->abortTransaction();
+    }
+};
+
+
+TransactionPort& CommandTransaction::port() {
+    static ManagerTransactionPort managerPort;
+    return managerPort;
+}
+
+
+CommandTransaction::CommandTransaction(const ACHAR* commandName)
+    : commandName(commandName), rollback(port()) {
+    // A command run from inside another joins the outer transaction
+    if (!rollback.started() && !CommandRollback::active()) {
+        acutPrintf(_T("\nFailed to start a transaction for %s."), commandName);
+    }
+}
+
+
+CommandTransaction::~CommandTransaction() {
+    if (rollback.started() && !rollback.finish()) {
+        acutPrintf(_T("\n%s failed; all blocks it placed were removed."), commandName);
+    }
+}
@@ -0,0 +1,28 @@
+// CommandTransaction.h
+#pragma once
+
+#include "BatchCommit.h"
+
+// Outer transaction around the drawing writes of one command. Block batches committed while
+// it is open run as nested transactions, and a failed batch marks the command for rollback,
+// so a failure removes every block the command placed instead of leaving half a layout.
+// The rules live in CommandRollback (BatchCommit.h); this adds the messages.
+class CommandTransaction {
+public:
+    explicit CommandTransaction(const ACHAR* commandName);
+
+    // Ends the transaction, or aborts it when a batch failed
+    ~CommandTransaction();
+
+    static bool active() { return CommandRollback::active(); }
+
+    // Marks the running command's writes for rollback. Does nothing outside a command transaction.
+    static void fail() { CommandRollback::fail(); }
+
+    // actrTransactionManager behind the commit layer's TransactionPort
+    static TransactionPort& port();
+
+private:
+    const ACHAR* commandName;
+    CommandRollback rollback;
+};
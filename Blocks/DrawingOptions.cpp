@@ -0,0 +1,78 @@
+#include "StdAfx.h"
+#include "DrawingOptions.h"
+#include "dbdict.h"
+#include "dbxrecrd.h"
+#include "acutads.h"
+#include "Profiler.h"
+
+
+bool DrawingOptions::flag(AcDbDatabase* pDb, const ACHAR* key, bool defaultValue) {
+    if (!pDb) {
+        return defaultValue;
+    }
+
+    AcDbDictionary* pNamedObjects;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (pDb->getNamedObjectsDictionary(pNamedObjects, AcDb::kForRead) != Acad::eOk) {
+        return defaultValue;
+    }
+
+    bool value = defaultValue;
+    AcDbObject* pObject;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (pNamedObjects->getAt(key, pObject, AcDb::kForRead) == Acad::eOk) {
+        AcDbXrecord* pRecord = AcDbXrecord::cast(pObject);
+        resbuf* pData = nullptr;
+        if (pRecord && pRecord->rbChain(&pData) == Acad::eOk && pData) {
+            value = pData->resval.rint != 0;
+            acutRelRb(pData);
+        }
+        pObject->close();
+    }
+    pNamedObjects->close();
+    return value;
+}
+
+
+bool DrawingOptions::setFlag(AcDbDatabase* pDb, const ACHAR* key, bool value) {
+    if (!pDb) {
+        return false;
+    }
+
+    AcDbDictionary* pNamedObjects;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (pDb->getNamedObjectsDictionary(pNamedObjects, AcDb::kForWrite) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to open the named object dictionary."));
+        return false;
+    }
+
+    AcDbXrecord* pRecord = nullptr;
+    AcDbObject* pObject;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (pNamedObjects->getAt(key, pObject, AcDb::kForWrite) == Acad::eOk) {
+        pRecord = AcDbXrecord::cast(pObject);
+        if (!pRecord) {
+            pObject->close();
+        }
+    }
+    else {
+        pRecord = new AcDbXrecord();
+        AcDbObjectId recordId;
+        if (pNamedObjects->setAt(key, pRecord, recordId) != Acad::eOk) {
+            delete pRecord;
+            pRecord = nullptr;
+        }
+    }
+    pNamedObjects->close();
+
+    if (!pRecord) {
+        acutPrintf(_T("\nFailed to store the %s option."), key);
+        return false;
+    }
+
+    resbuf* pData = acutBuildList(AcDb::kDxfInt16, value ? 1 : 0, RTNONE);
+    Acad::ErrorStatus es = pRecord->setFromRbChain(*pData);
+    acutRelRb(pData);
+    pRecord->close();
+    return es == Acad::eOk;
+}
@@ -0,0 +1,12 @@
+// DrawingOptions.h
+#pragma once
+
+#include "dbmain.h"
+
+// On/off options saved with the drawing, one Xrecord per option in the named object dictionary
+class DrawingOptions {
+public:
+    // `defaultValue` when the option was never set in this drawing
+    static bool flag(AcDbDatabase* pDb, const ACHAR* key, bool defaultValue);
+    static bool setFlag(AcDbDatabase* pDb, const ACHAR* key, bool value);
+};
@@ -0,0 +1,102 @@
+#include "StdAfx.h"
+#include "PanelStack.h"
+#include "AssetRegistry.h"
+#include "DrawingOptions.h"
+#include "DefineScale.h"
+#include "dbapserv.h"
+#include "dbents.h"
+#include "dbsymtb.h"
+#include "acutads.h"
+#include <sstream>
+#include "Profiler.h"
+
+static const ACHAR* optionKey = _T("PERI_PANEL_STACKS");
+static const wchar_t* blockPrefix = L"PeriStack_";
+static const wchar_t* upperBlockPrefix = L"PERISTACK_";
+
+
+bool PanelStack::enabled(AcDbDatabase* pDb) {
+    return DrawingOptions::flag(pDb, optionKey, false);
+}
+
+
+bool PanelStack::setEnabled(AcDbDatabase* pDb, bool enabled) {
+    return DrawingOptions::setFlag(pDb, optionKey, enabled);
+}
+
+
+std::wstring PanelStack::blockName(int width, const std::vector<int>& heights) {
+    std::wstringstream name;
+    name << blockPrefix << width << L"_";
+    for (size_t i = 0; i < heights.size(); ++i) {
+        name << (i > 0 ? L"-" : L"") << heights[i];
+    }
+    name << L"_" << globalVarScale.sx;
+    return name.str();
+}
+
+
+bool PanelStack::isStackName(const std::wstring& upperName) {
+    return upperName.compare(0, wcslen(upperBlockPrefix), upperBlockPrefix) == 0;
+}
+
+
+AcDbObjectId PanelStack::definition(AcDbDatabase* pDb, int width, const std::vector<int>& heights,
+    const std::map<std::pair<int, int>, AcDbObjectId>& panelAssets) {
+
+    if (!pDb || heights.empty()) {
+        return AcDbObjectId::kNull;
+    }
+
+    std::vector<AcDbObjectId> parts;
+    for (int height : heights) {
+        auto asset = panelAssets.find(std::make_pair(width, height));
+        if (asset == panelAssets.end() || asset->second.isNull()) {
+            return AcDbObjectId::kNull;
+        }
+        parts.push_back(asset->second);
+    }
+
+    std::wstring name = blockName(width, heights);
+    AcDbObjectId blockId = AssetRegistry::resolve(pDb, name.c_str());
+    if (!blockId.isNull()) {
+        return blockId;
+    }
+
+    AssetRegistry::DefinitionScope definitionScope;
+    AcDbBlockTable* pBlockTable;
+    Profiler::count(ProfileCounter::BlockTableOpens);
+    if (pDb->getBlockTable(pBlockTable, AcDb::kForWrite) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to open block table for write."));
+        return AcDbObjectId::kNull;
+    }
+
+    AcDbBlockTableRecord* pRecord = new AcDbBlockTableRecord();
+    pRecord->setName(name.c_str());
+    pRecord->setOrigin(AcGePoint3d::kOrigin);
+    if (pBlockTable->add(blockId, pRecord) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to add the panel stack block."));
+        delete pRecord;
+        pBlockTable->close();
+        return AcDbObjectId::kNull;
+    }
+    pBlockTable->close();
+
+    // The stack reference carries the drawing scale, so the nested panels are unscaled
+    // and their elevations are divided by it
+    double elevation = 0.0;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        AcDbBlockReference* pPanel = new AcDbBlockReference();
+        pPanel->setPosition(AcGePoint3d(0.0, 0.0, elevation / globalVarScale.sx));
+        pPanel->setBlockTableRecord(parts[i]);
+        if (pRecord->appendAcDbEntity(pPanel) != Acad::eOk) {
+            delete pPanel;
+        }
+        else {
+            pPanel->close();
+        }
+        elevation += heights[i];
+    }
+    pRecord->close();
+    return blockId;
+}
@@ -0,0 +1,30 @@
+// PanelStack.h
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "dbid.h"
+
+class AcDbDatabase;
+
+// A base panel and the panels stacked on it as one nested block, so a wall column is a
+// single reference. One definition per panel width and height recipe (bottom to top).
+class PanelStack {
+public:
+    // Per-drawing option (DrawingOptions), off unless switched on
+    static bool enabled(AcDbDatabase* pDb);
+    static bool setEnabled(AcDbDatabase* pDb, bool enabled);
+
+    // Block name for a recipe, e.g. PeriStack_600_1350-1350_1
+    static std::wstring blockName(int width, const std::vector<int>& heights);
+
+    // Name test on the upper-cased block name, for scanners expanding stacks
+    static bool isStackName(const std::wstring& upperName);
+
+    // Definition inserted at the base panel position: each panel in `heights` sits on the
+    // one below it. Created on first use; null when a panel of the recipe has no asset.
+    static AcDbObjectId definition(AcDbDatabase* pDb, int width, const std::vector<int>& heights,
+        const std::map<std::pair<int, int>, AcDbObjectId>& panelAssets);
+};
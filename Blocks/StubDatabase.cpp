@@ -0,0 +1,87 @@
+#include "StubDatabase.h"
+
+
+// References of one stub batch, appended to the running transaction
+class StubEntities : public BatchEntities {
+public:
+    StubEntities(StubDatabase& database, const std::vector<StubBlockReference>& placements)
+        : database(database), placements(placements) {
+    }
+
+    bool append(size_t index) override {
+        if (index == 0) {
+            database.reserve(placements.size());
+        }
+        return database.append(placements[index]);
+    }
+
+    void discard(size_t) override {
+    }
+
+private:
+    StubDatabase& database;
+    const std::vector<StubBlockReference>& placements;
+};
+
+
+bool StubDatabase::start() {
+    open.push_back(std::vector<StubBlockReference>());
+    starts++;
+    return true;
+}
+
+
+void StubDatabase::end() {
+    if (open.empty()) {
+        return;
+    }
+    std::vector<StubBlockReference> appended;
+    appended.swap(open.back());
+    open.pop_back();
+    std::vector<StubBlockReference>& target = open.empty() ? model : open.back();
+    if (target.empty()) {
+        target.swap(appended);
+        return;
+    }
+    target.insert(target.end(), appended.begin(), appended.end());
+}
+
+
+void StubDatabase::abort() {
+    if (!open.empty()) {
+        open.pop_back();
+    }
+}
+
+
+void StubDatabase::reserve(size_t count) {
+    if (!open.empty()) {
+        open.back().reserve(open.back().size() + count);
+    }
+}
+
+
+bool StubDatabase::append(const StubBlockReference& reference) {
+    if (open.empty()) {
+        return false;
+    }
+    open.back().push_back(reference);
+    return true;
+}
+
+
+void StubBlockBatch::add(const char* block, int width, int height, const PlanPoint& position, double rotation) {
+    placements.push_back({ block, width, height, position, rotation });
+}
+
+
+int StubBlockBatch::commit() {
+    if (placements.empty()) {
+        return 0;
+    }
+    StubEntities entities(database, placements);
+    bool committed = BatchCommit::commit(database, entities, placements.size());
+    int placed = committed ? static_cast<int>(placements.size()) : 0;
+    placements.clear();
+    return placed;
+}
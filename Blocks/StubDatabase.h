@@ -0,0 +1,60 @@
+// StubDatabase.h
+#pragma once
+
+#include "BatchCommit.h"
+#include "AssetPlacer/PlanGeometry.h"
+#include <vector>
+
+// Block reference as the stub database keeps it
+struct StubBlockReference {
+    const char* block;      // static label, e.g. "corner post"
+    int width;              // mm, 0 for parts without a catalogue size
+    int height;
+    PlanPoint position;
+    double rotation;
+};
+
+// In-memory drawing for the headless driver: nested transactions over a model space of block
+// references, with the commit and rollback rules of the plugin's transaction manager. No BRX
+// dependencies.
+class StubDatabase : public TransactionPort {
+public:
+    bool start() override;
+    void end() override;
+    void abort() override;
+
+    // Appends to the running transaction; false without one
+    bool append(const StubBlockReference& reference);
+
+    // Room for `count` more appends in the running transaction
+    void reserve(size_t count);
+
+    const std::vector<StubBlockReference>& modelSpace() const { return model; }
+
+    // Transactions started so far, nested ones included
+    int transactions() const { return starts; }
+
+private:
+    std::vector<std::vector<StubBlockReference>> open;
+    std::vector<StubBlockReference> model;
+    int starts = 0;
+};
+
+// BlockBatch on the stub database: references built first, then appended in one transaction
+// through BatchCommit
+class StubBlockBatch {
+public:
+    explicit StubBlockBatch(StubDatabase& database) : database(database) {}
+
+    void reserve(size_t count) { placements.reserve(count); }
+    void add(const char* block, int width, int height, const PlanPoint& position, double rotation);
+
+    size_t size() const { return placements.size(); }
+
+    // Number of references placed, 0 when the batch was rolled back; the batch is empty afterwards
+    int commit();
+
+private:
+    StubDatabase& database;
+    std::vector<StubBlockReference> placements;
+};
@@ -11,6 +11,7 @@
 #include <vector>
 #include <locale>
 #include <codecvt>
+#include "Profiler.h"
 
 using json = nlohmann::json;
 
@@ -68,6 +69,7 @@ void ExtractColumn()
         }
 
         AcDbEntity* pEntity;
+        Profiler::count(ProfileCounter::ObjectsOpened);
         if (acdbOpenObject(pEntity, entityId, AcDb::kForRead) != Acad::eOk) {
             continue;
         }
@@ -78,6 +80,7 @@ void ExtractColumn()
             
             AcDbObjectId blockId = pBlockRef->blockTableRecord();
             AcDbBlockTableRecord* pBlockDef;
+            Profiler::count(ProfileCounter::ObjectsOpened);
             Acad::ErrorStatus es = acdbOpenObject(pBlockDef, blockId, AcDb::kForRead);
             if (es != Acad::eOk) {
                 acutPrintf(_T("\nFailed to open block definition: %s"), (es));
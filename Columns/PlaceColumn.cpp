@@ -10,6 +10,7 @@
 #include <string>
 #include <sstream>
 #include "DefineHeight.h"
+#include "Blocks/BlockBatch.h"
 
 using json = nlohmann::json;
 
@@ -72,90 +73,61 @@ void PlaceColumn(const std::string& jsonFilePath)
     basePoint.set(adsBasePoint[X], adsBasePoint[Y], adsBasePoint[Z]);
 
     
-    AcDbBlockTable* pBlockTable;
-    acdbHostApplicationServices()->workingDatabase()->getSymbolTable(pBlockTable, AcDb::kForRead);
-
-    
-    AcDbBlockTableRecord* pModelSpace;
-    pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForWrite);
+    if (globalVarHeight <= 0) {
+        acutPrintf(_T("\nReached the target height of %d mm."), globalVarHeight);
+        return;
+    }
 
     
-    double cumulativeHeight = 0.0;
+    AcDbBlockTable* pBlockTable;
+    if (acdbHostApplicationServices()->workingDatabase()->getSymbolTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to get block table."));
+        return;
+    }
 
     
+    AcGePoint3d firstBlockPos(
+        selectedBlockData["blocks"][0]["position"]["x"].get<double>(),
+        selectedBlockData["blocks"][0]["position"]["y"].get<double>(),
+        selectedBlockData["blocks"][0]["position"]["z"].get<double>()
+    );
+
+    // Every part of the column goes in one batch, so a failed append rolls the command back
+    BlockBatch batch(_T("column"));
     for (const auto& blockData : selectedBlockData["blocks"]) {
-        
-        if (cumulativeHeight >= globalVarHeight) {
-            acutPrintf(_T("\nReached the target height of %d mm."), globalVarHeight);
-            break;
-        }
-
-        
-        AcGePoint3d firstBlockPos(
-            selectedBlockData["blocks"][0]["position"]["x"].get<double>(),
-            selectedBlockData["blocks"][0]["position"]["y"].get<double>(),
-            selectedBlockData["blocks"][0]["position"]["z"].get<double>()
+        std::string blockNameStr = blockData["name"];
+        AcGePoint3d blockPos(
+            blockData["position"]["x"].get<double>(),
+            blockData["position"]["y"].get<double>(),
+            blockData["position"]["z"].get<double>()
+        );
+        double blockRotation = blockData["rotation"];
+        AcGeScale3d blockScale(
+            blockData["scale"]["x"].get<double>(),
+            blockData["scale"]["y"].get<double>(),
+            blockData["scale"]["z"].get<double>()
         );
 
         
-        for (const auto& blockData : selectedBlockData["blocks"]) {
-            std::string blockNameStr = blockData["name"];
-            AcGePoint3d blockPos(
-                blockData["position"]["x"].get<double>(),
-                blockData["position"]["y"].get<double>(),
-                blockData["position"]["z"].get<double>()
-            );
-            double blockRotation = blockData["rotation"];
-            AcGeScale3d blockScale(
-                blockData["scale"]["x"].get<double>(),
-                blockData["scale"]["y"].get<double>(),
-                blockData["scale"]["z"].get<double>()
-            );
-
-            
 #ifdef UNICODE
-            std::wstring wBlockName = std::wstring(blockNameStr.begin(), blockNameStr.end());
-            const wchar_t* blockName = wBlockName.c_str();
+        std::wstring wBlockName = std::wstring(blockNameStr.begin(), blockNameStr.end());
+        const wchar_t* blockName = wBlockName.c_str();
 #else
-            const char* blockName = blockNameStr.c_str();
+        const char* blockName = blockNameStr.c_str();
 #endif
 
-            
-            AcDbBlockTableRecord* pBlockDef;
-            if (pBlockTable->getAt(blockName, pBlockDef, AcDb::kForRead) != Acad::eOk) {
-                acutPrintf(_T("\nBlock definition not found: %s"), blockName);
-                continue;
-            }
-
-            
-            AcGeVector3d offset = blockPos - firstBlockPos;
-
-            
-            AcGePoint3d insertionPoint = basePoint + offset;
-
-            
-            AcDbBlockReference* pBlockRef = new AcDbBlockReference();
-            pBlockRef->setBlockTableRecord(pBlockDef->objectId());
-            pBlockRef->setPosition(insertionPoint);
-            pBlockRef->setRotation(blockRotation);
-            pBlockRef->setScaleFactors(blockScale);
-
-            
-            if (pModelSpace->appendAcDbEntity(pBlockRef) == Acad::eOk) {
-                acutPrintf(_T("\nBlock '%s' inserted successfully at (%.2f, %.2f, %.2f)."),
-                    blockName, insertionPoint.x, insertionPoint.y, insertionPoint.z);
-            }
-            else {
-                acutPrintf(_T("\nFailed to insert block '%s'."), blockName);
-            }
-
-            
-            pBlockRef->close();
-            pBlockDef->close();
+        
+        AcDbObjectId blockDefId;
+        if (pBlockTable->getAt(blockName, blockDefId) != Acad::eOk) {
+            acutPrintf(_T("\nBlock definition not found: %s"), blockName);
+            continue;
         }
 
         
-        pModelSpace->close();
-        pBlockTable->close();
+        AcGeVector3d offset = blockPos - firstBlockPos;
+        batch.add(blockDefId, basePoint + offset, blockRotation, blockScale);
     }
-}
\ No newline at end of file
+    pBlockTable->close();
+
+    batch.commit();
+}
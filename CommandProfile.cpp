@@ -0,0 +1,37 @@
+#include "StdAfx.h"
+#include "CommandProfile.h"
+#include "dbapserv.h"
+#include "dbmain.h"
+
+
+class CommandProfileReactor : public AcDbDatabaseReactor {
+public:
+    void objectAppended(const AcDbDatabase* pDb, const AcDbObject* pObj) override {
+        if (AcDbEntity::cast(pObj)) {
+            Profiler::count(ProfileCounter::EntitiesAppended);
+        }
+    }
+};
+
+
+CommandProfile::CommandProfile(const char* commandName)
+    : nested(Profiler::active()), scope(commandName), pDb(nullptr), reactor(nullptr) {
+    // A nested command reports into the outer run, whose reactor already counts appends
+    if (nested) {
+        return;
+    }
+
+    pDb = acdbHostApplicationServices()->workingDatabase();
+    if (pDb) {
+        reactor = new CommandProfileReactor();
+        pDb->addReactor(reactor);
+    }
+}
+
+
+CommandProfile::~CommandProfile() {
+    if (pDb && reactor) {
+        pDb->removeReactor(reactor);
+    }
+    delete reactor;
+}
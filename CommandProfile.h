@@ -0,0 +1,21 @@
+// CommandProfile.h
+#pragma once
+
+#include "Profiler.h"
+
+class AcDbDatabase;
+class CommandProfileReactor;
+
+// Profiler run for one registered command. Entities appended to the working database while
+// the command runs are counted through a database reactor, so placers need no extra calls.
+class CommandProfile {
+public:
+    explicit CommandProfile(const char* commandName);
+    ~CommandProfile();
+
+private:
+    bool nested;
+    Profiler::CommandScope scope;
+    AcDbDatabase* pDb;
+    CommandProfileReactor* reactor;
+};
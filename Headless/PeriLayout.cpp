@@ -0,0 +1,134 @@
+// PeriLayout.cpp
+// Command line driver for the layout engines, built with CMake and without the BRX SDK.
+//   peri-layout report <plan.txt> [--threads N]
+//                                      wall layout, ties, corners and connectors of a plan file,
+//                                      committed to a stub drawing (see LayoutDriver.h)
+//   peri-layout benchmark [--seed N] [--max-threads N] [--out file.csv]
+//                                      stage timings on the generated plan suite, as CSV
+#include "AssetPlacer/LayoutDriver.h"
+#include "AssetPlacer/PlanGenerator.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int usage() {
+    std::cerr << "usage: peri-layout report <plan.txt> [--threads N]\n"
+        << "       peri-layout benchmark [--seed N] [--max-threads N] [--out file.csv]\n";
+    return 2;
+}
+
+
+// Value of `name value` at argv[index], advancing past it; false for another option or a missing value
+static bool optionValue(int argc, char** argv, int& index, const std::string& name, std::string& value) {
+    if (argv[index] != name) {
+        return false;
+    }
+    if (index + 1 >= argc) {
+        return false;
+    }
+    value = argv[++index];
+    return true;
+}
+
+
+static int report(int argc, char** argv) {
+    std::string planPath = argv[2];
+    unsigned threads = 0;
+    for (int index = 3; index < argc; ++index) {
+        std::string value;
+        if (optionValue(argc, argv, index, "--threads", value)) {
+            threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else {
+            return usage();
+        }
+    }
+
+    std::ifstream planFile(planPath);
+    if (!planFile.is_open()) {
+        std::cerr << "Failed to open the plan file " << planPath << "\n";
+        return 1;
+    }
+
+    PlanInput plan;
+    std::string error;
+    if (!LayoutDriver::readPlan(planFile, plan, error)) {
+        std::cerr << "Failed to read the plan file: " << error << "\n";
+        return 1;
+    }
+
+    LayoutPlan layout;
+    LayoutRunReport result = LayoutDriver::run(plan, layout, threads);
+    std::cout << "Loops: " << result.loops << " (" << result.outerLoops << " outer), corners: " << result.corners << "\n";
+    std::cout << "Walls: " << result.walls << ", T-joints: " << result.tJoints << ", crossings: " << result.crossings << "\n";
+    std::cout << "Wall panels: " << result.wallPanels << ", stacked panels: " << result.stackedPanels << ", ties: " << result.ties << "\n";
+    std::cout << "Corners: " << result.insideCorners << " inside, " << result.outsideCorners << " outside, corner parts: "
+        << result.cornerParts << ", connectors: " << result.connectors << "\n";
+    std::cout << "Committed: " << result.committed << " block references\n";
+    std::cout << "Hierarchy: " << result.hierarchyMs << " ms, graph: " << result.graphMs << " ms, layout: " << result.layoutMs << " ms, ties: " << result.tieMs
+        << " ms, corners: " << result.cornerMs << " ms, connectors: " << result.connectorMs << " ms, commit: " << result.commitMs << " ms\n";
+    return 0;
+}
+
+
+static int benchmark(int argc, char** argv) {
+    unsigned seed = 1;
+    int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+    std::string csvPath;
+    for (int index = 2; index < argc; ++index) {
+        std::string value;
+        if (optionValue(argc, argv, index, "--seed", value)) {
+            seed = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (optionValue(argc, argv, index, "--max-threads", value)) {
+            maxThreads = std::atoi(value.c_str());
+        }
+        else if (optionValue(argc, argv, index, "--out", value)) {
+            csvPath = value;
+        }
+        else {
+            return usage();
+        }
+    }
+
+    // 1, 2, 4, ... up to the maximum, for the scaling curve of the wall layout
+    std::vector<unsigned> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(static_cast<unsigned>(threads));
+    }
+    threadCounts.push_back(static_cast<unsigned>(maxThreads > 1 ? maxThreads : 1));
+
+    PlanGenerator generator(seed);
+    if (csvPath.empty()) {
+        LayoutDriver::benchmark(generator.standardSuite(), seed, threadCounts, std::cout);
+        return 0;
+    }
+
+    std::ofstream csvFile(csvPath);
+    if (!csvFile.is_open()) {
+        std::cerr << "Failed to open the CSV file " << csvPath << "\n";
+        return 1;
+    }
+    LayoutDriver::benchmark(generator.standardSuite(), seed, threadCounts, csvFile);
+    std::cout << "Benchmark written to " << csvPath << "\n";
+    return 0;
+}
+
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return usage();
+    }
+
+    std::string command = argv[1];
+    if (command == "report" && argc >= 3) {
+        return report(argc, argv);
+    }
+    if (command == "benchmark") {
+        return benchmark(argc, argv);
+    }
+    return usage();
+}
@@ -0,0 +1,157 @@
+// Profiler.cpp
+#include "Profiler.h"
+#include <cstdio>
+#include <ostream>
+
+bool Profiler::running = false;
+int Profiler::depth = 0;
+std::chrono::steady_clock::time_point Profiler::runStart;
+ProfileRun Profiler::current;
+ProfileRun Profiler::finished;
+
+static const char* counterNames[profileCounterCount] = {
+    "entities appended",
+    "objects opened",
+    "block table opens"
+};
+
+
+static std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+            escaped += buf;
+        }
+        else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+
+Profiler::CommandScope::CommandScope(const char* commandName)
+    : nested(running), phaseIndex(noPhase) {
+    if (nested) {
+        phaseIndex = beginPhase(commandName);
+        return;
+    }
+
+    current = ProfileRun();
+    current.command = commandName;
+    depth = 0;
+    runStart = std::chrono::steady_clock::now();
+    running = true;
+}
+
+
+Profiler::CommandScope::~CommandScope() {
+    if (nested) {
+        endPhase(phaseIndex);
+        return;
+    }
+
+    current.totalMs = nowMs();
+    running = false;
+    finished = current;
+    current = ProfileRun();
+}
+
+
+Profiler::Phase::Phase(const char* name)
+    : phaseIndex(beginPhase(name)) {
+}
+
+
+Profiler::Phase::~Phase() {
+    endPhase(phaseIndex);
+}
+
+
+size_t Profiler::beginPhase(const char* name) {
+    if (!running) {
+        return noPhase;
+    }
+
+    ProfilePhase phase;
+    phase.name = name;
+    phase.depth = depth++;
+    phase.startMs = nowMs();
+    phase.durationMs = 0.0;
+    current.phases.push_back(phase);
+    return current.phases.size() - 1;
+}
+
+
+void Profiler::endPhase(size_t phaseIndex) {
+    if (!running || phaseIndex == noPhase || phaseIndex >= current.phases.size()) {
+        return;
+    }
+
+    ProfilePhase& phase = current.phases[phaseIndex];
+    phase.durationMs = nowMs() - phase.startMs;
+    depth = phase.depth;
+}
+
+
+void Profiler::count(ProfileCounter counter, unsigned long amount) {
+    if (running) {
+        current.counters[static_cast<int>(counter)] += amount;
+    }
+}
+
+
+double Profiler::nowMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+}
+
+
+void Profiler::writeSummary(const ProfileRun& run, std::ostream& out) {
+    char line[256];
+    std::snprintf(line, sizeof(line), "%s: %.1f ms\n", run.command.c_str(), run.totalMs);
+    out << line;
+
+    for (const auto& phase : run.phases) {
+        double share = run.totalMs > 0.0 ? 100.0 * phase.durationMs / run.totalMs : 0.0;
+        std::snprintf(line, sizeof(line), "%*s%-32s %10.1f ms %5.1f%%\n",
+            2 + 2 * phase.depth, "", phase.name.c_str(), phase.durationMs, share);
+        out << line;
+    }
+
+    for (int i = 0; i < profileCounterCount; ++i) {
+        std::snprintf(line, sizeof(line), "%s: %lu\n", counterNames[i], run.counters[i]);
+        out << line;
+    }
+}
+
+
+void Profiler::writeChromeTrace(const ProfileRun& run, std::ostream& out) {
+    char number[64];
+    out << "{\"traceEvents\":[\n";
+
+    std::snprintf(number, sizeof(number), "%.3f", run.totalMs * 1000.0);
+    out << "{\"name\":\"" << jsonEscape(run.command) << "\",\"cat\":\"command\",\"ph\":\"X\",\"ts\":0,\"dur\":"
+        << number << ",\"pid\":1,\"tid\":1}";
+
+    for (const auto& phase : run.phases) {
+        out << ",\n{\"name\":\"" << jsonEscape(phase.name) << "\",\"cat\":\"phase\",\"ph\":\"X\",\"ts\":";
+        std::snprintf(number, sizeof(number), "%.3f", phase.startMs * 1000.0);
+        out << number << ",\"dur\":";
+        std::snprintf(number, sizeof(number), "%.3f", phase.durationMs * 1000.0);
+        out << number << ",\"pid\":1,\"tid\":1}";
+    }
+
+    std::snprintf(number, sizeof(number), "%.3f", run.totalMs * 1000.0);
+    out << ",\n{\"name\":\"counters\",\"ph\":\"C\",\"ts\":" << number << ",\"pid\":1,\"args\":{";
+    for (int i = 0; i < profileCounterCount; ++i) {
+        out << (i > 0 ? "," : "") << "\"" << counterNames[i] << "\":" << run.counters[i];
+    }
+    out << "}}\n]}\n";
+}
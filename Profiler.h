@@ -0,0 +1,80 @@
+// Profiler.h
+#pragma once
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+enum class ProfileCounter {
+    EntitiesAppended = 0,
+    ObjectsOpened = 1,
+    BlockTableOpens = 2
+};
+
+const int profileCounterCount = 3;
+
+struct ProfilePhase {
+    std::string name;
+    int depth;
+    double startMs;
+    double durationMs;
+};
+
+struct ProfileRun {
+    std::string command;
+    double totalMs = 0.0;
+    std::vector<ProfilePhase> phases;
+    unsigned long counters[profileCounterCount] = { 0, 0, 0 };
+};
+
+// Phase timings and counters for one command run. Only the last finished run is kept, so
+// PeriProfile can report on whatever ran before it. Uses std::chrono only, no BRX dependencies.
+class Profiler {
+public:
+    // Starts a new run on construction and finishes it on destruction. A scope opened while
+    // a run is already active is recorded as a phase of that run.
+    class CommandScope {
+    public:
+        explicit CommandScope(const char* commandName);
+        ~CommandScope();
+
+    private:
+        bool nested;
+        size_t phaseIndex;
+    };
+
+    // Times the enclosing block as a named phase. Does nothing outside a command scope.
+    class Phase {
+    public:
+        explicit Phase(const char* name);
+        ~Phase();
+
+    private:
+        size_t phaseIndex;
+    };
+
+    static void count(ProfileCounter counter, unsigned long amount = 1);
+
+    static bool active() { return running; }
+    static const ProfileRun& lastRun() { return finished; }
+
+    // Indented phase list followed by the counters
+    static void writeSummary(const ProfileRun& run, std::ostream& out);
+
+    // Chrome trace event JSON, loadable in chrome://tracing or Perfetto
+    static void writeChromeTrace(const ProfileRun& run, std::ostream& out);
+
+private:
+    static const size_t noPhase = static_cast<size_t>(-1);
+
+    static size_t beginPhase(const char* name);
+    static void endPhase(size_t phaseIndex);
+    static double nowMs();
+
+    static bool running;
+    static int depth;
+    static std::chrono::steady_clock::time_point runStart;
+    static ProfileRun current;
+    static ProfileRun finished;
+};
@@ -15,7 +15,11 @@
 #include <map>
 #include "Props.h"
 #include "SharedDefinations.h"
+#include "Blocks/AssetRegistry.h"
+#include "Blocks/BlockBatch.h"
 #include "AssetPlacer/GeometryUtils.h"
+#include "AssetPlacer/PanelFillSolver.h"
+#include "WallPanelConnectors/PanelIndex.h"
 #include "dbapserv.h"
 #include "dbents.h"
 #include "dbsymtb.h"
@@ -32,118 +36,25 @@
 #include <nlohmann/json.hpp> 
 #include "AcDb/AcDbSmartObjectPointer.h"  
 #include <Windows.h>
+#include "Profiler.h"
 
 
 using json = nlohmann::json;
 
-std::map<AcGePoint3d, std::vector<AcGePoint3d>, PlaceProps::Point3dComparator> PlaceProps::wallMap;
-
-const int BATCH_SIZE = 1000; 
-
-const double TOLERANCE = 0.1; 
-
 static bool isIntegerProps(double value, double tolerance = 1e-9) {
     return std::abs(value - std::round(value)) < tolerance;
 }
 
 
 std::vector<AcGePoint3d> PlaceProps::detectPolylines() {
+    Profiler::Phase phase("detect_polylines");
     
+    // Corners of the closed wall polylines, analysed once per drawing instead of per command
     std::vector<AcGePoint3d> corners;
-    wallMap.clear();  
-
-    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-    if (!pDb) {
+    if (!wallPolylineCorners(corners)) {
         acutPrintf(_T("\nNo working database found."));
-        return corners;
     }
-
-    AcDbBlockTable* pBlockTable;
-    Acad::ErrorStatus es = pDb->getBlockTable(pBlockTable, AcDb::kForRead);
-    if (es != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get block table. Error status: %d\n"), es);
-        return corners;
-    }
-
-    AcDbBlockTableRecord* pModelSpace;
-    es = pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead);
-    if (es != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get model space. Error status: %d\n"), es);
-        pBlockTable->close();
-        return corners;
-    }
-
-    AcDbBlockTableRecordIterator* pIter;
-    es = pModelSpace->newIterator(pIter);
-    if (es != Acad::eOk) {
-        acutPrintf(_T("\nFailed to create iterator. Error status: %d\n"), es);
-        pModelSpace->close();
-        pBlockTable->close();
-        return corners;
-    }
-
-    int entityCount = 0;
-    for (pIter->start(); !pIter->done(); pIter->step()) {
-        AcDbEntity* pEnt;
-        es = pIter->getEntity(pEnt, AcDb::kForRead);
-        if (es == Acad::eOk) {
-            if (pEnt->isKindOf(AcDbPolyline::desc())) {
-                AcDbPolyline* pPolyline = AcDbPolyline::cast(pEnt);
-                if (pPolyline) {
-                    processPolyline(pPolyline, corners, 90.0, TOLERANCE);  
-                }
-            }
-            pEnt->close();
-            entityCount++;
-
-            if (entityCount % BATCH_SIZE == 0) {
-                acutPrintf(_T("\nProcessed %d entities. Pausing to avoid resource exhaustion.\n"), entityCount);
-                std::this_thread::sleep_for(std::chrono::seconds(1));  
-            }
-        }
-        else {
-            acutPrintf(_T("\nFailed to get entity. Error status: %d\n"), es);
-        }
-    }
-
-    delete pIter;
-    pModelSpace->close();
-    pBlockTable->close();
-
-    
     return corners;
-
-}
-
-double crossProductProps(const AcGePoint3d& o, const AcGePoint3d& a, const AcGePoint3d& b) {
-    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
-}
-
-bool directionOfDrawingProps(std::vector<AcGePoint3d>& points) {
-    
-    if (!(points.front().x == points.back().x && points.front().y == points.back().y)) {
-        points.push_back(points.front());
-    }
-
-    double totalTurns = 0.0;
-
-    for (size_t i = 1; i < points.size() - 1; ++i) {
-        totalTurns += crossProductProps(points[i - 1], points[i], points[i + 1]);
-    }
-
-    
-    if (totalTurns < 0) {
-        return true;  
-    }
-    
-    else if (totalTurns > 0) {
-        return false; 
-    }
-    
-    else {
-        acutPrintf(_T("Warning: The shape does not have a defined direction. Defaulting to clockwise.\n"));
-        return true;  
-    }
 }
 
 struct BlockInfoProps {
@@ -161,72 +72,19 @@ struct BlockInfoProps {
 
 
 std::vector<std::tuple<AcGePoint3d, std::wstring, double>> PlaceProps::getWallPanelPositions() {
-    std::vector<std::tuple<AcGePoint3d, std::wstring, double>> positions;
-
-    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-    if (!pDb) {
-        acutPrintf(_T("\nNo working database found."));
-        return positions;
-    }
-
-    AcDbBlockTable* pBlockTable;
-    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get block table."));
-        return positions;
-    }
-
-    AcDbBlockTableRecord* pModelSpace;
-    if (pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get model space."));
-        pBlockTable->close();
-        return positions;
-    }
-
-    AcDbBlockTableRecordIterator* pIter;
-    if (pModelSpace->newIterator(pIter) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to create iterator."));
-        pModelSpace->close();
-        pBlockTable->close();
-        return positions;
-    }
-
-    int entityCount = 0;
-    for (pIter->start(); !pIter->done(); pIter->step()) {
-        AcDbEntity* pEnt;
-        entityCount++;
-        if (pIter->getEntity(pEnt, AcDb::kForRead) == Acad::eOk) {
-            if (pEnt->isKindOf(AcDbBlockReference::desc())) {
-                AcDbBlockReference* pBlockRef = AcDbBlockReference::cast(pEnt);
-                if (pBlockRef) {
-                    AcDbObjectId blockId = pBlockRef->blockTableRecord();
-                    AcDbBlockTableRecord* pBlockDef;
-                    if (acdbOpenObject(pBlockDef, blockId, AcDb::kForRead) == Acad::eOk) {
-                        const wchar_t* blockName;
-                        pBlockDef->getName(blockName);
-                        std::wstring blockNameStr(blockName);
-                        blockNameStr = toUpperCase(blockNameStr);
-
-                        
-                        if (blockNameStr == ASSET_128292 || blockNameStr == ASSET_129884) {
-                            positions.emplace_back(pBlockRef->position(), blockNameStr, pBlockRef->rotation());
-                        }
-                        pBlockDef->close();
-                    }
-                }
-            }
-            pEnt->close();
-        }
-    }
-
-    delete pIter;
-    pModelSpace->close();
-    pBlockTable->close();
-
-    return positions;
+    // Through the panel index, so compensators inside panel stack blocks are found as well
+    PanelIndex index;
+    if (!index.build()) {
+        return {};
+    }
+    return index.positions([](const IndexedPanel& panel) {
+        return panel.name == ASSET_128292 || panel.name == ASSET_129884;
+    });
 }
 
 std::wstring getBlockNameProps(AcDbObjectId blockId) {
     AcDbBlockTableRecord* pBlockRec = nullptr;
+    Profiler::count(ProfileCounter::ObjectsOpened);
     if (acdbOpenObject(pBlockRec, blockId, AcDb::kForRead) != Acad::eOk) {
         return L"";
     }
@@ -246,6 +104,7 @@ std::wstring getBlockNameProps(AcDbObjectId blockId) {
 
 
 std::vector<BlockInfoProps> getSelectedBlocksInfo() {
+    Profiler::Phase phase("block_selection");
     std::vector<BlockInfoProps> BlockInfoProps;
 
     
@@ -275,6 +134,7 @@ std::vector<BlockInfoProps> getSelectedBlocksInfo() {
         AcDbObjectId objId;
         acdbGetObjectId(objId, ent);
         AcDbEntity* pEnt = nullptr;
+        Profiler::count(ProfileCounter::ObjectsOpened);
         if (acdbOpenObject(pEnt, objId, AcDb::kForRead) != Acad::eOk) {
             acutPrintf(_T("\nFailed to open entity."));
             continue;
@@ -290,6 +150,7 @@ std::vector<BlockInfoProps> getSelectedBlocksInfo() {
             
             AcDbObjectId blockTableRecordId = pBlockRef->blockTableRecord();
             AcDbBlockTableRecord* pBlockTableRecord = nullptr;
+            Profiler::count(ProfileCounter::ObjectsOpened);
             if (acdbOpenObject(pBlockTableRecord, blockTableRecordId, AcDb::kForRead) == Acad::eOk) {
                 info.blockName = getBlockNameProps(pBlockRef->blockTableRecord());
                 pBlockTableRecord->close();
@@ -320,27 +181,11 @@ std::vector<BlockInfoProps> getSelectedBlocksInfo() {
 
 
 AcDbObjectId PlaceProps::loadAsset(const wchar_t* blockName) {
-    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-    if (!pDb) {
-        acutPrintf(_T("\nNo working database found."));
-        return AcDbObjectId::kNull;
-    }
-
-    AcDbBlockTable* pBlockTable;
-    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get block table."));
-        return AcDbObjectId::kNull;
-    }
-
-    AcDbObjectId assetId;
-    if (pBlockTable->getAt(blockName, assetId) != Acad::eOk) {
+    AcDbObjectId blockId = AssetRegistry::resolve(blockName);
+    if (blockId.isNull()) {
         acutPrintf(_T("\nFailed to get block table record for block '%s'."), blockName);
-        pBlockTable->close();
-        return AcDbObjectId::kNull;
     }
-
-    pBlockTable->close();
-    return assetId;
+    return blockId;
 }
 
 const std::string  PROPS_FILE_NAME = "OneDrive - PERI Group\\Documents\\AP-PeriCAD-Automation-Tools\\[03]Plugin\\props.json";
@@ -355,41 +200,6 @@ void PlaceProps::placeProps() {
     }
 
 	
-    int closeLoopCounter = -1;
-    int loopIndex = 0;
-    double outerPointCounter = corners[0].x;
-	int outerLoopIndexValue = 0;
-    int firstLoopEnd;
-
-	
-    for (size_t cornerNum = 0; cornerNum < corners.size(); ++cornerNum) {
-        closeLoopCounter++;
-        AcGePoint3d start = corners[cornerNum];
-        AcGePoint3d end = corners[(cornerNum + 1) % corners.size()];  
-        AcGeVector3d direction = (end - start).normal();
-
-        if (start.x > outerPointCounter) {
-            outerPointCounter = start.x;
-            outerLoopIndexValue = loopIndex;
-        }
-
-        if (!isIntegerProps(direction.x) || !isIntegerProps(direction.y)) {
-            if (cornerNum < corners.size() - 1) {
-                closeLoopCounter = -1;
-                loopIndex = 1;
-                firstLoopEnd = static_cast<int>(cornerNum);
-            }
-        }
-    }
-
-	if (outerLoopIndexValue == 0) {
-		std::vector<AcGePoint3d> firstLoop(corners.begin(), corners.begin() + firstLoopEnd + 1);
-        bool firstLoopIsClockwise = directionOfDrawingProps(firstLoop);
-	}
-    else if (outerLoopIndexValue == 1) {
-        std::vector<AcGePoint3d> firstLoop(corners.begin() + firstLoopEnd + 1, corners.end());
-		bool firstLoopIsClockwise = directionOfDrawingProps(firstLoop);
-    }
     std::vector<BlockInfoProps> BlockInfoProps = getSelectedBlocksInfo();
     if (BlockInfoProps.empty()) {
         acutPrintf(_T("\nNo block references selected."));
@@ -425,27 +235,6 @@ void PlaceProps::placeProps() {
 
     std::vector<WallPanel> wallPanels;
 
-    int wallHeight = globalVarHeight;
-    int panelHeights[] = { 1350, 1200, 600 };
-
-    int numHeights = 3;
-
-    int maxHeight = 0;
-
-    
-    for (int i = 0; i < (1 << numHeights); ++i) {
-		int currentHeight = 0;
-        for (int j = 0; j < numHeights; ++j) {
-            if (i & (1 << j)) {
-                currentHeight += panelHeights[j];
-            }
-        }
-        if (currentHeight <= wallHeight && currentHeight > maxHeight) {
-            maxHeight = currentHeight;
-        }
-    }
-
-    
     struct Panel {
         int length;
         std::wstring id[3];
@@ -476,104 +265,35 @@ void PlaceProps::placeProps() {
     double panelLength;
 
 	
+    std::vector<AcDbObjectId> rowAssets;
+    std::vector<int> fillWidths;
     for (const auto& panel : panelSizes) {
-
         for (int panelNum = 0; panelNum < 2; panelNum++) {
             AcDbObjectId assetId = loadAsset(panel.id[panelNum].c_str());
-			
-
             if (assetId != AcDbObjectId::kNull) {
-                    int numPanels = static_cast<int>(distance / panel.length);
-                    if (numPanels != 0) {
-                        for (int i = 0; i < numPanels; i++) {
-
-                            panelLength = panel.length;
-                            wallPanels.push_back({ currentPoint, assetId, rotation, panelLength });
-
-                            currentPoint += direction * panelLength;
-                            distance -= panelLength;
-                        }
-                    }
+                rowAssets.push_back(assetId);
+                fillWidths.push_back(panel.length);
+                break;
             }
         }
     }
 
     
-    std::vector<AcDbObjectId> centerAssets = {
-    loadAsset(L"128285X"),
-    loadAsset(L"129842X"),
-    loadAsset(L"129879X"),
-    loadAsset(L"129884X"),
-    loadAsset(L"128287X"),
-    loadAsset(L"128292X")
-    };
-
-    int prevStartCornerIndex = -1;
-    int movedCompensators = 0;
-
-    for (int panelNum = 0; panelNum < wallPanels.size(); ++panelNum) {
-        WallPanel& panel = wallPanels[panelNum];
-        if (std::find(centerAssets.begin(), centerAssets.end(), panel.assetId) != centerAssets.end()) {
-
-            
-            int panelPosition = panelNum;
-            WallPanel detectedPanel = wallPanels[panelPosition];
-            AcGePoint3d detectedPanelPosition = detectedPanel.position;
-            AcDbObjectId detectedPanelId = detectedPanel.assetId;
-
-            double panelLength = wallPanels[panelPosition].length;
-
-            
-            int centerIndex = static_cast<int>(wallPanels.size() / 2);
-
-            
-            AcGePoint3d centerPanelPosition = wallPanels[centerIndex + movedCompensators].position;
-
-            AcGeVector3d direction = (wallPanels[panelNum].position - wallPanels[centerIndex].position).normal();
-
-            
-            wallPanels[panelNum].position = centerPanelPosition;
-
-            for (int centerToCornerPanelNum = centerIndex + movedCompensators; centerToCornerPanelNum < panelNum - movedCompensators; centerToCornerPanelNum++) {
-                wallPanels[centerToCornerPanelNum].position = wallPanels[centerToCornerPanelNum].position + direction * panelLength;
-            }
+    PanelFillSolver& panelFill = PanelFillSolver::shared(fillWidths);
+    std::vector<int> panelOrder;
+    panelFill.arrange(panelFill.solve(distance), panelOrder);
+    for (int rowNum : panelOrder) {
+        panelLength = fillWidths[rowNum];
 
-            movedCompensators++;
+        // Compensators are gathered in the middle of the run and carry no props
+        if (!panelFill.isCompensator(rowNum)) {
+            wallPanels.push_back({ currentPoint, rowAssets[rowNum], rotation, panelLength });
         }
+        currentPoint += direction * panelLength;
+        distance -= panelLength;
     }
 
-    wallPanels.erase(
-        std::remove_if(
-            wallPanels.begin(),
-            wallPanels.end(),
-            [&centerAssets](const WallPanel& panel) {
-                return std::find(centerAssets.begin(), centerAssets.end(), panel.assetId) != centerAssets.end();
-            }
-        ),
-        wallPanels.end()
-    );
-
-	
-    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-    if (!pDb) {
-        acutPrintf(_T("\nNo working database found."));
-        return;
-    }
-
-    AcDbBlockTable* pBlockTable;
-    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get block table."));
-        return;
-    }
-
-    AcDbBlockTableRecord* pModelSpace;
-    if (pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForWrite) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get model space."));
-        pBlockTable->close();
-        return;
-    }
 
-    
     AcDbObjectId PushPullProp;
     AcDbObjectId PushPullKicker;
     AcDbObjectId BraceConnector = loadAsset(L"128294X");
@@ -804,26 +524,11 @@ void PlaceProps::placeProps() {
         }
     }
 
+    // Every part of every prop set goes in one batch, so a failed append rolls the command back
+    BlockBatch batch(_T("push pull prop"));
+    batch.reserve(wallPanels.size() * 6);
     for (const auto& panel : wallPanels) {
         
-		AcDbBlockReference* pBasePlate = new AcDbBlockReference();
-		AcDbBlockReference* pAnchor = new AcDbBlockReference();
-		AcDbBlockReference* pBraceConnectorTop = new AcDbBlockReference();
-		AcDbBlockReference* pBraceConnectorBottom = new AcDbBlockReference();
-		AcDbBlockReference* pPushPullProp = new AcDbBlockReference();
-		AcDbBlockReference* pPushPullKicker = new AcDbBlockReference();
-
-        
-        AcGeMatrix3d rotationMatrixXProp;
-		AcGeMatrix3d rotationMatrixYProp;
-		AcGeMatrix3d rotationMatrixZProp;
-
-		AcGeMatrix3d rotationMatrixXKicker;
-		AcGeMatrix3d rotationMatrixYKicker;
-		AcGeMatrix3d rotationMatrixZKicker;
-
-
-        
 		AcGePoint3d BasePlatecurrentPoint = panel.position;
 		AcGePoint3d AnchorcurrentPoint = panel.position;
 		AcGePoint3d BraceConnectorTopcurrentPoint = panel.position;
@@ -950,45 +655,15 @@ void PlaceProps::placeProps() {
         }
 
         
-		pBasePlate->setPosition(BasePlatecurrentPoint);
-		pBasePlate->setBlockTableRecord(BasePlate);
-		pBasePlate->setRotation(rotation - M_PI_2);
-		if (pModelSpace->appendAcDbEntity(pBasePlate) != Acad::eOk) {
-			acutPrintf(_T("\nFailed to append BasePlate reference."));
-		}
-		pBasePlate->close();
-
-        
-		pAnchor->setPosition(AnchorcurrentPoint);
-		pAnchor->setBlockTableRecord(Anchor);
-		pAnchor->setRotation(rotation - M_PI_2);
-		if (pModelSpace->appendAcDbEntity(pAnchor) != Acad::eOk) {
-			acutPrintf(_T("\nFailed to append Anchor reference."));
-		}
-		pAnchor->close();
-
-		
-		pBraceConnectorTop->setPosition(BraceConnectorTopcurrentPoint);
-		pBraceConnectorTop->setBlockTableRecord(BraceConnector);
-		pBraceConnectorTop->setRotation(rotation);
-		if (pModelSpace->appendAcDbEntity(pBraceConnectorTop) != Acad::eOk) {
-			acutPrintf(_T("\nFailed to append BraceConnectorTop reference."));
-		}
-		pBraceConnectorTop->close();
+		batch.add(BasePlate, BasePlatecurrentPoint, rotation - M_PI_2);
+		batch.add(Anchor, AnchorcurrentPoint, rotation - M_PI_2);
+		batch.add(BraceConnector, BraceConnectorTopcurrentPoint, rotation);
 
         if (globalVarHeight == 600 || globalVarHeight == 900 || globalVarHeight == 1200) {
             acutPrintf(_T("\n Second Brace Not required"));
         }
         else {
-            
-            pBraceConnectorBottom->setPosition(BraceConnectorBottomcurrentPoint);
-            pBraceConnectorBottom->setBlockTableRecord(BraceConnector);
-            pBraceConnectorBottom->setRotation(rotation);
-
-            if (pModelSpace->appendAcDbEntity(pBraceConnectorBottom) != Acad::eOk) {
-                acutPrintf(_T("\nFailed to append BraceConnectorBottom reference."));
-            }
-            pBraceConnectorBottom->close();
+            batch.add(BraceConnector, BraceConnectorBottomcurrentPoint, rotation);
 
             acutPrintf(_T("\n brace Placed"));
         }
@@ -997,38 +672,15 @@ void PlaceProps::placeProps() {
             acutPrintf(_T("\n Kicker Not required"));
         }
         else {
-            
-            pPushPullProp->setPosition(PushPullPropcurrentPoint);
-            pPushPullProp->setBlockTableRecord(PushPullProp);
-            rotationMatrixYProp.setToRotation(propAngle, AcGeVector3d::kYAxis, pPushPullProp->position());
-            rotationMatrixZProp.setToRotation(angleZProp, AcGeVector3d::kZAxis, pPushPullProp->position());
-            AcGeMatrix3d combinedRotationMatrixProp = rotationMatrixZProp * rotationMatrixYProp;
-
-            pPushPullProp->transformBy(combinedRotationMatrixProp);
-            if (pModelSpace->appendAcDbEntity(pPushPullProp) != Acad::eOk) {
-                acutPrintf(_T("\nFailed to append PushPullProp reference."));
-            }
-            pPushPullProp->close();
+            // Tilted about Y to the prop angle, then turned to face the wall
+            batch.add(PushPullProp, PushPullPropcurrentPoint, 0.0, propAngle, angleZProp);
 
             acutPrintf(_T("\n Prop Placed"));
         }
 
-            
-            pPushPullKicker->setPosition(PushPullKickercurrentPoint);
-            pPushPullKicker->setBlockTableRecord(PushPullKicker);
-            rotationMatrixYKicker.setToRotation(kickerAngle, AcGeVector3d::kYAxis, pPushPullKicker->position());
-            rotationMatrixZKicker.setToRotation(angleZKicker, AcGeVector3d::kZAxis, pPushPullKicker->position());
-            AcGeMatrix3d combinedRotationMatrixKicker = rotationMatrixZKicker * rotationMatrixYKicker;
-
-            pPushPullKicker->transformBy(combinedRotationMatrixKicker);
-            if (pModelSpace->appendAcDbEntity(pPushPullKicker) != Acad::eOk) {
-                acutPrintf(_T("\nFailed to append PushPullKicker reference."));
-            }
-            pPushPullKicker->close();
+            batch.add(PushPullKicker, PushPullKickercurrentPoint, 0.0, kickerAngle, angleZKicker);
 	}
-
-	pModelSpace->close();
-	pBlockTable->close();
+	batch.commit();
 
 
 }
\ No newline at end of file
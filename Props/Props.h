@@ -29,18 +29,4 @@ public:
 
 private:
 	static std::vector<AcGePoint3d> detectPolylines();
-
-	// Comparator for AcGePoint3d to be used in the map
-	struct Point3dComparator {
-		bool operator()(const AcGePoint3d& lhs, const AcGePoint3d& rhs) const {
-			if (lhs.x != rhs.x)
-				return lhs.x < rhs.x;
-			if (lhs.y != rhs.y)
-				return lhs.y < rhs.y;
-			return lhs.z < rhs.z;
-		}
-	};
-
-	// Static member to hold the wall mapping
-	static std::map<AcGePoint3d, std::vector<AcGePoint3d>, Point3dComparator> wallMap;
 };
@@ -2,7 +2,12 @@
 #include "StdAfx.h"
 #include "PlaceBracket-PP.h"
 #include "SharedDefinations.h"
+#include "Blocks/AssetRegistry.h"
+#include "Blocks/BlockBatch.h"
 #include "AssetPlacer/GeometryUtils.h"
+#include "AssetPlacer/PanelFillSolver.h"
+#include "AssetPlacer/StackingPlanner.h"
+#include "WallPanelConnectors/PanelIndex.h"
 #include <vector>
 #include <set>
 #include <cmath>
@@ -21,12 +26,7 @@
 #include "DefineHeight.h"
 #include "DefineScale.h" 
 #include <map>
-
-std::map<AcGePoint3d, std::vector<AcGePoint3d>, PlaceBracket::Point3dComparator> PlaceBracket::wallMap;
-
-const int BATCH_SIZE = 1000; 
-
-const double TOLERANCE = 0.1; 
+#include "Profiler.h"
 
 bool isIntegerPp(double value, double tolerance = 1e-9) {
     return std::abs(value - std::round(value)) < tolerance;
@@ -34,102 +34,14 @@ bool isIntegerPp(double value, double tolerance = 1e-9) {
 
 
 std::vector<AcGePoint3d> PlaceBracket::detectPolylines() {
+    Profiler::Phase phase("detect_polylines");
     
+    // Corners of the closed wall polylines, analysed once per drawing instead of per command
     std::vector<AcGePoint3d> corners;
-    wallMap.clear();  
-
-    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-    if (!pDb) {
+    if (!wallPolylineCorners(corners)) {
         acutPrintf(_T("\nNo working database found."));
-        return corners;
-    }
-
-    AcDbBlockTable* pBlockTable;
-    Acad::ErrorStatus es = pDb->getBlockTable(pBlockTable, AcDb::kForRead);
-    if (es != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get block table. Error status: %d\n"), es);
-        return corners;
-    }
-
-    AcDbBlockTableRecord* pModelSpace;
-    es = pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead);
-    if (es != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get model space. Error status: %d\n"), es);
-        pBlockTable->close();
-        return corners;
-    }
-
-    AcDbBlockTableRecordIterator* pIter;
-    es = pModelSpace->newIterator(pIter);
-    if (es != Acad::eOk) {
-        acutPrintf(_T("\nFailed to create iterator. Error status: %d\n"), es);
-        pModelSpace->close();
-        pBlockTable->close();
-        return corners;
-    }
-
-    int entityCount = 0;
-    for (pIter->start(); !pIter->done(); pIter->step()) {
-        AcDbEntity* pEnt;
-        es = pIter->getEntity(pEnt, AcDb::kForRead);
-        if (es == Acad::eOk) {
-            if (pEnt->isKindOf(AcDbPolyline::desc())) {
-                AcDbPolyline* pPolyline = AcDbPolyline::cast(pEnt);
-                if (pPolyline) {
-                    processPolyline(pPolyline, corners, 90.0, TOLERANCE);  
-                }
-            }
-            pEnt->close();
-            entityCount++;
-
-            if (entityCount % BATCH_SIZE == 0) {
-                acutPrintf(_T("\nProcessed %d entities. Pausing to avoid resource exhaustion.\n"), entityCount);
-                std::this_thread::sleep_for(std::chrono::seconds(1));  
-            }
-        }
-        else {
-            acutPrintf(_T("\nFailed to get entity. Error status: %d\n"), es);
-        }
     }
-
-    delete pIter;
-    pModelSpace->close();
-    pBlockTable->close();
-
-    
     return corners;
-
-}
-
-double crossProductPp(const AcGePoint3d& o, const AcGePoint3d& a, const AcGePoint3d& b) {
-    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
-}
-
-bool directionOfDrawingPp(std::vector<AcGePoint3d>& points) {
-    
-    if (!(points.front().x == points.back().x && points.front().y == points.back().y)) {
-        points.push_back(points.front());
-    }
-
-    double totalTurns = 0.0;
-
-    for (size_t i = 1; i < points.size() - 1; ++i) {
-        totalTurns += crossProductPp(points[i - 1], points[i], points[i + 1]);
-    }
-
-    
-    if (totalTurns < 0) {
-        return true;  
-    }
-    
-    else if (totalTurns > 0) {
-        return false; 
-    }
-    
-    else {
-        acutPrintf(_T("Warning: The shape does not have a defined direction. Defaulting to clockwise.\n"));
-        return true;  
-    }
 }
 
 struct BlockInfo2 {
@@ -147,72 +59,19 @@ struct BlockInfo2 {
 
 
 std::vector<std::tuple<AcGePoint3d, std::wstring, double>> PlaceBracket::getWallPanelPositions() {
-    std::vector<std::tuple<AcGePoint3d, std::wstring, double>> positions;
-
-    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-    if (!pDb) {
-        acutPrintf(_T("\nNo working database found."));
-        return positions;
-    }
-
-    AcDbBlockTable* pBlockTable;
-    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get block table."));
-        return positions;
-    }
-
-    AcDbBlockTableRecord* pModelSpace;
-    if (pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get model space."));
-        pBlockTable->close();
-        return positions;
-    }
-
-    AcDbBlockTableRecordIterator* pIter;
-    if (pModelSpace->newIterator(pIter) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to create iterator."));
-        pModelSpace->close();
-        pBlockTable->close();
-        return positions;
-    }
-
-    int entityCount = 0;
-    for (pIter->start(); !pIter->done(); pIter->step()) {
-        AcDbEntity* pEnt;
-        entityCount++;
-        if (pIter->getEntity(pEnt, AcDb::kForRead) == Acad::eOk) {
-            if (pEnt->isKindOf(AcDbBlockReference::desc())) {
-                AcDbBlockReference* pBlockRef = AcDbBlockReference::cast(pEnt);
-                if (pBlockRef) {
-                    AcDbObjectId blockId = pBlockRef->blockTableRecord();
-                    AcDbBlockTableRecord* pBlockDef;
-                    if (acdbOpenObject(pBlockDef, blockId, AcDb::kForRead) == Acad::eOk) {
-                        const wchar_t* blockName;
-                        pBlockDef->getName(blockName);
-                        std::wstring blockNameStr(blockName);
-                        blockNameStr = toUpperCase(blockNameStr);
-
-                        
-                        if (blockNameStr == ASSET_128292 || blockNameStr == ASSET_129884) {
-                            positions.emplace_back(pBlockRef->position(), blockNameStr, pBlockRef->rotation());
-                        }
-                        pBlockDef->close();
-                    }
-                }
-            }
-            pEnt->close();
-        }
-    }
-
-    delete pIter;
-    pModelSpace->close();
-    pBlockTable->close();
-
-    return positions;
+    // Through the panel index, so compensators inside panel stack blocks are found as well
+    PanelIndex index;
+    if (!index.build()) {
+        return {};
+    }
+    return index.positions([](const IndexedPanel& panel) {
+        return panel.name == ASSET_128292 || panel.name == ASSET_129884;
+    });
 }
 
 std::wstring getBlockName(AcDbObjectId blockId) {
     AcDbBlockTableRecord* pBlockRec = nullptr;
+    Profiler::count(ProfileCounter::ObjectsOpened);
     if (acdbOpenObject(pBlockRec, blockId, AcDb::kForRead) != Acad::eOk) {
         return L"";
     }
@@ -232,6 +91,7 @@ std::wstring getBlockName(AcDbObjectId blockId) {
 
 
 std::vector<BlockInfo2> getSelectedBlocksInfo() {
+    Profiler::Phase phase("block_selection");
     std::vector<BlockInfo2> blocksInfo;
 
     
@@ -261,6 +121,7 @@ std::vector<BlockInfo2> getSelectedBlocksInfo() {
         AcDbObjectId objId;
         acdbGetObjectId(objId, ent);
         AcDbEntity* pEnt = nullptr;
+        Profiler::count(ProfileCounter::ObjectsOpened);
         if (acdbOpenObject(pEnt, objId, AcDb::kForRead) != Acad::eOk) {
             acutPrintf(_T("\nFailed to open entity."));
             continue;
@@ -276,6 +137,7 @@ std::vector<BlockInfo2> getSelectedBlocksInfo() {
             
             AcDbObjectId blockTableRecordId = pBlockRef->blockTableRecord();
             AcDbBlockTableRecord* pBlockTableRecord = nullptr;
+            Profiler::count(ProfileCounter::ObjectsOpened);
             if (acdbOpenObject(pBlockTableRecord, blockTableRecordId, AcDb::kForRead) == Acad::eOk) {
                 info.blockName = getBlockName(pBlockRef->blockTableRecord());
                 pBlockTableRecord->close();
@@ -306,27 +168,11 @@ std::vector<BlockInfo2> getSelectedBlocksInfo() {
 
 
 AcDbObjectId PlaceBracket::loadAsset(const wchar_t* blockName) {
-    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-    if (!pDb) {
-        acutPrintf(_T("\nNo working database found."));
-        return AcDbObjectId::kNull;
-    }
-
-    AcDbBlockTable* pBlockTable;
-    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get block table."));
-        return AcDbObjectId::kNull;
-    }
-
-    AcDbObjectId assetId;
-    if (pBlockTable->getAt(blockName, assetId) != Acad::eOk) {
+    AcDbObjectId blockId = AssetRegistry::resolve(blockName);
+    if (blockId.isNull()) {
         acutPrintf(_T("\nFailed to get block table record for block '%s'."), blockName);
-        pBlockTable->close();
-        return AcDbObjectId::kNull;
     }
-
-    pBlockTable->close();
-    return assetId;
+    return blockId;
 }
 
 
@@ -372,42 +218,16 @@ AcDbObjectId PlaceBracket::loadAsset(const wchar_t* blockName) {
 
 
 
-void PlaceBracket::placeAsset(const AcGePoint3d& position, const wchar_t* blockName, double rotation, double scale) {
-    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-    AcDbBlockTable* pBlockTable;
-    AcDbBlockTableRecord* pModelSpace;
-
-    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get block table."));
-        return;
-    }
-    if (pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForWrite) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get model space."));
-        pBlockTable->close();
-        return;
-    }
-
+void PlaceBracket::placeAsset(const AcGePoint3d& position, const wchar_t* blockName, double rotation) {
     AcDbObjectId assetId = loadAsset(blockName);
     if (assetId == AcDbObjectId::kNull) {
         acutPrintf(_T("\nFailed to load asset."));
-        pModelSpace->close();
-        pBlockTable->close();
         return;
     }
 
-    AcDbBlockReference* pBlockRef = new AcDbBlockReference();
-    pBlockRef->setPosition(position);
-    pBlockRef->setBlockTableRecord(assetId);
-    pBlockRef->setRotation(rotation);
-    pBlockRef->setScaleFactors(AcGeScale3d(scale));  
-
-    if (pModelSpace->appendAcDbEntity(pBlockRef) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to append block reference."));
-    }
-    pBlockRef->close();
-
-    pModelSpace->close();
-    pBlockTable->close();
+    BlockBatch batch(_T("bracket"));
+    batch.add(assetId, position, rotation);
+    batch.commit();
 }
 
 
@@ -419,46 +239,6 @@ void PlaceBracket::placeBrackets() {
         return;
     }
 
-    int closeLoopCounter = -1;
-    int loopIndex = 0;
-    double outerPointCounter = corners[0].x;
-    int outerLoopIndexValue = 0;
-    int firstLoopEnd;
-
-    
-    for (size_t cornerNum = 0; cornerNum < corners.size(); ++cornerNum) {
-        closeLoopCounter++;
-        AcGePoint3d start = corners[cornerNum];
-        AcGePoint3d end = corners[(cornerNum + 1) % corners.size()];  
-        AcGeVector3d direction = (end - start).normal();
-
-        if (start.x > outerPointCounter) {
-            outerPointCounter = start.x;
-            outerLoopIndexValue = loopIndex;
-        }
-
-        if (!isIntegerPp(direction.x) || !isIntegerPp(direction.y)) {
-            if (cornerNum < corners.size() - 1) {
-                closeLoopCounter = -1;
-                loopIndex = 1;
-                firstLoopEnd = static_cast<int>(cornerNum);
-            }
-        }
-    }
-
-    
-    
-    
-    if (outerLoopIndexValue == 0) {
-        std::vector<AcGePoint3d> firstLoop(corners.begin(), corners.begin() + firstLoopEnd + 1);
-        bool firstLoopIsClockwise = directionOfDrawingPp(firstLoop);
-    }
-    else if (outerLoopIndexValue == 1) {
-        std::vector<AcGePoint3d> firstLoop(corners.begin() + firstLoopEnd + 1, corners.end());
-        bool firstLoopIsClockwise = directionOfDrawingPp(firstLoop);
-    }
-    
-
     std::vector<BlockInfo2> blocksInfo = getSelectedBlocksInfo();
     if (blocksInfo.empty()) {
         acutPrintf(_T("\nNo block references selected."));
@@ -502,24 +282,8 @@ void PlaceBracket::placeBrackets() {
     int wallHeight = globalVarHeight;
     int panelHeights[] = { 1350, 1200, 600 };
 
-    int numHeights = 3;
-
-    int maxHeight = 0;
-
-    
-    for (int i = 0; i < (1 << numHeights); ++i) {
-        int currentHeight = 0;
-        for (int j = 0; j < numHeights; ++j) {
-            if (i & (1 << j)) {
-                currentHeight += panelHeights[j];
-            }
-        }
-        if (currentHeight <= wallHeight && currentHeight > maxHeight) {
-            maxHeight = currentHeight;
-        }
-    }
-    
-    
+    // Top of the tallest panel column the wall height allows
+    int maxHeight = StackingPlanner::column(wallHeight, std::vector<int>(std::begin(panelHeights), std::end(panelHeights))).totalHeight;
 
     
     struct Panel {
@@ -555,103 +319,34 @@ void PlaceBracket::placeBrackets() {
     double panelLength;
     
     
+    std::vector<AcDbObjectId> rowAssets;
+    std::vector<int> fillWidths;
     for (const auto& panel : panelSizes) {
-
         for (int panelNum = 0; panelNum < 3; panelNum++) {
             AcDbObjectId assetId = loadAsset(panel.id[panelNum].c_str());
-
             if (assetId != AcDbObjectId::kNull) {
-                int numPanels = static_cast<int>(distance / panel.length);
-                if (numPanels != 0) {
-                    for (int i = 0; i < numPanels; i++) {
-
-                        panelLength = panel.length;
-                        wallPanels.push_back({ currentPoint, assetId, rotation, panelLength});
-
-                        currentPoint += direction * panelLength;
-                        distance -= panelLength;
-                    }
-                }
+                rowAssets.push_back(assetId);
+                fillWidths.push_back(panel.length);
+                break;
             }
         }
     }
-    
-    
-    std::vector<AcDbObjectId> centerAssets = {
-        loadAsset(L"128285X"),
-        loadAsset(L"129842X"),
-        loadAsset(L"129879X"),
-        loadAsset(L"129884X"),
-        loadAsset(L"128287X"),
-        loadAsset(L"128292X")
-    };
-
-    int prevStartCornerIndex = -1;
-    int movedCompensators = 0;
-
-    for (int panelNum = 0; panelNum < wallPanels.size(); ++panelNum) {
-        WallPanel& panel = wallPanels[panelNum];
-        if (std::find(centerAssets.begin(), centerAssets.end(), panel.assetId) != centerAssets.end()) {
-
-            
-            int panelPosition = panelNum;
-            WallPanel detectedPanel = wallPanels[panelPosition];
-            AcGePoint3d detectedPanelPosition = detectedPanel.position;
-            AcDbObjectId detectedPanelId = detectedPanel.assetId;
 
-            double panelLength = wallPanels[panelPosition].length;
-
-            
-            int centerIndex = static_cast<int>(wallPanels.size() / 2);
-
-            
-            AcGePoint3d centerPanelPosition = wallPanels[centerIndex + movedCompensators].position;
-
-            AcGeVector3d direction = (wallPanels[panelNum].position - wallPanels[centerIndex].position).normal();
-
-            
-            wallPanels[panelNum].position = centerPanelPosition;
-
-            for (int centerToCornerPanelNum = centerIndex + movedCompensators; centerToCornerPanelNum < panelNum - movedCompensators; centerToCornerPanelNum++) {
-                wallPanels[centerToCornerPanelNum].position = wallPanels[centerToCornerPanelNum].position + direction * panelLength;
-            }
-
-            movedCompensators++;
-            
+    
+    PanelFillSolver& panelFill = PanelFillSolver::shared(fillWidths);
+    std::vector<int> panelOrder;
+    panelFill.arrange(panelFill.solve(distance), panelOrder);
+    for (int rowNum : panelOrder) {
+        panelLength = fillWidths[rowNum];
+
+        // Compensators are gathered in the middle of the run and carry no brackets
+        if (!panelFill.isCompensator(rowNum)) {
+            wallPanels.push_back({ currentPoint, rowAssets[rowNum], rotation, panelLength });
         }
+        currentPoint += direction * panelLength;
+        distance -= panelLength;
     }
-
-    wallPanels.erase(
-        std::remove_if(
-            wallPanels.begin(),
-            wallPanels.end(),
-            [&centerAssets](const WallPanel& panel) {
-                return std::find(centerAssets.begin(), centerAssets.end(), panel.assetId) != centerAssets.end();
-            }
-        ),
-        wallPanels.end()
-    );
-    
-
     
-    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
-    if (!pDb) {
-        acutPrintf(_T("\nNo working database found."));
-        return;
-    }
-
-    AcDbBlockTable* pBlockTable;
-    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get block table."));
-        return;
-    }
-
-    AcDbBlockTableRecord* pModelSpace;
-    if (pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForWrite) != Acad::eOk) {
-        acutPrintf(_T("\nFailed to get model space."));
-        pBlockTable->close();
-        return;
-    }
 
     AcDbObjectId bracketId = loadAsset(L"128257X");
     AcDbObjectId ppId = loadAsset(L"117325X");
@@ -660,11 +355,12 @@ void PlaceBracket::placeBrackets() {
     double bracketXOffset = 75;
     double bracketYOffset = 50;
     double ppYOffset = 826.75;
+    BlockBatch batch(_T("bracket"));
+    batch.reserve(wallPanels.size() * 2);
     for (const auto& panel : wallPanels) {
-        AcDbBlockReference* pBlockRef = new AcDbBlockReference();
-        AcDbBlockReference* pBlockRefPp = new AcDbBlockReference();
-        AcGeMatrix3d rotationMatrixX;
-        AcGeMatrix3d rotationMatrixZ;
+        // Push pull prop stood up about X, then turned to face the wall about Z
+        double ppRotationX = 0.0;
+        double ppRotationZ = 0.0;
         AcGePoint3d currentPoint = panel.position;
         AcGePoint3d currentPointPP = panel.position;
         currentPoint.z = maxHeight;
@@ -675,23 +371,23 @@ void PlaceBracket::placeBrackets() {
             currentPoint.y -= bracketYOffset;
             currentPointPP.x += (panel.length - bracketXOffset);
             currentPointPP.y -= ppYOffset;
-            rotationMatrixX = AcGeMatrix3d::rotation(M_PI_2, AcGeVector3d::kXAxis, currentPoint);
-            rotationMatrixZ = AcGeMatrix3d::rotation(M_PI_2*3, AcGeVector3d::kYAxis, currentPoint);
+            ppRotationX = M_PI_2;
+            ppRotationZ = M_PI_2 * 3;
             break;
         case 1: 
             currentPoint.x += bracketYOffset;
             currentPoint.y += (panel.length - bracketXOffset);
             currentPointPP.x += ppYOffset;
             currentPointPP.y += (panel.length - bracketXOffset);
-            rotationMatrixX = AcGeMatrix3d::rotation(M_PI_2, AcGeVector3d::kXAxis, currentPoint);
+            ppRotationX = M_PI_2;
             break;
         case 2: 
             currentPoint.x -= (panel.length - bracketXOffset);
             currentPoint.y += bracketYOffset;
             currentPointPP.x -= (panel.length - bracketXOffset);
             currentPointPP.y += ppYOffset;
-            rotationMatrixX = AcGeMatrix3d::rotation(M_PI_2, AcGeVector3d::kXAxis, currentPoint);
-            rotationMatrixZ = AcGeMatrix3d::rotation(M_PI_2, AcGeVector3d::kYAxis, currentPoint);
+            ppRotationX = M_PI_2;
+            ppRotationZ = M_PI_2;
             break;
             break;
         case 3: 
@@ -699,42 +395,15 @@ void PlaceBracket::placeBrackets() {
             currentPoint.y -= (panel.length - bracketXOffset);
             currentPointPP.x -= ppYOffset;
             currentPointPP.y -= (panel.length - bracketXOffset);
-            rotationMatrixX = AcGeMatrix3d::rotation(M_PI_2, AcGeVector3d::kXAxis, currentPoint);
-            rotationMatrixZ = AcGeMatrix3d::rotation(M_PI, AcGeVector3d::kYAxis, currentPoint);
+            ppRotationX = M_PI_2;
+            ppRotationZ = M_PI;
             break;
         case -1:
             break;
         }
-        pBlockRef->setPosition(currentPoint);
-        pBlockRef->setBlockTableRecord(bracketId);
-        pBlockRef->setRotation(rotation);  
-        pBlockRef->setScaleFactors(AcGeScale3d(globalVarScale));  
-
-        if (pModelSpace->appendAcDbEntity(pBlockRef) == Acad::eOk) {
-            
-        }
-        else {
-            acutPrintf(_T("\nFailed to place bracket."));
-        }
-        pBlockRef->close();  
-
-        AcGeMatrix3d combinedRotationMatrix = rotationMatrixX * rotationMatrixZ;
-
-        pBlockRefPp->transformBy(combinedRotationMatrix);
-        pBlockRefPp->setPosition(currentPointPP);
-        pBlockRefPp->setBlockTableRecord(ppId);
-        
-        pBlockRefPp->setScaleFactors(AcGeScale3d(globalVarScale));  
-
-        if (pModelSpace->appendAcDbEntity(pBlockRefPp) == Acad::eOk) {
-            
-        }
-        else {
-            acutPrintf(_T("\nFailed to place bracket."));
-        }
-        pBlockRefPp->close();  
+        batch.add(bracketId, currentPoint, rotation);
+        // Rx(90) * Ry(a) is Rz(a) * Rx(90): the batch's X then Z rotation
+        batch.add(ppId, currentPointPP, ppRotationX, 0.0, ppRotationZ);
     }
-
-    pModelSpace->close();
-    pBlockTable->close();
+    batch.commit();
 }
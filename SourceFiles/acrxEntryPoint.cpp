@@ -4,6 +4,7 @@
 #include <Windows.h>
 #include <Shlwapi.h>
 #include <fstream>
+#include <sstream>
 #include <iostream>
 #include <string>
 #include <thread>
@@ -18,11 +19,21 @@
 #include "BrxSpecific/ribbon/AcRibbonPanel.h"       
 #include "BrxSpecific/ribbon/AcRibbonButton.h"      
 #include "Blocks/BlockLoader.h"                     
+#include "Blocks/AssetRegistry.h"
+#include "Blocks/CommandTransaction.h"
+#include "Blocks/PanelStack.h"
 #include "WallPanelConnectors/WallPanelConnector.h" 
 #include "WallPanelConnectors/StackedWallPanelConnector.h" 
 #include "WallPanelConnectors/Stacked15PanelConnector.h"   
 #include "WallPanelConnectors/WalerConnector.h"     
+#include "WallPanelConnectors/PanelIndex.h"
+#include "AssetPlacer/LayoutDriver.h"
+#include "AssetPlacer/LayoutCache.h"
+#include "AssetPlacer/SegmentWatch.h"
+#include "AssetPlacer/PlanGenerator.h"
+#include "CommandProfile.h"
 #include "Props/props.h"
+#include "Tie/TieAssembly.h"
 #include "Tie/TiePlacer.h" 				            
 #include "DefineHeight.h"                           
 #include "DefineScale.h"                            
@@ -138,7 +149,7 @@ public:
         
         acedRegCmds->addCommand(_T("BRXAPP"), _T("PlaceWalls"), _T("PlaceWalls"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppPlaceWalls(); });
         acedRegCmds->addCommand(_T("BRXAPP"), _T("PlaceConnectors"), _T("PlaceConnectors"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppPlaceConnectors(); });
-        acedRegCmds->addCommand(_T("BRXAPP"), _T("PlaceTies"), _T("PlaceTies"), ACRX_CMD_MODAL, []() { TiePlacer::placeTies(); });
+        acedRegCmds->addCommand(_T("BRXAPP"), _T("PlaceTies"), _T("PlaceTies"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppPlaceTies(); });
         acedRegCmds->addCommand(_T("BRXAPP"), _T("PlaceColumns"), _T("PlaceColumns"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppPlaceColumns(); });
         acedRegCmds->addCommand(_T("BRXAPP"), _T("ExtractColumn"), _T("ExtractColumn"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppExtractColumn(); });
         acedRegCmds->addCommand(_T("BRXAPP"), _T("DefineHeight"), _T("DefineHeight"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppDefineHeight(); });
@@ -149,6 +160,12 @@ public:
         acedRegCmds->addCommand(_T("BRXAPP"), _T("PlaceProps"), _T("PlaceProps"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppPlacePushPullProps(); });
         acedRegCmds->addCommand(_T("BRXAPP"), _T("PlaceInsideCorners"), _T("PlaceInsideCorners"), ACRX_CMD_MODAL, []() { CBrxApp::BrxPlaceInsideCorners(); });
 		acedRegCmds->addCommand(_T("BRXAPP"), _T("PlaceOutsideCorners"), _T("PlaceOutsideCorners"), ACRX_CMD_MODAL, []() { CBrxApp::BrxPlaceOutsideCorners(); });
+        acedRegCmds->addCommand(_T("BRXAPP"), _T("PeriLayoutReport"), _T("PeriLayoutReport"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppLayoutReport(); });
+        acedRegCmds->addCommand(_T("BRXAPP"), _T("PeriBenchmark"), _T("PeriBenchmark"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppBenchmark(); });
+        acedRegCmds->addCommand(_T("BRXAPP"), _T("PeriProfile"), _T("PeriProfile"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppProfile(); });
+        acedRegCmds->addCommand(_T("BRXAPP"), _T("PeriTieAssembly"), _T("PeriTieAssembly"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppTieAssembly(); });
+        acedRegCmds->addCommand(_T("BRXAPP"), _T("PeriPanelStacks"), _T("PeriPanelStacks"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppPanelStacks(); });
+        acedRegCmds->addCommand(_T("BRXAPP"), _T("PeriUpdate"), _T("PeriUpdate"), ACRX_CMD_MODAL, []() { CBrxApp::BrxAppUpdate(); });
       
         BlockLoader::loadBlocksFromJson(); 
 
@@ -159,6 +176,9 @@ public:
     {
         acedRegCmds->removeGroup(_T("BRXAPP")); 
         SettingsCommands::unloadApp(); 
+        AssetRegistry::shutdown();
+        LayoutCache::shutdown();
+        SegmentWatch::shutdown();
         return AcRxArxApp::On_kUnloadAppMsg(pAppData);
     }
 
@@ -181,6 +201,9 @@ public:
     static void BrxPlaceInsideCorners(void)
     {
         acutPrintf(_T("\nRunning PlaceInsideCorners."));
+        CommandProfile profile("PlaceInsideCorners");
+        AssetRegistry::CommandScope assetScope(_T("PlaceInsideCorners"));
+        CommandTransaction transaction(_T("PlaceInsideCorners"));
         InsideCorner::placeAssetsAtCorners();
     }
 
@@ -188,6 +211,9 @@ public:
 	static void BrxPlaceOutsideCorners(void)
 	{
 		acutPrintf(_T("\nRunning PlaceOutsideCorners."));
+		CommandProfile profile("PlaceOutsideCorners");
+		AssetRegistry::CommandScope assetScope(_T("PlaceOutsideCorners"));
+		CommandTransaction transaction(_T("PlaceOutsideCorners"));
 		OutsideCorner::placeAssetsAtCorners();
 	}
 
@@ -195,6 +221,9 @@ public:
     static void BrxAppPlaceBrackets(void)
 	{
 		acutPrintf(_T("\nRunning PlaceBrackets."));
+		CommandProfile profile("PlaceBrackets");
+        AssetRegistry::CommandScope assetScope(_T("PlaceBrackets"));
+        CommandTransaction transaction(_T("PlaceBrackets"));
         PlaceBracket::placeBrackets();
 	}
 
@@ -202,6 +231,9 @@ public:
     static void BrxAppPlacePushPullProps(void)
     {
         acutPrintf(_T("\nRunning PlaceProps."));
+        CommandProfile profile("PlaceProps");
+        AssetRegistry::CommandScope assetScope(_T("PlaceProps"));
+        CommandTransaction transaction(_T("PlaceProps"));
         PlaceProps::placeProps();
     }
 
@@ -209,6 +241,9 @@ public:
     static void BrxAppPlaceCorners(void)
     {
         acutPrintf(_T("\nRunning PlaceCorners."));
+        CommandProfile profile("PlaceCorners");
+        AssetRegistry::CommandScope assetScope(_T("PlaceCorners"));
+        CommandTransaction transaction(_T("PlaceCorners"));
         CornerAssetPlacer::placeAssetsAtCorners();
     }
 
@@ -216,17 +251,49 @@ public:
     static void BrxAppPlaceWalls(void)
     {
         acutPrintf(_T("\nRunning PlaceWalls."));
+        CommandProfile profile("PlaceWalls");
+        AssetRegistry::CommandScope assetScope(_T("PlaceWalls"));
+        CommandTransaction transaction(_T("PlaceWalls"));
         WallPlacer::placeWalls();
     }
 
      
+    static void BrxAppUpdate(void)
+    {
+        acutPrintf(_T("\nRunning PeriUpdate."));
+        CommandProfile profile("PeriUpdate");
+        AssetRegistry::CommandScope assetScope(_T("PeriUpdate"));
+        CommandTransaction transaction(_T("PeriUpdate"));
+        WallPlacer::updateWalls();
+    }
+
+
     static void BrxAppPlaceConnectors(void)
     {
         acutPrintf(_T("\nRunning PlaceConnectors."));
-        WallPanelConnector::placeConnectors();
-        StackedWallPanelConnectors::placeStackedWallConnectors();
-        Stacked15PanelConnector::place15panelConnectors();
-        WalerConnector::placeConnectors();
+        CommandProfile profile("PlaceConnectors");
+        AssetRegistry::CommandScope assetScope(_T("PlaceConnectors"));
+        CommandTransaction transaction(_T("PlaceConnectors"));
+        PanelIndex panelIndex;
+        if (!panelIndex.build()) {
+            return;
+        }
+        {
+            Profiler::Phase phase("wall_panel_connectors");
+            WallPanelConnector::placeConnectors(panelIndex);
+        }
+        {
+            Profiler::Phase phase("stacked_panel_connectors");
+            StackedWallPanelConnectors::placeStackedWallConnectors(panelIndex);
+        }
+        {
+            Profiler::Phase phase("stacked_15_connectors");
+            Stacked15PanelConnector::place15panelConnectors(panelIndex);
+        }
+        {
+            Profiler::Phase phase("waler_connectors");
+            WalerConnector::placeConnectors(panelIndex);
+        }
         acutPrintf(_T("\nConnectors placed."));
     }
 
@@ -234,6 +301,9 @@ public:
     static void BrxAppPlaceTies(void)
 	{
 		acutPrintf(_T("\nRunning PlaceTies."));
+		CommandProfile profile("PlaceTies");
+		AssetRegistry::CommandScope assetScope(_T("PlaceTies"));
+		CommandTransaction transaction(_T("PlaceTies"));
 		TiePlacer::placeTies();
 	}
 
@@ -241,6 +311,8 @@ public:
     static void BrxAppPlaceColumns(void)
 	{
 		acutPrintf(_T("\nRunning PlaceColumns."));
+		CommandProfile profile("PlaceColumns");
+		CommandTransaction transaction(_T("PlaceColumns"));
         GetUserNameA(username, &username_len);
 
         
@@ -254,6 +326,7 @@ public:
     static void BrxAppExtractColumn(void)
 	{
 		acutPrintf(_T("\nRunning ExtractColumn."));
+		CommandProfile profile("ExtractColumn");
         ExtractColumn();
 	}
 
@@ -261,13 +334,187 @@ public:
     static void BrxAppLoadBlocks(void)
     {
         acutPrintf(_T("\n Loading Blocks....."));
+        CommandProfile profile("LoadBlocks");
         BlockLoader::loadBlocksFromJson();
     }
 
     
+    static void BrxAppLayoutReport(void)
+    {
+        acutPrintf(_T("\nRunning PeriLayoutReport."));
+        CommandProfile profile("PeriLayoutReport");
+        ACHAR planPath[MAX_PATH];
+        if (acedGetString(Adesk::kTrue, _T("\nEnter the plan file path: "), planPath) != RTNORM) {
+            acutPrintf(_T("\nOperation canceled."));
+            return;
+        }
+
+        std::ifstream planFile(planPath);
+        if (!planFile.is_open()) {
+            acutPrintf(_T("\nFailed to open the plan file."));
+            return;
+        }
+
+        PlanInput plan;
+        plan.wallHeight = globalVarHeight;
+        std::string error;
+        if (!LayoutDriver::readPlan(planFile, plan, error)) {
+            acutPrintf(_T("\nFailed to read the plan file: %hs"), error.c_str());
+            return;
+        }
+
+        LayoutPlan layout;
+        LayoutRunReport report = LayoutDriver::run(plan, layout);
+        acutPrintf(_T("\nLoops: %d (%d outer), corners: %d"), static_cast<int>(report.loops), static_cast<int>(report.outerLoops), static_cast<int>(report.corners));
+        acutPrintf(_T("\nWall panels: %d, stacked panels: %d, ties: %d"), static_cast<int>(report.wallPanels), static_cast<int>(report.stackedPanels), static_cast<int>(report.ties));
+        acutPrintf(_T("\nHierarchy: %.2f ms, layout: %.2f ms, ties: %.2f ms"), report.hierarchyMs, report.layoutMs, report.tieMs);
+    }
+
+    
+    static void BrxAppBenchmark(void)
+    {
+        acutPrintf(_T("\nRunning PeriBenchmark."));
+        CommandProfile profile("PeriBenchmark");
+        int seed = 1;
+        int status = acedGetInt(_T("\nEnter the plan seed <1>: "), &seed);
+        if (status != RTNORM && status != RTNONE) {
+            acutPrintf(_T("\nOperation canceled."));
+            return;
+        }
+
+        int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+        status = acedGetInt(_T("\nEnter the maximum thread count <all cores>: "), &maxThreads);
+        if (status != RTNORM && status != RTNONE) {
+            acutPrintf(_T("\nOperation canceled."));
+            return;
+        }
+
+        // 1, 2, 4, ... up to the maximum, for the scaling curve of the wall layout
+        std::vector<unsigned> threadCounts;
+        for (int threads = 1; threads < maxThreads; threads *= 2) {
+            threadCounts.push_back(static_cast<unsigned>(threads));
+        }
+        threadCounts.push_back(static_cast<unsigned>(maxThreads > 1 ? maxThreads : 1));
+
+        ACHAR csvPath[MAX_PATH];
+        if (acedGetString(Adesk::kTrue, _T("\nEnter the CSV output path: "), csvPath) != RTNORM) {
+            acutPrintf(_T("\nOperation canceled."));
+            return;
+        }
+
+        std::ofstream csvFile(csvPath);
+        if (!csvFile.is_open()) {
+            acutPrintf(_T("\nFailed to open the CSV file."));
+            return;
+        }
+
+        PlanGenerator generator(static_cast<unsigned>(seed));
+        LayoutDriver::benchmark(generator.standardSuite(), static_cast<unsigned>(seed), threadCounts, csvFile);
+        acutPrintf(_T("\nBenchmark written to %s"), csvPath);
+    }
+
+    
+    static void BrxAppProfile(void)
+    {
+        const ProfileRun& run = Profiler::lastRun();
+        if (run.command.empty()) {
+            acutPrintf(_T("\nNo profiled command has run yet."));
+            return;
+        }
+
+        std::ostringstream summary;
+        Profiler::writeSummary(run, summary);
+        std::istringstream lines(summary.str());
+        std::string line;
+        while (std::getline(lines, line)) {
+            acutPrintf(_T("\n%hs"), line.c_str());
+        }
+
+        ACHAR writeTrace[256];
+        if (acedGetString(Adesk::kFalse, _T("\nWrite a Chrome trace file? [Y/N] Default: N "), writeTrace) != RTNORM) {
+            return;
+        }
+        if (wcscmp(writeTrace, _T("Y")) != 0 && wcscmp(writeTrace, _T("y")) != 0) {
+            return;
+        }
+
+        ACHAR tracePath[MAX_PATH];
+        if (acedGetString(Adesk::kTrue, _T("\nEnter the trace output path (.json): "), tracePath) != RTNORM) {
+            acutPrintf(_T("\nOperation canceled."));
+            return;
+        }
+
+        std::ofstream traceFile(tracePath);
+        if (!traceFile.is_open()) {
+            acutPrintf(_T("\nFailed to open the trace file."));
+            return;
+        }
+        Profiler::writeChromeTrace(run, traceFile);
+        acutPrintf(_T("\nTrace written to %s"), tracePath);
+    }
+
+    
+    static void BrxAppTieAssembly(void)
+    {
+        acutPrintf(_T("\nRunning PeriTieAssembly."));
+        CommandProfile profile("PeriTieAssembly");
+        AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
+        acutPrintf(_T("\nTie assemblies are %s for this drawing."), TieAssembly::enabled(pDb) ? _T("on") : _T("off"));
+
+        int option = 1;
+        int status = acedGetInt(_T("\nSelect an option [1-Assemblies/2-Separate ties/3-Explode placed assemblies] <1>: "), &option);
+        if (status != RTNORM && status != RTNONE) {
+            acutPrintf(_T("\nOperation canceled."));
+            return;
+        }
+
+        if (option == 3) {
+            CommandTransaction transaction(_T("PeriTieAssembly"));
+            int exploded = TieAssembly::explodeAll(pDb);
+            if (exploded < 0) {
+                CommandTransaction::fail();
+                return;
+            }
+            acutPrintf(_T("\nExploded %d tie assemblies."), exploded);
+            option = 2;
+        }
+        if (option != 1 && option != 2) {
+            acutPrintf(_T("\nInvalid option selected."));
+            return;
+        }
+        if (TieAssembly::setEnabled(pDb, option == 1)) {
+            acutPrintf(_T("\nPlaceTies will place %s."), option == 1 ? _T("one assembly per tie") : _T("separate ties and wingnuts"));
+        }
+    }
+
+    
+    static void BrxAppPanelStacks(void)
+    {
+        acutPrintf(_T("\nRunning PeriPanelStacks."));
+        CommandProfile profile("PeriPanelStacks");
+        AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
+        acutPrintf(_T("\nPanel stack blocks are %s for this drawing."), PanelStack::enabled(pDb) ? _T("on") : _T("off"));
+
+        int option = 1;
+        int status = acedGetInt(_T("\nSelect an option [1-Stack blocks/2-Separate panels] <1>: "), &option);
+        if (status != RTNORM && status != RTNONE) {
+            acutPrintf(_T("\nOperation canceled."));
+            return;
+        }
+        if (option != 1 && option != 2) {
+            acutPrintf(_T("\nInvalid option selected."));
+            return;
+        }
+        if (PanelStack::setEnabled(pDb, option == 1)) {
+            acutPrintf(_T("\nPlaceWalls will place %s."), option == 1 ? _T("one stack block per panel column") : _T("every panel separately"));
+        }
+    }
+
+    
     static void BrxAppDefineHeight(void)
     {
         acutPrintf(_T("\nDefining Height..."));
+        CommandProfile profile("DefineHeight");
         DefineHeight::defineHeight();
     }
 
@@ -275,6 +522,7 @@ public:
     static void BrxAppDefineScale(void)
     {
         acutPrintf(_T("\nRunning DefineScale."));
+        CommandProfile profile("DefineScale");
         
         DefineScale::defineScale();
     }
@@ -298,6 +546,12 @@ public:
         acutPrintf(_T("\nDoAll: only for testing purposes, NOT IMPLEMENTED"));
         acutPrintf(_T("\nListCMDS: Prints this Menu"));
         acutPrintf(_T("\nPeriSettings: Settings"));
+        acutPrintf(_T("\nPeriLayoutReport: Runs the wall layout on a plan text file and prints counts and timings, without drawing."));
+        acutPrintf(_T("\nPeriBenchmark: Times the layout stages on generated plans for 1 up to N threads and writes a CSV report."));
+        acutPrintf(_T("\nPeriProfile: Prints the phase timings and counters of the last command, optionally as a Chrome trace."));
+        acutPrintf(_T("\nPeriTieAssembly: Places ties as one block with their wingnuts, or as separate blocks; can explode placed assemblies."));
+        acutPrintf(_T("\nPeriPanelStacks: Places each column of stacked wall panels as one block, or every panel separately."));
+        acutPrintf(_T("\nPeriUpdate: Replaces only the wall panels of polyline edges edited since PlaceWalls. Ties, corner assets and connectors are not updated; rerun PlaceTies, the corner commands and PlaceConnectors."));
     }
 
     
@@ -0,0 +1,218 @@
+// BatchCommitTest.cpp
+// Commit and rollback rules of the block batches against a mock transaction manager that
+// keeps nested transactions and the entities appended in each, the stub database of the
+// headless driver, and commit throughput.
+#include "TestCheck.h"
+#include "Blocks/BatchCommit.h"
+#include "Blocks/StubDatabase.h"
+#include <chrono>
+#include <vector>
+
+// Nested transactions as a stack of appended entity numbers; ending one hands its entities to
+// the enclosing transaction, or to the drawing at the outermost level
+class MockTransactions : public TransactionPort {
+public:
+    bool start() override {
+        if (failStart) {
+            return false;
+        }
+        open.push_back(std::vector<int>());
+        starts++;
+        return true;
+    }
+
+    void end() override {
+        std::vector<int> appended = open.back();
+        open.pop_back();
+        std::vector<int>& target = open.empty() ? drawing : open.back();
+        target.insert(target.end(), appended.begin(), appended.end());
+        ends++;
+    }
+
+    void abort() override {
+        open.pop_back();
+        aborts++;
+    }
+
+    std::vector<std::vector<int>> open;
+    std::vector<int> drawing;
+    bool failStart = false;
+    int starts = 0;
+    int ends = 0;
+    int aborts = 0;
+};
+
+
+// Entities numbered from `first`; the append of entity `failAt` fails
+class MockEntities : public BatchEntities {
+public:
+    MockEntities(MockTransactions& transactions, int first, size_t count, size_t failAt = static_cast<size_t>(-1))
+        : transactions(transactions), first(first), failAt(failAt), appended(count, 0), discarded(count, 0) {
+    }
+
+    bool append(size_t index) override {
+        if (index == failAt || transactions.open.empty()) {
+            return false;
+        }
+        transactions.open.back().push_back(first + static_cast<int>(index));
+        appended[index]++;
+        return true;
+    }
+
+    void discard(size_t index) override {
+        discarded[index]++;
+    }
+
+    // Every entity appended or freed exactly once
+    bool accountedFor() const {
+        for (size_t i = 0; i < appended.size(); ++i) {
+            if (appended[i] + discarded[i] != 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    MockTransactions& transactions;
+    int first;
+    size_t failAt;
+    std::vector<int> appended;
+    std::vector<int> discarded;
+};
+
+
+static void checkCommandCommits() {
+    MockTransactions transactions;
+    {
+        CommandRollback command(transactions);
+        CHECK(command.started() && CommandRollback::active());
+        MockEntities walls(transactions, 0, 5);
+        MockEntities connectors(transactions, 100, 3);
+        CHECK(BatchCommit::commit(transactions, walls, 5));
+        CHECK(BatchCommit::commit(transactions, connectors, 3));
+        CHECK(walls.accountedFor() && connectors.accountedFor());
+        CHECK(transactions.drawing.empty());
+    }
+    CHECK(!CommandRollback::active());
+    CHECK(transactions.drawing.size() == 8);
+    CHECK(transactions.starts == 3 && transactions.ends == 3 && transactions.aborts == 0);
+    CHECK(transactions.open.empty());
+}
+
+
+static void checkFailedBatchRollsBackCommand() {
+    MockTransactions transactions;
+    bool finished = true;
+    MockEntities walls(transactions, 0, 5);
+    MockEntities connectors(transactions, 100, 6, 4);
+    {
+        CommandRollback command(transactions);
+        CHECK(BatchCommit::commit(transactions, walls, 5));
+        CHECK(!BatchCommit::commit(transactions, connectors, 6));
+        finished = command.finish();
+    }
+    CHECK(!finished);
+    CHECK(transactions.drawing.empty());
+    CHECK(transactions.aborts == 2);
+    CHECK(transactions.open.empty());
+    CHECK(walls.accountedFor() && connectors.accountedFor());
+    CHECK(connectors.appended[3] == 1 && connectors.discarded[4] == 1 && connectors.discarded[5] == 1);
+}
+
+
+static void checkNestedCommandJoins() {
+    MockTransactions transactions;
+    {
+        CommandRollback outer(transactions);
+        {
+            CommandRollback inner(transactions);
+            CHECK(!inner.started());
+            MockEntities ties(transactions, 0, 2, 0);
+            CHECK(!BatchCommit::commit(transactions, ties, 2));
+            CHECK(inner.finish());
+        }
+        CHECK(CommandRollback::active());
+        CHECK(!outer.finish());
+    }
+    CHECK(transactions.starts == 2 && transactions.aborts == 2);
+}
+
+
+static void checkBatchOutsideCommand() {
+    MockTransactions transactions;
+    MockEntities good(transactions, 0, 4);
+    MockEntities bad(transactions, 10, 4, 2);
+    CHECK(BatchCommit::commit(transactions, good, 4));
+    CHECK(!BatchCommit::commit(transactions, bad, 4));
+    CHECK(transactions.drawing.size() == 4 && transactions.drawing[0] == 0);
+    CHECK(bad.accountedFor());
+
+    // No transaction at all: nothing is appended and nothing leaks
+    transactions.failStart = true;
+    MockEntities unstarted(transactions, 20, 3);
+    CHECK(!BatchCommit::commit(transactions, unstarted, 3));
+    CHECK(unstarted.accountedFor());
+    CHECK(unstarted.discarded[0] == 1);
+    CHECK(transactions.drawing.size() == 4);
+}
+
+
+// Batches of a command reach the stub drawing when the command ends, and go with it when the
+// command is rolled back
+static void checkStubDatabase() {
+    StubDatabase database;
+    {
+        CommandRollback command(database);
+        StubBlockBatch batch(database);
+        batch.add("panel", 600, 1350, makePlanPoint(0, 0, 0), 0.0);
+        batch.add("panel", 450, 1350, makePlanPoint(600, 0, 0), 0.0);
+        CHECK(batch.commit() == 2);
+        CHECK(batch.size() == 0);
+        CHECK(database.modelSpace().empty());
+    }
+    CHECK(database.modelSpace().size() == 2 && database.modelSpace()[1].width == 450);
+
+    {
+        CommandRollback command(database);
+        StubBlockBatch batch(database);
+        batch.add("tie", 0, 0, makePlanPoint(0, 0, 0), 0.0);
+        CHECK(batch.commit() == 1);
+        CommandRollback::fail();
+    }
+    CHECK(database.modelSpace().size() == 2);
+
+    // Outside a command a batch commits on its own
+    StubBlockBatch batch(database);
+    batch.add("corner post", 100, 1350, makePlanPoint(0, 0, 0), 0.0);
+    CHECK(batch.commit() == 1);
+    CHECK(database.modelSpace().size() == 3 && database.transactions() == 5);
+}
+
+
+static void timeCommits() {
+    const size_t batchSize = 1000;
+    const int batches = 1000;
+    MockTransactions transactions;
+    auto start = std::chrono::steady_clock::now();
+    {
+        CommandRollback command(transactions);
+        for (int batch = 0; batch < batches; ++batch) {
+            MockEntities entities(transactions, batch * static_cast<int>(batchSize), batchSize);
+            BatchCommit::commit(transactions, entities, batchSize);
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CHECK(transactions.drawing.size() == batchSize * batches);
+    std::cout << batches << " batches of " << batchSize << " entities committed in " << ms << " ms\n";
+}
+
+
+int main() {
+    checkCommandCommits();
+    checkFailedBatchRollsBackCommand();
+    checkNestedCommandJoins();
+    checkBatchOutsideCommand();
+    checkStubDatabase();
+    timeCommits();
+    return testResult("BatchCommitTest");
+}
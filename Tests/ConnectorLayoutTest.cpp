@@ -0,0 +1,100 @@
+// ConnectorLayoutTest.cpp
+// Connector positions of the four connector placers in every quadrant: connectors per panel,
+// their offsets from the panel and the template part each one is, and no stacked connectors on
+// panels standing on the slab.
+#include "TestCheck.h"
+#include "WallPanelConnectors/ConnectorLayout.h"
+#include "WallPanelConnectors/ConnectorTemplates.h"
+#include "AssetPlacer/Orientation.h"
+
+static const double quarterTurn = 1.5707963267948966;
+
+static ConnectorPanel panelAt(int quadrant, double z, double width, int levels, bool cornerPost = false) {
+    ConnectorPanel panel = { makePlanPoint(5000, 2000, z), quadrant * quarterTurn, width, levels, cornerPost };
+    return panel;
+}
+
+
+// Connector at `offset` in panel coordinates from a panel of quadrant `quadrant`
+static bool placedAt(const ConnectorPosition& connector, const ConnectorPanel& panel, const PlanPoint& offset) {
+    PlanPoint turned = orient(orientations[orientationQuadrant(panel.rotation)], offset);
+    return std::fabs(connector.position.x - (panel.position.x + turned.x)) < 1e-9 &&
+        std::fabs(connector.position.y - (panel.position.y + turned.y)) < 1e-9 &&
+        std::fabs(connector.position.z - (panel.position.z + turned.z)) < 1e-9 &&
+        connector.rotation == panel.rotation;
+}
+
+
+static void checkWallPanels() {
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        std::vector<ConnectorPanel> panels = { panelAt(quadrant, 0, 600, 3), panelAt(quadrant, 1350, 450, 2),
+            panelAt(quadrant, 0, 100, 3, true) };
+        std::vector<ConnectorPosition> connectors;
+        ConnectorLayout::wallPanels(panels, connectors);
+        CHECK(connectors.size() == 8);
+        if (connectors.size() != 8) continue;
+        for (int i = 0; i < 3; ++i) {
+            CHECK(placedAt(connectors[i], panels[0], wallPanelConnectorTemplate[i]));
+            CHECK(placedAt(connectors[5 + i], panels[2], cornerPostConnectorTemplate[i]));
+        }
+        CHECK(placedAt(connectors[3], panels[1], wallPanelConnectorTemplate[0]));
+        CHECK(placedAt(connectors[4], panels[1], wallPanelConnectorTemplate[1]));
+    }
+}
+
+
+static void checkWalers() {
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        std::vector<ConnectorPanel> panels = { panelAt(quadrant, 0, 100, 2), panelAt(quadrant, 1350, 100, 1) };
+        std::vector<ConnectorPosition> connectors;
+        ConnectorLayout::walers(panels, connectors);
+        CHECK(connectors.size() == 9);
+        if (connectors.size() != 9) continue;
+        const double heights[] = { 300.0, 1050.0, 300.0 };
+        for (int set = 0; set < 3; ++set) {
+            const ConnectorPanel& panel = panels[set < 2 ? 0 : 1];
+            for (int i = 0; i < 3; ++i) {
+                PlanPoint offset = walerConnectorTemplate[i];
+                offset.z = heights[set];
+                CHECK(placedAt(connectors[set * 3 + i], panel, offset));
+                CHECK(connectors[set * 3 + i].part == i);
+            }
+        }
+    }
+}
+
+
+static void checkStackedPanels() {
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        std::vector<ConnectorPanel> panels = { panelAt(quadrant, 0, 600, 1), panelAt(quadrant, 1350, 600, 1),
+            panelAt(quadrant, 2700, 300, 1) };
+        std::vector<ConnectorPosition> connectors;
+        ConnectorLayout::stackedPanels(panels, connectors);
+        CHECK(connectors.size() == 4);
+        if (connectors.size() != 4) continue;
+        for (int panel = 1; panel < 3; ++panel) {
+            PlanPoint ends[2];
+            stackedPanelConnectorTemplate(panels[panel].width, ends);
+            for (int i = 0; i < 2; ++i) {
+                const ConnectorPosition& connector = connectors[(panel - 1) * 2 + i];
+                CHECK(placedAt(connector, panels[panel], ends[i]) && connector.part == i);
+            }
+        }
+
+        std::vector<ConnectorPosition> narrow;
+        ConnectorLayout::stacked15Panels({ panelAt(quadrant, 0, 150, 1), panelAt(quadrant, 600, 150, 1) }, narrow);
+        CHECK(narrow.size() == 2);
+        if (narrow.size() != 2) continue;
+        ConnectorPanel stacked = panelAt(quadrant, 600, 150, 1);
+        CHECK(placedAt(narrow[0], stacked, stacked15ConnectorOffset) && narrow[0].part == 0);
+        CHECK(placedAt(narrow[1], stacked, stacked15ConnectorOffset) && narrow[1].part == 1);
+    }
+}
+
+
+int main() {
+    checkWallPanels();
+    checkWalers();
+    checkStackedPanels();
+    return testResult("ConnectorLayoutTest");
+}
@@ -0,0 +1,182 @@
+// CornerLayoutTest.cpp
+// Corner assemblies of the corner placers: the panel set of every wall thickness, inside and
+// outside corners of an L-shaped wall ring drawn either way round, and the parts of both
+// assemblies against the offsets the placers had written out per quadrant.
+#include "TestCheck.h"
+#include "AssetPlacer/CornerLayout.h"
+#include "AssetPlacer/Orientation.h"
+#include <algorithm>
+#include <cmath>
+
+static const double quarterTurn = 1.5707963267948966;
+
+static bool near(const PlanPoint& point, double x, double y, double z) {
+    return std::fabs(point.x - x) < 1e-9 && std::fabs(point.y - y) < 1e-9 && std::fabs(point.z - z) < 1e-9;
+}
+
+
+static void checkPanelSets() {
+    for (int thickness = 150; thickness <= 2100; thickness += 50) {
+        CornerPanelSet set;
+        CHECK(CornerLayout::panelSet(thickness, set));
+        CHECK(set.inside[0] == 150 && set.inside[1] == 150);
+        CHECK(set.compensator[0] == set.compensator[1]);
+        for (int pair = 0; pair < 3; ++pair) {
+            CHECK(set.outside[pair * 2] == set.outside[pair * 2 + 1]);
+        }
+    }
+    CornerPanelSet set;
+    CHECK(!CornerLayout::panelSet(175, set));
+    CHECK(!CornerLayout::panelSet(2150, set));
+
+    CHECK(CornerLayout::panelSet(800, set));
+    CHECK(set.outside[0] == 300 && set.outside[2] == 750 && set.outside[4] == 0 && set.compensator[0] == 0);
+    CHECK(CornerLayout::panelSet(1950, set));
+    CHECK(set.outside[0] == 600 && set.outside[2] == 750 && set.outside[4] == 750 && set.compensator[0] == 100);
+}
+
+
+static PlanLoop reversed(PlanLoop loop) {
+    std::reverse(loop.begin(), loop.end());
+    return loop;
+}
+
+
+// L-shaped ring: the outside face turns in once, the room inside turns out once
+static void checkCorners(bool reverseLoops) {
+    PlanLoop outer = {
+        makePlanPoint(0, 0, 0), makePlanPoint(6000, 0, 0), makePlanPoint(6000, 3000, 0),
+        makePlanPoint(4500, 3000, 0), makePlanPoint(3000, 3000, 0), makePlanPoint(3000, 6000, 0), makePlanPoint(0, 6000, 0)
+    };
+    PlanLoop inner = {
+        makePlanPoint(200, 200, 0), makePlanPoint(200, 5800, 0), makePlanPoint(2800, 5800, 0),
+        makePlanPoint(2800, 2800, 0), makePlanPoint(5800, 2800, 0), makePlanPoint(5800, 200, 0)
+    };
+    std::vector<PlanLoop> loops = { reverseLoops ? reversed(inner) : inner, reverseLoops ? reversed(outer) : outer };
+    LoopHierarchy hierarchy;
+    hierarchy.build(loops);
+    WallGraph graph;
+    graph.build(loops, hierarchy);
+
+    std::vector<WallCorner> corners;
+    CornerLayout::corners(loops, hierarchy, graph, corners);
+    CHECK(corners.size() == 12);    // the collinear vertex at 4500 skipped
+
+    int inside = 0;
+    for (const WallCorner& corner : corners) {
+        const PlanPoint& p = corner.position;
+        bool reentrant = (p.x == 3000 && p.y == 3000) || (p.x == 2800 && p.y == 2800);
+        bool onOuter = corner.loop == 1;
+        // Inside corners: where the outside face turns in, and every room corner but the one
+        // the outside corner of the ring wraps round
+        CHECK(corner.inside == (onOuter ? reentrant : !reentrant));
+        inside += corner.inside ? 1 : 0;
+
+        // Assemblies lie along the two walls whichever way the loop runs: the first panel of an
+        // inside corner and the post's far side sit on one of the walls meeting there
+        if (corner.inside) {
+            PlanPoint alongFirst = orient(orientations[corner.quadrant], makePlanPoint(1000, 0, 0));
+            PlanPoint alongSecond = orient(orientations[corner.quadrant], makePlanPoint(0, -1000, 0));
+            auto onWall = [&](const PlanPoint& offset) {
+                double x = p.x + offset.x;
+                double y = p.y + offset.y;
+                for (const PlanLoop& loop : loops) {
+                    for (size_t i = 0; i < loop.size(); ++i) {
+                        const PlanPoint& a = loop[i];
+                        const PlanPoint& b = loop[(i + 1) % loop.size()];
+                        bool onX = a.x == b.x && x == a.x && y >= std::min(a.y, b.y) && y <= std::max(a.y, b.y);
+                        bool onY = a.y == b.y && y == a.y && x >= std::min(a.x, b.x) && x <= std::max(a.x, b.x);
+                        if (onX || onY) {
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            };
+            CHECK(onWall(alongFirst));
+            CHECK(onWall(alongSecond));
+        }
+    }
+    CHECK(inside == 6);
+}
+
+
+// Offsets of CornerAssetPlacer::placeInsideCornerPostAndPanels for rotations 0, 90, 180, 270
+static void checkInsideCorner() {
+    const double expected[4][4][2] = {
+        { { 100, 0 }, { 0, -250 }, { 250, 0 }, { 0, -300 } },
+        { { 0, 100 }, { 250, 0 }, { 0, 250 }, { 300, 0 } },
+        { { -100, 0 }, { 0, 250 }, { -250, 0 }, { 0, 300 } },
+        { { 0, -100 }, { -250, 0 }, { 0, -250 }, { -300, 0 } }
+    };
+    CornerPanelSet set;
+    CornerLayout::panelSet(150, set);
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        WallCorner corner = { makePlanPoint(5000, 2000, 0), quadrant, true, 0, 0 };
+        std::vector<CornerPart> parts;
+        CornerLayout::insideCorner(corner, set, 150, 2000, parts);
+        // One 1350 row and one 600 row of post, two panels and two compensators
+        CHECK(parts.size() == 10);
+        if (parts.size() != 10) continue;
+
+        for (int row = 0; row < 2; ++row) {
+            const CornerPart* part = &parts[row * 5];
+            double z = row * 1350.0;
+            int height = row == 0 ? 1350 : 600;
+            CHECK(part[0].kind == CornerPartKind::Post && near(part[0].position, 5000, 2000, z));
+            CHECK(part[0].rotation == quadrant * quarterTurn);
+            for (int i = 0; i < 4; ++i) {
+                CHECK(near(part[i + 1].position, 5000 + expected[quadrant][i][0], 2000 + expected[quadrant][i][1], z));
+                CHECK(part[i + 1].height == height);
+                CHECK(part[i + 1].rotation == orientations[(quadrant + i % 2) % 4].angle);
+            }
+            CHECK(part[1].width == 150 && part[2].width == 150 && part[3].width == 50 && part[4].kind == CornerPartKind::Compensator);
+        }
+    }
+
+    // Compensators only on 150 thick walls
+    CornerLayout::panelSet(250, set);
+    std::vector<CornerPart> parts;
+    CornerLayout::insideCorner({ makePlanPoint(0, 0, 0), 0, true, 0, 0 }, set, 250, 1350, parts);
+    CHECK(parts.size() == 3);
+}
+
+
+// Offsets of CornerAssetPlacer::placeOutsideCornerPostAndPanels at 90 degrees, 1500 thick
+static void checkOutsideCorner() {
+    CornerPanelSet set;
+    CornerLayout::panelSet(1500, set);
+    WallCorner corner = { makePlanPoint(5000, 2000, 0), 1, false, 0, 0 };
+    std::vector<CornerPart> parts;
+    CornerLayout::outsideCorner(corner, set, 1500, 1350, parts);
+    CHECK(parts.size() == 9);
+    if (parts.size() != 9) return;
+
+    double postX = 5000 - 100;
+    double postY = 2000 - 100;
+    CHECK(parts[0].kind == CornerPartKind::Post && near(parts[0].position, postX, postY, 0));
+    const double expected[8][2] = {
+        { 100, 550 }, { 100, 100 }, { 100, 1000 }, { 550, 100 }, { 100, 1750 }, { 1000, 100 }, { 100, 1850 }, { 1750, 100 }
+    };
+    for (int i = 0; i < 8; ++i) {
+        CHECK(near(parts[i + 1].position, postX + expected[i][0], postY + expected[i][1], 0));
+        CHECK(parts[i + 1].rotation == orientations[(1 + (i % 2 == 0 ? 2 : 3)) % 4].angle);
+    }
+    CHECK(parts[7].kind == CornerPartKind::Compensator && parts[7].width == 100);
+
+    // No compensators on a 150 wall, no parts for the empty outer pairs
+    CornerLayout::panelSet(150, set);
+    parts.clear();
+    CornerLayout::outsideCorner(corner, set, 150, 1350, parts);
+    CHECK(parts.size() == 3);
+}
+
+
+int main() {
+    checkPanelSets();
+    checkCorners(false);
+    checkCorners(true);
+    checkInsideCorner();
+    checkOutsideCorner();
+    return testResult("CornerLayoutTest");
+}
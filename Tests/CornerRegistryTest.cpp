@@ -0,0 +1,92 @@
+// CornerRegistryTest.cpp
+// Proximity queries of the per-command corner registry, identical layouts on repeated runs,
+// and query time that does not grow with the number of registered corners.
+#include "TestCheck.h"
+#include "AssetPlacer/CornerRegistry.h"
+#include "AssetPlacer/LayoutDriver.h"
+#include "AssetPlacer/PlanGenerator.h"
+#include <chrono>
+
+static void checkQueries() {
+    CornerRegistry registry(1.0);
+    CHECK(!registry.isNear(makePlanPoint(0.0, 0.0)));
+
+    registry.add(makePlanPoint(100.0, 200.0));
+    CHECK(registry.size() == 1);
+    CHECK(registry.isNear(makePlanPoint(100.0, 200.0)));
+    CHECK(registry.isNear(makePlanPoint(100.6, 199.5)));
+    CHECK(!registry.isNear(makePlanPoint(101.0, 200.0)));
+    CHECK(!registry.isNear(makePlanPoint(100.0, 200.0, 5.0)));
+
+    // Neighbours across a cell boundary
+    registry.add(makePlanPoint(9.99, -0.01));
+    CHECK(registry.isNear(makePlanPoint(10.01, 0.01)));
+
+    registry.clear();
+    CHECK(registry.size() == 0);
+    CHECK(!registry.isNear(makePlanPoint(100.0, 200.0)));
+}
+
+
+static void checkRepeatedRuns() {
+    PlanGenerator generator(4);
+    PlanInput plan = generator.apartments(6, 6);
+
+    LayoutPlan first;
+    LayoutDriver::run(plan, first, 1);
+    CHECK(!first.items.empty());
+    for (int run = 0; run < 3; ++run) {
+        LayoutPlan again;
+        LayoutDriver::run(plan, again, 1);
+        CHECK(again.items.size() == first.items.size());
+        size_t different = 0;
+        for (size_t i = 0; i < first.items.size() && i < again.items.size(); ++i) {
+            const LayoutItem& a = first.items[i];
+            const LayoutItem& b = again.items[i];
+            different += a.width == b.width && a.height == b.height && a.position.x == b.position.x
+                && a.position.y == b.position.y && a.position.z == b.position.z && a.rotation == b.rotation ? 0 : 1;
+        }
+        CHECK(different == 0);
+    }
+}
+
+
+// Nanoseconds per query with `corners` registered on a 1 m grid
+static double queryTime(int corners) {
+    CornerRegistry registry(1.0);
+    int side = 1;
+    while (side * side < corners) {
+        side++;
+    }
+    for (int i = 0; i < corners; ++i) {
+        registry.add(makePlanPoint((i % side) * 1000.0, (i / side) * 1000.0));
+    }
+
+    const int queries = 200000;
+    size_t near = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queries; ++i) {
+        int corner = (i * 7919) % corners;
+        near += registry.isNear(makePlanPoint((corner % side) * 1000.0 + 0.5, (corner / side) * 1000.0)) ? 1 : 0;
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / queries;
+    CHECK(near == static_cast<size_t>(queries));
+    return ns;
+}
+
+
+static void checkConstantTime() {
+    double small = queryTime(1000);
+    double large = queryTime(100000);
+    std::cout << "isNear: " << small << " ns with 1000 corners, " << large << " ns with 100000 corners\n";
+    // A linear scan would be 100 times slower; the larger table only adds cache misses
+    CHECK(large < small * 25);
+}
+
+
+int main() {
+    checkQueries();
+    checkRepeatedRuns();
+    checkConstantTime();
+    return testResult("CornerRegistryTest");
+}
@@ -0,0 +1,256 @@
+// LayoutUpdateTest.cpp
+// Edges PeriUpdate lays out again after a polyline edit: moved corners, corners whose turn
+// changed, thickness changes and renumbered loops, and the runs and loops they reach; and a
+// one-vertex edit of a large generated plan replayed on the stub drawing.
+#include "TestCheck.h"
+#include "AssetPlacer/LayoutUpdate.h"
+#include "AssetPlacer/LayoutDriver.h"
+#include "AssetPlacer/PlanGenerator.h"
+#include "Blocks/StubDatabase.h"
+#include <map>
+#include <utility>
+
+static PlacedLoop placedLoop(const PlanLoop& corners) {
+    PlacedLoop loop;
+    loop.corners = corners;
+    loop.runThickness.assign(corners.size(), 200.0);
+    loop.isOuter = true;
+    loop.isClockwise = signedLoopArea(corners) < 0;
+    return loop;
+}
+
+
+static std::vector<size_t> dirtyEdges(const PlacedLoop& before, const PlacedLoop& current) {
+    std::vector<char> dirty;
+    std::vector<PlanPoint> moved;
+    size_t flagged = LayoutUpdate::compare(before, current, 0.05, dirty, moved);
+    std::vector<size_t> edges;
+    for (size_t edgeNum = 0; edgeNum < dirty.size(); ++edgeNum) {
+        if (dirty[edgeNum]) {
+            edges.push_back(edgeNum);
+        }
+    }
+    CHECK(edges.size() == flagged);
+    return edges;
+}
+
+
+static void checkMovedCorners() {
+    // L shape, counter-clockwise; corner 3 is the inside corner
+    PlanLoop shape = { makePlanPoint(0, 0), makePlanPoint(6000, 0), makePlanPoint(6000, 3000),
+        makePlanPoint(3000, 3000), makePlanPoint(3000, 6000), makePlanPoint(0, 6000) };
+    PlacedLoop before = placedLoop(shape);
+    CHECK(dirtyEdges(before, before).empty());
+
+    // A wall slid out with every turn kept: the edges of its two corners
+    PlacedLoop slid = before;
+    slid.corners[2].x = 6500;
+    slid.corners[1].x = 6500;
+    CHECK((dirtyEdges(before, slid) == std::vector<size_t>{ 0, 1, 2 }));
+
+    PlacedLoop nudged = before;
+    nudged.corners[4].y = 6200;
+    nudged.corners[5].y = 6200;
+    CHECK((dirtyEdges(before, nudged) == std::vector<size_t>{ 3, 4, 5 }));
+
+    // Corner 3 pulled out past corner 2: corner 2 turns the other way, so edge 1 is reached
+    // although neither of its corners moved
+    PlacedLoop flipped = before;
+    flipped.corners[3].x = 7000;
+    CHECK((dirtyEdges(before, flipped) == std::vector<size_t>{ 1, 2, 3 }));
+
+    // Corner 2 of a straight run bent: corner 1 turns, so edge 0 goes too
+    PlanLoop straight = { makePlanPoint(0, 0), makePlanPoint(1000, 0), makePlanPoint(2000, 0),
+        makePlanPoint(2000, 2000), makePlanPoint(0, 2000) };
+    PlacedLoop straightBefore = placedLoop(straight);
+    PlacedLoop bent = straightBefore;
+    bent.corners[2].y = 500;
+    CHECK((dirtyEdges(straightBefore, bent) == std::vector<size_t>{ 0, 1, 2 }));
+
+    // Moves under the tolerance are noise
+    PlacedLoop noise = before;
+    noise.corners[3].x += 0.01;
+    CHECK(dirtyEdges(before, noise).empty());
+}
+
+
+static void checkOtherChanges() {
+    PlanLoop square = { makePlanPoint(0, 0), makePlanPoint(4000, 0), makePlanPoint(4000, 4000), makePlanPoint(0, 4000) };
+    PlacedLoop before = placedLoop(square);
+
+    PlacedLoop thicker = before;
+    thicker.runThickness[2] = 250.0;
+    CHECK((dirtyEdges(before, thicker) == std::vector<size_t>{ 2 }));
+
+    PlacedLoop inner = before;
+    inner.isOuter = false;
+    CHECK(dirtyEdges(before, inner).size() == 4);
+
+    PlacedLoop extra = before;
+    extra.corners.insert(extra.corners.begin() + 1, makePlanPoint(2000, 0));
+    extra.runThickness.push_back(200.0);
+    std::vector<char> dirty;
+    std::vector<PlanPoint> moved;
+    CHECK(LayoutUpdate::compare(before, extra, 0.05, dirty, moved) == 5);
+    CHECK(moved.size() == 9);
+}
+
+
+static void checkRunsAndNeighbours() {
+    PlanInput plan;
+    PlanLoop outer = { makePlanPoint(0, 0), makePlanPoint(8000, 0), makePlanPoint(8000, 5000), makePlanPoint(0, 5000) };
+    PlanLoop other = { makePlanPoint(20000, 0), makePlanPoint(26000, 0), makePlanPoint(26000, 5000), makePlanPoint(20000, 5000) };
+    plan.loops = { outer, other };
+    LayoutPlan layout;
+    LayoutDriver::run(plan, layout, 1);
+
+    std::vector<std::vector<char>> dirty = { { 0, 1, 0, 0 }, { 0, 0, 0, 0 } };
+    std::vector<size_t> runs;
+    LayoutUpdate::dirtyRuns(layout, dirty, runs);
+    CHECK(runs.size() == 1);
+    if (runs.size() == 1) {
+        CHECK(layout.runs[runs[0]].loop == 0 && layout.runs[runs[0]].edge == 1);
+    }
+
+    std::vector<std::vector<double>> thickness;
+    LayoutUpdate::runThickness(layout, plan.loops, thickness);
+    CHECK(thickness.size() == 2 && thickness[1].size() == 4 && thickness[1][3] == 200.0);
+
+    std::vector<char> flagged;
+    LayoutUpdate::loopsNear(plan.loops, { makePlanPoint(20000.5, 0.0) }, 1.0, flagged);
+    CHECK(flagged.size() == 2 && !flagged[0] && flagged[1]);
+}
+
+
+static void queueRun(const LayoutPlan& layout, const LayoutRun& run, StubBlockBatch& batch) {
+    for (size_t itemNum = run.firstItem; itemNum < run.firstItem + run.itemCount; ++itemNum) {
+        const LayoutItem& item = layout.items[itemNum];
+        batch.add("panel", item.width, item.height, item.position, item.rotation);
+    }
+}
+
+
+// Whole layout on a stub drawing, one batch in one command, as PlaceWalls commits it; `runBlocks`
+// gets the reference range of every run, as the segment tags keep it
+static void placeAll(const LayoutPlan& layout, StubDatabase& database, std::vector<size_t>& runBlocks) {
+    CommandRollback command(database);
+    StubBlockBatch batch(database);
+    runBlocks.assign(1, 0);
+    for (const LayoutRun& run : layout.runs) {
+        queueRun(layout, run, batch);
+        runBlocks.push_back(batch.size());
+    }
+    batch.commit();
+}
+
+
+static bool sameReference(const StubBlockReference& a, const StubBlockReference& b) {
+    return a.width == b.width && a.height == b.height && a.rotation == b.rotation &&
+        a.position.x == b.position.x && a.position.y == b.position.y && a.position.z == b.position.z;
+}
+
+
+// One vertex of a 580 edge plan moved: compare and dirtyRuns reach the same two or three runs
+// whatever the plan size, every other run lays out as before, and keeping those runs' blocks
+// while placing only the dirty runs gives the drawing a full placement would
+static void checkLargePlanEdit() {
+    PlanGenerator generator(7);
+    PlanInput plan = generator.apartments(12, 12);
+    size_t edges = 0;
+    for (const PlanLoop& loop : plan.loops) {
+        edges += loop.size();
+    }
+    CHECK(edges >= 500);
+
+    LayoutPlan before;
+    LayoutDriver::run(plan, before, 1);
+    LoopHierarchy beforeHierarchy;
+    beforeHierarchy.build(plan.loops);
+    std::vector<std::vector<double>> beforeThickness;
+    LayoutUpdate::runThickness(before, plan.loops, beforeThickness);
+    std::map<std::pair<int, int>, size_t> beforeRun;
+    for (size_t runNum = 0; runNum < before.runs.size(); ++runNum) {
+        beforeRun[std::make_pair(before.runs[runNum].loop, before.runs[runNum].edge)] = runNum;
+    }
+    StubDatabase original;
+    std::vector<size_t> originalBlocks;
+    placeAll(before, original, originalBlocks);
+
+    // A room corner, a corner of the outside face and a corner deep in the block
+    const int edits[][2] = { { 1, 2 }, { 0, 0 }, { 78, 1 } };
+    for (const auto& edit : edits) {
+        PlanInput edited = plan;
+        edited.loops[edit[0]][edit[1]].x += 100.0;
+        LayoutPlan after;
+        LayoutDriver::run(edited, after, 1);
+        LoopHierarchy afterHierarchy;
+        afterHierarchy.build(edited.loops);
+        std::vector<std::vector<double>> afterThickness;
+        LayoutUpdate::runThickness(after, edited.loops, afterThickness);
+
+        std::vector<std::vector<char>> dirty(edited.loops.size());
+        std::vector<PlanPoint> moved;
+        for (size_t loopNum = 0; loopNum < edited.loops.size(); ++loopNum) {
+            LayoutUpdate::compare(LayoutUpdate::placed(plan.loops[loopNum], loopNum, beforeHierarchy, beforeThickness),
+                LayoutUpdate::placed(edited.loops[loopNum], loopNum, afterHierarchy, afterThickness), 0.05, dirty[loopNum], moved);
+        }
+        std::vector<size_t> runs;
+        LayoutUpdate::dirtyRuns(after, dirty, runs);
+        CHECK(runs.size() >= 2 && runs.size() <= 3);
+        for (size_t runNum : runs) {
+            CHECK(after.runs[runNum].loop == edit[0]);
+        }
+
+        // The update on the stub drawing: untouched runs keep their blocks, dirty ones are placed anew
+        StubDatabase updated;
+        {
+            CommandRollback command(updated);
+            StubBlockBatch batch(updated);
+            size_t nextDirty = 0;
+            for (size_t runNum = 0; runNum < after.runs.size(); ++runNum) {
+                const LayoutRun& run = after.runs[runNum];
+                if (nextDirty < runs.size() && runs[nextDirty] == runNum) {
+                    nextDirty++;
+                    queueRun(after, run, batch);
+                    continue;
+                }
+
+                auto match = beforeRun.find(std::make_pair(run.loop, run.edge));
+                CHECK(match != beforeRun.end());
+                if (match == beforeRun.end()) continue;
+                const LayoutRun& old = before.runs[match->second];
+                CHECK(old.itemCount == run.itemCount);
+                for (size_t i = 0; i < run.itemCount && i < old.itemCount; ++i) {
+                    const LayoutItem& a = after.items[run.firstItem + i];
+                    const LayoutItem& b = before.items[old.firstItem + i];
+                    CHECK(a.width == b.width && a.height == b.height && a.rotation == b.rotation &&
+                        a.position.x == b.position.x && a.position.y == b.position.y && a.position.z == b.position.z);
+                }
+                for (size_t block = originalBlocks[match->second]; block < originalBlocks[match->second + 1]; ++block) {
+                    const StubBlockReference& kept = original.modelSpace()[block];
+                    batch.add(kept.block, kept.width, kept.height, kept.position, kept.rotation);
+                }
+            }
+            batch.commit();
+        }
+
+        StubDatabase fresh;
+        std::vector<size_t> freshBlocks;
+        placeAll(after, fresh, freshBlocks);
+        CHECK(updated.modelSpace().size() == fresh.modelSpace().size());
+        bool same = updated.modelSpace().size() == fresh.modelSpace().size();
+        for (size_t block = 0; same && block < fresh.modelSpace().size(); ++block) {
+            same = sameReference(updated.modelSpace()[block], fresh.modelSpace()[block]);
+        }
+        CHECK(same);
+    }
+}
+
+
+int main() {
+    checkMovedCorners();
+    checkOtherChanges();
+    checkRunsAndNeighbours();
+    checkLargePlanEdit();
+    return testResult("LayoutUpdateTest");
+}
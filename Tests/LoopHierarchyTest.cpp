@@ -0,0 +1,147 @@
+// LoopHierarchyTest.cpp
+// Containment tree of nested rings and islands and of rooms against their ring's wall, the same
+// parents as testing every larger loop, the same tree restored from saved parents, and build
+// times on sites of 2000 and 8000 buildings.
+#include "TestCheck.h"
+#include "AssetPlacer/LoopHierarchy.h"
+#include "AssetPlacer/PlanGenerator.h"
+#include <chrono>
+
+static PlanLoop square(double x, double y, double size) {
+    return { makePlanPoint(x, y), makePlanPoint(x + size, y), makePlanPoint(x + size, y + size), makePlanPoint(x, y + size) };
+}
+
+
+// Reference parents: the smallest larger loop that contains a point just inside, every pair tested
+static std::vector<int> bruteForceParents(const std::vector<PlanLoop>& loops, const LoopHierarchy& hierarchy) {
+    std::vector<int> parents(loops.size(), -1);
+    for (size_t i = 0; i < loops.size(); ++i) {
+        PlanPoint probe = loopInteriorPoint(loops[i]);
+        for (size_t j = 0; j < loops.size(); ++j) {
+            if (i == j || hierarchy.area(j) <= hierarchy.area(i)) continue;
+            if (!isPointInsideLoop(probe, loops[j])) continue;
+            if (parents[i] < 0 || hierarchy.area(j) < hierarchy.area(parents[i])) {
+                parents[i] = static_cast<int>(j);
+            }
+        }
+    }
+    return parents;
+}
+
+
+static void checkNesting() {
+    // Ring with a courtyard ring inside and an island in the courtyard, next to a separate building
+    std::vector<PlanLoop> loops;
+    loops.push_back(square(1000, 1000, 2000));      // 0 island
+    loops.push_back(square(0, 0, 10000));           // 1 outer face
+    loops.push_back(square(200, 200, 9600));        // 2 inner face
+    loops.push_back(square(20000, 0, 5000));        // 3 separate building
+    loops.push_back(square(500, 500, 4000));        // 4 courtyard outer face
+    loops.push_back(square(700, 700, 3600));        // 5 courtyard inner face
+
+    LoopHierarchy hierarchy;
+    hierarchy.build(loops);
+    CHECK(hierarchy.outermostIndex() == 1);
+    CHECK(hierarchy.roots().size() == 2);
+    CHECK(hierarchy.node(1).parent == -1 && hierarchy.node(3).parent == -1);
+    CHECK(hierarchy.node(2).parent == 1);
+    CHECK(hierarchy.node(4).parent == 2);
+    CHECK(hierarchy.node(5).parent == 4);
+    CHECK(hierarchy.node(0).parent == 5);
+    CHECK(hierarchy.node(0).depth == 4);
+    CHECK(hierarchy.isOuter(1) && !hierarchy.isOuter(2) && hierarchy.isOuter(4) && !hierarchy.isOuter(5));
+    CHECK(hierarchy.node(1).children.size() == 1 && hierarchy.node(1).children[0] == 2);
+}
+
+
+static void checkTouchingParent() {
+    // Rooms built against the inside face of the ring, starting on it: a counter-clockwise one on
+    // the right wall and a clockwise one on the top wall. Their first vertices test as outside it.
+    std::vector<PlanLoop> loops;
+    loops.push_back(square(0, 0, 10000));
+    loops.push_back({ makePlanPoint(10000, 4000), makePlanPoint(10000, 6000), makePlanPoint(8000, 6000), makePlanPoint(8000, 4000) });
+    loops.push_back({ makePlanPoint(3000, 10000), makePlanPoint(5000, 10000), makePlanPoint(5000, 8000), makePlanPoint(3000, 8000) });
+    CHECK(!isPointInsideLoop(loops[1][0], loops[0]) && !isPointInsideLoop(loops[2][0], loops[0]));
+
+    LoopHierarchy hierarchy;
+    hierarchy.build(loops);
+    CHECK(hierarchy.roots().size() == 1);
+    CHECK(hierarchy.node(1).parent == 0 && hierarchy.node(1).depth == 1 && !hierarchy.isClockwise(1));
+    CHECK(hierarchy.node(2).parent == 0 && hierarchy.node(2).depth == 1 && hierarchy.isClockwise(2));
+    CHECK(isPointInsideLoop(loopInteriorPoint(loops[1]), loops[1]));
+    CHECK(isPointInsideLoop(loopInteriorPoint(loops[2]), loops[2]));
+}
+
+
+static void checkAgainstBruteForce() {
+    PlanGenerator generator(11);
+    PlanInput plans[] = { generator.apartments(8, 8), generator.courtyard(), generator.site(300) };
+    for (const PlanInput& plan : plans) {
+        LoopHierarchy hierarchy;
+        hierarchy.build(plan.loops);
+        std::vector<int> parents = bruteForceParents(plan.loops, hierarchy);
+        size_t different = 0;
+        for (size_t i = 0; i < plan.loops.size(); ++i) {
+            different += hierarchy.node(i).parent == parents[i] ? 0 : 1;
+        }
+        CHECK(different == 0);
+    }
+}
+
+
+static void checkRestore() {
+    PlanGenerator generator(13);
+    PlanInput plan = generator.site(300);
+    LoopHierarchy built;
+    built.build(plan.loops);
+    std::vector<int> parents;
+    for (size_t i = 0; i < built.size(); ++i) {
+        parents.push_back(built.node(i).parent);
+    }
+
+    LoopHierarchy restored;
+    CHECK(restored.restore(plan.loops, parents));
+    CHECK(restored.size() == built.size());
+    CHECK(restored.outermostIndex() == built.outermostIndex());
+    CHECK(restored.roots() == built.roots());
+    size_t different = 0;
+    for (size_t i = 0; i < built.size(); ++i) {
+        const LoopNode& a = built.node(i);
+        const LoopNode& b = restored.node(i);
+        different += a.parent == b.parent && a.depth == b.depth && a.isClockwise == b.isClockwise &&
+            a.area == b.area && a.children == b.children ? 0 : 1;
+    }
+    CHECK(different == 0);
+
+    // A parent smaller than its child, or a cycle, is not a tree build could have saved
+    std::vector<PlanLoop> loops = { square(0, 0, 10000), square(200, 200, 9600) };
+    CHECK(!restored.restore(loops, { 1, -1 }));
+    CHECK(restored.size() == 0 && restored.outermostIndex() == -1);
+    CHECK(!restored.restore(loops, { 1, 0 }));
+    CHECK(!restored.restore(loops, { -1, 2 }));
+    CHECK(!restored.restore(loops, { -1 }));
+    CHECK(restored.restore(loops, { -1, 0 }) && restored.node(1).depth == 1);
+}
+
+
+static void timeSite(int buildings) {
+    PlanGenerator generator(5);
+    PlanInput plan = generator.site(buildings);
+    auto start = std::chrono::steady_clock::now();
+    LoopHierarchy hierarchy;
+    hierarchy.build(plan.loops);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CHECK(hierarchy.roots().size() * 2 == plan.loops.size());
+    std::cout << "site-" << buildings << ": " << plan.loops.size() << " loops, " << ms << " ms\n";
+}
+
+
+int main() {
+    checkNesting();
+    checkTouchingParent();
+    checkAgainstBruteForce();
+    checkRestore();
+    timeSite(2000);
+    timeSite(8000);
+    return testResult("LoopHierarchyTest");
+}
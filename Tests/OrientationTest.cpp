@@ -0,0 +1,154 @@
+// OrientationTest.cpp
+// Orientation table in all four quadrants, and the offsets of every connector template (corner
+// posts included) and the tie set against the per-quadrant sign flips the placers used to write
+// by hand.
+#include "TestCheck.h"
+#include "AssetPlacer/Orientation.h"
+#include "WallPanelConnectors/ConnectorTemplates.h"
+#include "Tie/TieLayout.h"
+
+static const double quarterTurn = 1.5707963267948966;
+
+static bool near(const PlanPoint& point, double x, double y, double z = 0.0) {
+    return std::fabs(point.x - x) < 1e-9 && std::fabs(point.y - y) < 1e-9 && std::fabs(point.z - z) < 1e-9;
+}
+
+
+static void checkQuadrants() {
+    CHECK(orientationQuadrant(0.0) == 0);
+    CHECK(orientationQuadrant(quarterTurn) == 1);
+    CHECK(orientationQuadrant(2 * quarterTurn) == 2);
+    CHECK(orientationQuadrant(3 * quarterTurn) == 3);
+    CHECK(orientationQuadrant(4 * quarterTurn) == 0);
+    CHECK(orientationQuadrant(-quarterTurn) == 3);
+    CHECK(orientationQuadrant(5 * quarterTurn) == 1);
+    CHECK(orientationQuadrant(quarterTurn - 1e-9) == 1);
+    CHECK(orientationQuadrant(-1e-9) == 0);
+
+    // The integer rotation is the rotation by the table angle
+    const PlanPoint local = makePlanPoint(120.0, -35.0, 7.0);
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        const Orientation& orientation = orientations[quadrant];
+        CHECK(std::fabs(orientation.angle - quadrant * quarterTurn) < 1e-12);
+        PlanPoint turned = orient(orientation, local);
+        double c = std::cos(orientation.angle);
+        double s = std::sin(orientation.angle);
+        CHECK(near(turned, c * local.x - s * local.y, s * local.x + c * local.y, local.z));
+        CHECK(&orientationOf(orientation.angle + 4 * quarterTurn) == &orientation);
+    }
+}
+
+
+static void checkWallPanelConnectors() {
+    // Old switch: q0 y -= 50, q1 x += 50, q2 y += 50, q3 x -= 50
+    const double expected[4][2] = { { 0, -50 }, { 50, 0 }, { 0, 50 }, { -50, 0 } };
+    const double heights[3] = { 225.0, 525.0, 975.0 };
+    PlanPoint offsets[3];
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        orient(orientations[quadrant], wallPanelConnectorTemplate, offsets, 3);
+        for (int i = 0; i < 3; ++i) {
+            CHECK(near(offsets[i], expected[quadrant][0], expected[quadrant][1], heights[i]));
+        }
+    }
+}
+
+
+static void checkCornerPostConnectors() {
+    // Old switch on top of the wall panel offsets: q0 x += 100, q1 y += 100, q2 x -= 100, q3 y -= 100
+    const double expected[4][2] = { { 100, -50 }, { 50, 100 }, { -100, 50 }, { -50, -100 } };
+    PlanPoint offsets[3];
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        orient(orientations[quadrant], cornerPostConnectorTemplate, offsets, 3);
+        for (int i = 0; i < 3; ++i) {
+            CHECK(near(offsets[i], expected[quadrant][0], expected[quadrant][1], wallPanelConnectorTemplate[i].z));
+        }
+    }
+}
+
+
+static void checkWalerConnectors() {
+    // Old switch on (x, y): q0 (x, y), q1 (-y, x), q2 (-x, -y), q3 (y, -x)
+    PlanPoint offsets[3];
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        orient(orientations[quadrant], walerConnectorTemplate, offsets, 3);
+        for (int i = 0; i < 3; ++i) {
+            double x = walerConnectorTemplate[i].x;
+            double y = walerConnectorTemplate[i].y;
+            const double expected[4][2] = { { x, y }, { -y, x }, { -x, -y }, { y, -x } };
+            CHECK(near(offsets[i], expected[quadrant][0], expected[quadrant][1]));
+        }
+    }
+}
+
+
+static void checkStackedConnectors() {
+    // Old switch with 50 across and 75 from each end of a panel `width` wide
+    const double widths[] = { 300.0, 450.0, 600.0 };
+    for (double width : widths) {
+        const double far = width - 75.0;
+        const double expected[4][2][2] = {
+            { { 75, -50 }, { far, -50 } },
+            { { 50, 75 }, { 50, far } },
+            { { -75, 50 }, { -far, 50 } },
+            { { -50, -75 }, { -50, -far } }
+        };
+        PlanPoint connectorTemplate[2];
+        stackedPanelConnectorTemplate(width, connectorTemplate);
+        PlanPoint offsets[2];
+        for (int quadrant = 0; quadrant < 4; ++quadrant) {
+            orient(orientations[quadrant], connectorTemplate, offsets, 2);
+            for (int i = 0; i < 2; ++i) {
+                CHECK(near(offsets[i], expected[quadrant][i][0], expected[quadrant][i][1]));
+            }
+        }
+    }
+}
+
+
+static void checkStacked15Connectors() {
+    const double expected[4][2] = { { 75, -50 }, { 50, 75 }, { -75, 50 }, { -50, -75 } };
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        PlanPoint offset = orient(orientations[quadrant], stacked15ConnectorOffset);
+        CHECK(near(offset, expected[quadrant][0], expected[quadrant][1]));
+    }
+}
+
+
+static void checkTieSets() {
+    // Old switch for the tie, 25 from the panel edge and half the wall across:
+    // q0 (25, t/2), q1 (-t/2, 25), q2 (-25, -t/2), q3 (t/2, -25)
+    const double thicknesses[] = { 200.0, 250.0, 300.0 };
+    for (double thickness : thicknesses) {
+        double half = thickness / 2;
+        const double expected[4][2] = { { 25, half }, { -half, 25 }, { -25, -half }, { half, -25 } };
+        for (int waler = 0; waler < 2; ++waler) {
+            TiePart parts[3];
+            TieLayout::parts(thickness, waler == 1, parts);
+            PlanPoint tieTemplate[3] = { parts[0].offset, parts[1].offset, parts[2].offset };
+            PlanPoint offsets[3];
+            for (int quadrant = 0; quadrant < 4; ++quadrant) {
+                orient(orientations[quadrant], tieTemplate, offsets, 3);
+                CHECK(near(offsets[0], expected[quadrant][0], expected[quadrant][1]));
+                // Wingnuts on either face, symmetric about the tie and further out through a waler
+                CHECK(near(makePlanPoint(offsets[1].x + offsets[2].x, offsets[1].y + offsets[2].y),
+                    2 * offsets[0].x, 2 * offsets[0].y));
+                double dx = offsets[2].x - offsets[1].x;
+                double dy = offsets[2].y - offsets[1].y;
+                CHECK(std::sqrt(dx * dx + dy * dy) > thickness);
+                CHECK(quadrant % 2 == 0 ? std::fabs(dx) < 1e-9 : std::fabs(dy) < 1e-9);
+            }
+        }
+    }
+}
+
+
+int main() {
+    checkQuadrants();
+    checkWallPanelConnectors();
+    checkCornerPostConnectors();
+    checkWalerConnectors();
+    checkStackedConnectors();
+    checkStacked15Connectors();
+    checkTieSets();
+    return testResult("OrientationTest");
+}
@@ -0,0 +1,149 @@
+// PanelFillSolverTest.cpp
+// Panel mix table: optimal against an exhaustive search, never worse than the greedy fill it
+// replaced, compensators arranged in the middle, and throughput on 100k random run lengths.
+#include "TestCheck.h"
+#include "AssetPlacer/PanelFillSolver.h"
+#include <chrono>
+#include <cstdint>
+
+static const std::vector<int> catalogue = { 600, 450, 300, 150, 100, 50 };
+
+
+// Fill of the old placers: as many of each width as fit, largest first
+static void greedyFill(int length, int& pieces, int& covered) {
+    pieces = 0;
+    covered = 0;
+    int remaining = length;
+    for (int width : catalogue) {
+        int count = remaining / width;
+        pieces += count;
+        covered += count * width;
+        remaining -= count * width;
+    }
+}
+
+
+// Fewest pieces, then fewest compensators, over every combination of up to 12 pieces
+static void exhaustiveBest(int length, size_t first, int pieces, int compensators, int& bestPieces, int& bestCompensators) {
+    if (length == 0) {
+        if (bestPieces < 0 || pieces < bestPieces || (pieces == bestPieces && compensators < bestCompensators)) {
+            bestPieces = pieces;
+            bestCompensators = compensators;
+        }
+        return;
+    }
+    if (pieces >= 12) {
+        return;
+    }
+    for (size_t i = first; i < catalogue.size(); ++i) {
+        if (catalogue[i] <= length) {
+            exhaustiveBest(length - catalogue[i], i, pieces + 1, compensators + (catalogue[i] <= 150 ? 1 : 0),
+                bestPieces, bestCompensators);
+        }
+    }
+}
+
+
+static void checkOptimal() {
+    PanelFillSolver solver(catalogue);
+    size_t different = 0;
+    for (int length = 50; length <= 4000; length += 50) {
+        const PanelFillSolver::Mix& mix = solver.solve(length + 20.0);
+        int bestPieces = -1;
+        int bestCompensators = 0;
+        exhaustiveBest(length, 0, 0, 0, bestPieces, bestCompensators);
+        int countedLength = 0;
+        for (size_t i = 0; i < catalogue.size(); ++i) {
+            countedLength += mix.counts[i] * catalogue[i];
+        }
+        if (mix.length != length || countedLength != length || mix.pieces != bestPieces || mix.compensators != bestCompensators) {
+            different++;
+        }
+    }
+    CHECK(different == 0);
+
+    CHECK(solver.solve(0.0).pieces == 0);
+    CHECK(solver.solve(49.0).length == 0);
+    CHECK(solver.solve(1050.0).pieces == 2);        // 600 + 450
+    CHECK(solver.solve(1050.0).compensators == 0);
+}
+
+
+static void checkAgainstGreedy() {
+    PanelFillSolver solver(catalogue);
+    size_t worse = 0;
+    for (int length = 0; length <= 30000; length += 10) {
+        int greedyPieces;
+        int greedyCovered;
+        greedyFill(length, greedyPieces, greedyCovered);
+        const PanelFillSolver::Mix& mix = solver.solve(length);
+        if (mix.length != greedyCovered || mix.pieces > greedyPieces) {
+            worse++;
+        }
+    }
+    CHECK(worse == 0);
+}
+
+
+static void checkArrange() {
+    // 4 x 600 + 100: the compensator between the full panels
+    PanelFillSolver solver(catalogue);
+    const PanelFillSolver::Mix& mix = solver.solve(2500.0);
+    CHECK(mix.pieces == 5 && mix.compensators == 1);
+    std::vector<int> order;
+    solver.arrange(mix, order);
+    CHECK(order.size() == 5);
+    if (order.size() == 5) {
+        CHECK(!solver.isCompensator(order.front()) && !solver.isCompensator(order.back()));
+        CHECK(solver.isCompensator(order[2]));
+        int length = 0;
+        for (int index : order) {
+            length += catalogue[index];
+        }
+        CHECK(length == 2500);
+    }
+}
+
+
+static void timeRandomLengths() {
+    const int runs = 100000;
+    std::vector<double> lengths;
+    std::uint32_t state = 12345;
+    for (int i = 0; i < runs; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        lengths.push_back(static_cast<double>(state % 30000));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    long long greedyPieces = 0;
+    for (double length : lengths) {
+        int pieces;
+        int covered;
+        greedyFill(static_cast<int>(length), pieces, covered);
+        greedyPieces += pieces;
+    }
+    double greedyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    PanelFillSolver solver(catalogue);
+    long long solverPieces = 0;
+    for (double length : lengths) {
+        solverPieces += solver.solve(length).pieces;
+    }
+    double solverMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    CHECK(solverPieces <= greedyPieces);
+    std::cout << runs << " runs: greedy " << greedyMs << " ms, " << greedyPieces << " pieces; table "
+        << solverMs << " ms including the build, " << solverPieces << " pieces\n";
+}
+
+
+int main() {
+    checkOptimal();
+    checkAgainstGreedy();
+    checkArrange();
+    timeRandomLengths();
+    return testResult("PanelFillSolverTest");
+}
@@ -0,0 +1,112 @@
+// PointMapTest.cpp
+// Quantised point keys and the open addressing map, and lookups timed against the std::map
+// with an exact coordinate comparator it replaced.
+#include "TestCheck.h"
+#include "AssetPlacer/PointKey.h"
+#include "AssetPlacer/PlanGeometry.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+
+struct ExactComparator {
+    bool operator()(const PlanPoint& lhs, const PlanPoint& rhs) const {
+        if (lhs.x != rhs.x)
+            return lhs.x < rhs.x;
+        if (lhs.y != rhs.y)
+            return lhs.y < rhs.y;
+        return lhs.z < rhs.z;
+    }
+};
+
+
+static void checkKeys() {
+    PlanPoint point = makePlanPoint(1234.5, -678.9, 2700.0);
+    CHECK(PointKey::of(point) == PointKey::of(1234.5 + 1e-7, -678.9 - 1e-7, 2700.0));
+    CHECK(PointKey::of(point) != PointKey::of(1234.7, -678.9, 2700.0));
+    CHECK(PointKey::of(point) != PointKey::of(1234.5, -678.9, 0.0));
+    CHECK(PointKey::of(point, 1000.0) == PointKey::of(1400.0, -900.0, 2600.0, 1000.0));
+}
+
+
+static void checkMap() {
+    PointMap<int> map;
+    CHECK(map.empty());
+    CHECK(map.find(PointKey::of(0.0, 0.0, 0.0)) == nullptr);
+
+    // Enough entries for several rehashes
+    for (int i = 0; i < 5000; ++i) {
+        map[PointKey::of(i * 10.0, i * -3.0, 0.0)] = i;
+    }
+    CHECK(map.size() == 5000);
+    size_t missing = 0;
+    for (int i = 0; i < 5000; ++i) {
+        const int* value = map.find(PointKey::of(i * 10.0 + 1e-6, i * -3.0, 0.0));
+        missing += value && *value == i ? 0 : 1;
+    }
+    CHECK(missing == 0);
+    CHECK(!map.contains(PointKey::of(5.0, 0.0, 0.0)));
+
+    // operator[] on an existing key keeps the entry
+    map[PointKey::of(10.0, -3.0, 0.0)] += 100;
+    CHECK(map.size() == 5000);
+    CHECK(*map.find(PointKey::of(10.0, -3.0, 0.0)) == 101);
+
+    size_t visited = 0;
+    long long sum = 0;
+    map.forEach([&](const PointKey&, int value) {
+        visited++;
+        sum += value;
+    });
+    CHECK(visited == 5000);
+    CHECK(sum == 4999LL * 5000 / 2 + 100);
+
+    map.clear();
+    CHECK(map.empty() && !map.contains(PointKey::of(10.0, -3.0, 0.0)));
+}
+
+
+static void timeLookups() {
+    const int count = 200000;
+    std::vector<PlanPoint> points;
+    std::uint32_t state = 99;
+    for (int i = 0; i < count; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        points.push_back(makePlanPoint((state % 100000) * 1.0, (state / 100000 % 100000) * 1.0, 0.0));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    PointMap<int> pointMap;
+    for (int i = 0; i < count; ++i) {
+        pointMap[PointKey::of(points[i])] = i;
+    }
+    size_t pointMapFound = 0;
+    for (const PlanPoint& point : points) {
+        pointMapFound += pointMap.contains(PointKey::of(point.x + 1e-7, point.y, point.z)) ? 1 : 0;
+    }
+    double pointMapMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::map<PlanPoint, int, ExactComparator> exactMap;
+    for (int i = 0; i < count; ++i) {
+        exactMap[points[i]] = i;
+    }
+    size_t exactFound = 0;
+    for (const PlanPoint& point : points) {
+        exactFound += exactMap.count(makePlanPoint(point.x + 1e-7, point.y, point.z));
+    }
+    double exactMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    CHECK(pointMapFound == points.size());
+    std::cout << count << " points: PointMap " << pointMapMs << " ms (" << pointMapFound << " found with jitter), std::map "
+        << exactMs << " ms (" << exactFound << " found)\n";
+}
+
+
+int main() {
+    checkKeys();
+    checkMap();
+    timeLookups();
+    return testResult("PointMapTest");
+}
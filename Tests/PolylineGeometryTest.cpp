@@ -0,0 +1,110 @@
+// PolylineGeometryTest.cpp
+// Corner extraction on plan points against the AcGePoint3d code it was ported from: close
+// vertices dropped against their predecessor, the closing vertex, loop direction, and
+// polylines left with fewer than three corners.
+#include "TestCheck.h"
+#include "AssetPlacer/PolylineGeometry.h"
+#include <cstdint>
+
+// filterClosePoints as GeometryUtils wrote it on AcGePoint3d: a second vector, each vertex
+// compared with the one before it in the input
+static PlanLoop referenceFilter(const PlanLoop& vertices, double tolerance) {
+    auto distance = [](const PlanPoint& a, const PlanPoint& b) {
+        return std::sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
+    };
+    PlanLoop filtered;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        if (i == 0 || distance(vertices[i], vertices[i - 1]) > tolerance) {
+            filtered.push_back(vertices[i]);
+        }
+    }
+    if (filtered.size() > 1 && distance(filtered.back(), filtered.front()) <= tolerance) {
+        filtered.pop_back();
+    }
+    return filtered;
+}
+
+
+static bool sameLoop(const PlanLoop& a, const PlanLoop& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].z != b[i].z) return false;
+    }
+    return true;
+}
+
+
+static void checkFilter() {
+    // A run of vertices 0.1 apart is compared pairwise, so it is dropped after its first vertex
+    // even where it has moved further than the tolerance from the vertex kept
+    PlanLoop vertices = { makePlanPoint(0, 0), makePlanPoint(1000, 0), makePlanPoint(1000.1, 0),
+        makePlanPoint(1000.2, 0), makePlanPoint(1000.3, 0), makePlanPoint(1000, 1000), makePlanPoint(0, 1000),
+        makePlanPoint(0.05, 0) };
+    PlanLoop filtered = vertices;
+    filterClosePoints(filtered, 0.19);
+    CHECK(filtered.size() == 4);
+    CHECK(filtered[1].x == 1000 && filtered[2].y == 1000);
+    CHECK(sameLoop(filtered, referenceFilter(vertices, 0.19)));
+
+    PlanLoop empty;
+    filterClosePoints(empty, 0.19);
+    CHECK(empty.empty());
+
+    // Random loops with clusters of close vertices give what the old code gave
+    std::uint32_t state = 17;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+    size_t different = 0;
+    for (int loop = 0; loop < 200; ++loop) {
+        PlanLoop random;
+        size_t count = 3 + next() % 40;
+        for (size_t i = 0; i < count; ++i) {
+            PlanPoint point = makePlanPoint((next() % 2000) * 0.1, (next() % 2000) * 0.1);
+            random.push_back(point);
+            if (next() % 3 == 0) {
+                random.push_back(makePlanPoint(point.x + (next() % 3) * 0.1, point.y));
+            }
+        }
+        PlanLoop ported = random;
+        filterClosePoints(ported, 0.19);
+        different += sameLoop(ported, referenceFilter(random, 0.19)) ? 0 : 1;
+    }
+    CHECK(different == 0);
+}
+
+
+static void checkDirection() {
+    PlanLoop counterClockwise = { makePlanPoint(0, 0), makePlanPoint(100, 0), makePlanPoint(100, 100), makePlanPoint(0, 100) };
+    PlanLoop clockwise(counterClockwise.rbegin(), counterClockwise.rend());
+    CHECK(!isPolylineClockwise(counterClockwise));
+    CHECK(isPolylineClockwise(clockwise));
+    CHECK(!isPolylineClockwise(PlanLoop { makePlanPoint(0, 0), makePlanPoint(100, 0), makePlanPoint(200, 0) }));
+}
+
+
+static void checkProcessPolyline() {
+    // A four vertex polyline read with its first vertex repeated at the end, as detectVertices does
+    PlanLoop vertices = { makePlanPoint(0, 0), makePlanPoint(3000, 0), makePlanPoint(3000, 2000),
+        makePlanPoint(0, 2000), makePlanPoint(0, 0) };
+    PlanLoop corners = { makePlanPoint(-1, -1) };
+    processPolyline(vertices, corners, 0.1);
+    CHECK(corners.size() == 5);
+    CHECK(corners[1].x == 0 && corners[2].x == 3000 && corners[4].y == 2000);
+
+    PlanLoop sliver = { makePlanPoint(0, 0), makePlanPoint(0.05, 0), makePlanPoint(500, 0) };
+    PlanLoop none;
+    processPolyline(sliver, none, 0.1);
+    CHECK(none.empty());
+}
+
+
+int main() {
+    checkFilter();
+    checkDirection();
+    checkProcessPolyline();
+    return testResult("PolylineGeometryTest");
+}
@@ -0,0 +1,25 @@
+// TestCheck.h
+#pragma once
+
+#include <iostream>
+
+// Minimal checks for the headless tests. A failed CHECK prints its location and the test
+// keeps going; main returns testResult() so ctest sees the failure.
+static int testFailures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+            testFailures++; \
+        } \
+    } while (0)
+
+inline int testResult(const char* name) {
+    if (testFailures > 0) {
+        std::cerr << name << ": " << testFailures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << name << ": passed\n";
+    return 0;
+}
@@ -0,0 +1,117 @@
+// TransformComposerTest.cpp
+// Composed placement against the rotations applied one after another, the cache of angle
+// combinations, and the 4x4 write into a minimal matrix type.
+#include "TestCheck.h"
+#include "AssetPlacer/TransformComposer.h"
+#include <cmath>
+
+static const double pi = 3.141592653589793;
+
+// Smallest matrix type write() accepts: a (row, column) accessor
+struct Matrix4 {
+    double values[4][4];
+    double& operator()(unsigned row, unsigned column) { return values[row][column]; }
+};
+
+struct Vector3 {
+    double x, y, z;
+};
+
+
+// One rotation about a model axis through the insertion point, as rotateAroundX/Y/ZAxis does
+static Vector3 rotateAbout(int axis, double angle, const Vector3& v) {
+    double c = std::cos(angle);
+    double s = std::sin(angle);
+    if (axis == 0) return { v.x, c * v.y - s * v.z, s * v.y + c * v.z };
+    if (axis == 1) return { c * v.x + s * v.z, v.y, -s * v.x + c * v.z };
+    return { c * v.x - s * v.y, s * v.x + c * v.y, v.z };
+}
+
+
+// setScaleFactors, setRotation, then the X, Y and Z axis rotations, one at a time
+static Vector3 placeStepByStep(const Vector3& local, double rotation, double rotationX, double rotationY, double rotationZ, double scale) {
+    Vector3 v = { local.x * scale, local.y * scale, local.z * scale };
+    v = rotateAbout(2, rotation, v);
+    v = rotateAbout(0, rotationX, v);
+    v = rotateAbout(1, rotationY, v);
+    return rotateAbout(2, rotationZ, v);
+}
+
+
+static Vector3 apply(const LinearTransform& linear, const Vector3& v) {
+    return { linear.m[0][0] * v.x + linear.m[0][1] * v.y + linear.m[0][2] * v.z,
+        linear.m[1][0] * v.x + linear.m[1][1] * v.y + linear.m[1][2] * v.z,
+        linear.m[2][0] * v.x + linear.m[2][1] * v.y + linear.m[2][2] * v.z };
+}
+
+
+static bool near(const Vector3& a, const Vector3& b) {
+    return std::fabs(a.x - b.x) < 1e-9 && std::fabs(a.y - b.y) < 1e-9 && std::fabs(a.z - b.z) < 1e-9;
+}
+
+
+static void checkAgainstSteps() {
+    // The combinations the stacked connectors use, and a few arbitrary ones
+    const double angles[] = { 0.0, pi / 2, pi, 3 * pi / 2, 0.3, -1.1 };
+    const Vector3 local = { 50.0, -75.0, 120.0 };
+    TransformComposer composer;
+    size_t different = 0;
+    for (double rotation : angles) {
+        for (double rotationX : angles) {
+            for (double rotationY : angles) {
+                for (double rotationZ : { 0.0, pi }) {
+                    const LinearTransform& linear = composer.compose(rotation, rotationX, rotationY, rotationZ, 2.0);
+                    Vector3 expected = placeStepByStep(local, rotation, rotationX, rotationY, rotationZ, 2.0);
+                    different += near(apply(linear, local), expected) ? 0 : 1;
+                }
+            }
+        }
+    }
+    CHECK(different == 0);
+    CHECK(composer.size() == 6 * 6 * 6 * 2);
+}
+
+
+static void checkCache() {
+    TransformComposer composer;
+    const LinearTransform& first = composer.compose(pi / 2, pi, 3 * pi / 2, 0.0, 1.0);
+    const LinearTransform& again = composer.compose(pi / 2 + 1e-12, pi, 3 * pi / 2, 0.0, 1.0);
+    CHECK(&first == &again);
+    CHECK(composer.size() == 1);
+    composer.compose(pi / 2, pi, 3 * pi / 2, 0.0, 2.0);
+    CHECK(composer.size() == 2);
+
+    // Quarter turns are exact
+    size_t inexact = 0;
+    for (const auto& row : first.m) {
+        for (double value : row) {
+            inexact += value == 0.0 || value == 1.0 || value == -1.0 ? 0 : 1;
+        }
+    }
+    CHECK(inexact == 0);
+}
+
+
+static void checkWrite() {
+    TransformComposer composer;
+    const LinearTransform& linear = composer.compose(pi / 2, 0.0, 0.0, 0.0, 1.0);
+    Matrix4 matrix;
+    for (auto& row : matrix.values) {
+        for (double& value : row) {
+            value = 99.0;
+        }
+    }
+    TransformComposer::write(linear, 10.0, 20.0, 30.0, matrix);
+    CHECK(matrix.values[0][3] == 10.0 && matrix.values[1][3] == 20.0 && matrix.values[2][3] == 30.0);
+    CHECK(matrix.values[3][0] == 0.0 && matrix.values[3][1] == 0.0 && matrix.values[3][2] == 0.0);
+    CHECK(matrix.values[3][3] == 1.0);
+    CHECK(matrix.values[0][1] == -1.0 && matrix.values[1][0] == 1.0 && matrix.values[2][2] == 1.0);
+}
+
+
+int main() {
+    checkAgainstSteps();
+    checkCache();
+    checkWrite();
+    return testResult("TransformComposerTest");
+}
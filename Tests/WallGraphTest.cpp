@@ -0,0 +1,201 @@
+// WallGraphTest.cpp
+// Wall centreline graph of L, T and cross shaped walls and of rooms sharing walls: the joint
+// each node is, the walls and thickness behind the loop edges, the corners the corner placers
+// get from the joints, and ties on one face of every wall, through the wall.
+#include "TestCheck.h"
+#include "AssetPlacer/WallGraph.h"
+#include "AssetPlacer/CornerLayout.h"
+#include "AssetPlacer/LayoutDriver.h"
+#include "AssetPlacer/PolylineGeometry.h"
+#include "AssetPlacer/Orientation.h"
+#include "Tie/TieLayout.h"
+#include <cmath>
+#include <initializer_list>
+#include <set>
+
+static PlanLoop loopOf(std::initializer_list<double> xy) {
+    PlanLoop loop;
+    for (const double* it = xy.begin(); it != xy.end(); it += 2) {
+        loop.push_back(makePlanPoint(it[0], it[1], 0));
+    }
+    return loop;
+}
+
+static const PlanLoop lWall = loopOf({ 0, 0, 3000, 0, 3000, 200, 200, 200, 200, 3000, 0, 3000 });
+static const PlanLoop tWall = loopOf({ 0, 0, 4000, 0, 4000, 200, 2100, 200, 2100, 3000, 1900, 3000, 1900, 200, 0, 200 });
+static const PlanLoop crossWall = loopOf({ 1900, 0, 2100, 0, 2100, 1900, 4000, 1900, 4000, 2100, 2100, 2100,
+    2100, 4000, 1900, 4000, 1900, 2100, 0, 2100, 0, 1900, 1900, 1900 });
+
+// Ring of 200 walls round two rooms side by side, or four in a grid
+static std::vector<PlanLoop> rooms(bool grid) {
+    std::vector<PlanLoop> loops = { loopOf({ 0, 0, 6200, 0, 6200, grid ? 6200.0 : 4200.0, 0, grid ? 6200.0 : 4200.0 }) };
+    double top = grid ? 3000 : 4000;
+    loops.push_back(loopOf({ 200, 200, 3000, 200, 3000, top, 200, top }));
+    loops.push_back(loopOf({ 3200, 200, 6000, 200, 6000, top, 3200, top }));
+    if (grid) {
+        loops.push_back(loopOf({ 200, 3200, 3000, 3200, 3000, 6000, 200, 6000 }));
+        loops.push_back(loopOf({ 3200, 3200, 6000, 3200, 6000, 6000, 3200, 6000 }));
+    }
+    return loops;
+}
+
+struct Plan {
+    std::vector<PlanLoop> loops;
+    LoopHierarchy hierarchy;
+    WallGraph graph;
+
+    explicit Plan(const std::vector<PlanLoop>& planLoops) : loops(planLoops) {
+        hierarchy.build(loops);
+        graph.build(loops, hierarchy);
+    }
+
+    int count(WallNodeType type) const {
+        int found = 0;
+        for (const WallNode& node : graph.nodes()) {
+            found += node.type == type ? 1 : 0;
+        }
+        return found;
+    }
+};
+
+
+static bool isAt(const PlanPoint& point, double x, double y) {
+    return std::fabs(point.x - x) < 1e-6 && std::fabs(point.y - y) < 1e-6;
+}
+
+
+static void checkJoints() {
+    Plan l({ lWall });
+    CHECK(l.graph.edges().size() == 2);
+    CHECK(l.count(WallNodeType::Corner) == 1 && l.count(WallNodeType::End) == 2);
+    for (const WallEdge& wall : l.graph.edges()) {
+        CHECK(wall.thickness == 200);
+        CHECK(!wall.leftFaces.empty() && !wall.rightFaces.empty());
+    }
+    // Both faces of the first leg are the same wall, the end caps face none
+    CHECK(l.graph.wallOf(0, 0) >= 0 && l.graph.wallOf(0, 0) == l.graph.wallOf(0, 2));
+    CHECK(l.graph.wallOf(0, 1) < 0);
+    CHECK(l.graph.wallOf(0, 0) != l.graph.wallOf(0, 3));
+    // The re-entrant vertex and the outside corner belong to the corner node, the legs' far
+    // corners to their ends
+    int corner = l.graph.jointOf(0, 3, lWall[3]);
+    CHECK(corner >= 0 && l.graph.nodes()[corner].type == WallNodeType::Corner);
+    CHECK(corner >= 0 && isAt(l.graph.nodes()[corner].position, 100, 100));
+    CHECK(l.graph.jointOf(0, 0, lWall[0]) == corner);
+    int end = l.graph.jointOf(0, 1, lWall[1]);
+    CHECK(end >= 0 && l.graph.nodes()[end].type == WallNodeType::End);
+
+    Plan t({ tWall });
+    CHECK(t.graph.edges().size() == 3);
+    CHECK(t.count(WallNodeType::TJoint) == 1 && t.count(WallNodeType::End) == 3);
+    int joint = t.graph.jointOf(0, 3, tWall[3]);
+    CHECK(joint >= 0 && t.graph.nodes()[joint].type == WallNodeType::TJoint && t.graph.nodes()[joint].walls.size() == 3);
+    CHECK(t.graph.jointOf(0, 6, tWall[6]) == joint);
+    // The flat face runs past the joint: its ends still belong to the ends of the wall
+    int far = t.graph.jointOf(0, 1, tWall[1]);
+    CHECK(far >= 0 && t.graph.nodes()[far].type == WallNodeType::End);
+
+    Plan cross({ crossWall });
+    CHECK(cross.graph.edges().size() == 4);
+    CHECK(cross.count(WallNodeType::Cross) == 1 && cross.count(WallNodeType::End) == 4);
+    for (int vertex : { 2, 5, 8, 11 }) {
+        int node = cross.graph.jointOf(0, vertex, crossWall[vertex]);
+        CHECK(node >= 0 && cross.graph.nodes()[node].type == WallNodeType::Cross);
+    }
+    for (const WallEdge& wall : cross.graph.edges()) {
+        CHECK(wall.thickness == 200);
+    }
+
+    Plan twoRooms(rooms(false));
+    CHECK(twoRooms.count(WallNodeType::TJoint) == 2 && twoRooms.count(WallNodeType::Cross) == 0);
+    CHECK(twoRooms.graph.dominantThickness() == 200);
+    Plan fourRooms(rooms(true));
+    CHECK(fourRooms.count(WallNodeType::TJoint) == 4 && fourRooms.count(WallNodeType::Cross) == 1);
+}
+
+
+// Corner posts go at the joints only, never at the end of a wall
+static void checkCorners() {
+    struct Case {
+        std::vector<PlanLoop> loops;
+        int inside;
+        int outside;
+    };
+    const Case cases[] = {
+        { { lWall }, 1, 1 }, { { tWall }, 2, 0 }, { { crossWall }, 4, 0 }, { rooms(false), 8, 4 }, { rooms(true), 16, 4 }
+    };
+    for (const Case& test : cases) {
+        Plan plan(test.loops);
+        std::vector<WallCorner> corners;
+        CornerLayout::corners(plan.loops, plan.hierarchy, plan.graph, corners);
+        int inside = 0;
+        int outside = 0;
+        for (const WallCorner& corner : corners) {
+            (corner.inside ? inside : outside)++;
+            CHECK(corner.node >= 0);
+            if (corner.node >= 0) {
+                WallNodeType type = plan.graph.nodes()[corner.node].type;
+                CHECK(type != WallNodeType::End && type != WallNodeType::Inline);
+            }
+        }
+        CHECK(inside == test.inside && outside == test.outside);
+    }
+}
+
+
+// Ties through the wall material, all from one face of each wall
+static void checkTies() {
+    const std::vector<PlanLoop> plans[] = { { lWall }, { tWall }, { crossWall }, rooms(false), rooms(true) };
+    for (const std::vector<PlanLoop>& loops : plans) {
+        Plan plan(loops);
+        PlanInput input;
+        input.loops = loops;
+        input.wallThickness = 200;
+        input.wallHeight = 1350;
+        LayoutPlan layout;
+        LayoutDriver::run(input, layout, 1);
+
+        std::vector<TieAnchor> ties;
+        TieLayout::build(layout, plan.graph, ties);
+        CHECK(!ties.empty());
+        for (const TieAnchor& tie : ties) {
+            CHECK(tie.thickness == 200);
+            TiePart parts[3];
+            TieLayout::parts(tie.thickness, tie.waler, parts);
+            PlanPoint offset = orient(orientations[tie.quadrant], parts[0].offset);
+            PlanPoint through = makePlanPoint(tie.position.x + offset.x, tie.position.y + offset.y, 0);
+            int depth = 0;
+            for (const PlanLoop& loop : loops) {
+                depth += isPointInsideLoop(through, loop) ? 1 : 0;
+            }
+            CHECK(depth % 2 == 1);
+        }
+
+        // Every tied run is on the same side of its wall as the other tied runs
+        std::set<std::pair<int, bool>> sides;
+        for (const LayoutRun& run : layout.runs) {
+            double thickness = 0.0;
+            int wall = plan.graph.wallOf(run.loop, run.edge);
+            if (wall < 0 || !TieLayout::tieFace(run, plan.graph, thickness)) {
+                continue;
+            }
+            bool left = false;
+            for (const WallFaceRef& face : plan.graph.edges()[wall].leftFaces) {
+                left = left || (face.loop == run.loop && face.edge == run.edge);
+            }
+            sides.insert({ wall, left });
+        }
+        std::set<int> walls;
+        for (const std::pair<int, bool>& side : sides) {
+            CHECK(walls.insert(side.first).second);
+        }
+    }
+}
+
+
+int main() {
+    checkJoints();
+    checkCorners();
+    checkTies();
+    return testResult("WallGraphTest");
+}
@@ -0,0 +1,62 @@
+// WallLayoutDeterminismTest.cpp
+// The wall layout fills runs on several workers; the plan must not depend on the thread count.
+#include "TestCheck.h"
+#include "AssetPlacer/LayoutDriver.h"
+#include "AssetPlacer/PlanGenerator.h"
+
+static bool samePoint(const PlanPoint& a, const PlanPoint& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+
+static bool sameItem(const LayoutItem& a, const LayoutItem& b) {
+    return a.type == b.type && a.width == b.width && a.height == b.height && samePoint(a.position, b.position)
+        && a.rotation == b.rotation && a.loop == b.loop && a.isOuterLoop == b.isOuterLoop;
+}
+
+
+static bool sameRun(const LayoutRun& a, const LayoutRun& b) {
+    return samePoint(a.start, b.start) && a.dx == b.dx && a.dy == b.dy && a.dz == b.dz && a.rotation == b.rotation
+        && a.distance == b.distance && a.thickness == b.thickness && a.loop == b.loop && a.edge == b.edge
+        && a.isOuterLoop == b.isOuterLoop && a.insideFace == b.insideFace
+        && a.firstItem == b.firstItem && a.itemCount == b.itemCount;
+}
+
+
+static void checkSamePlan(const LayoutPlan& expected, const LayoutPlan& actual) {
+    CHECK(expected.items.size() == actual.items.size());
+    CHECK(expected.runs.size() == actual.runs.size());
+    size_t differentItems = 0;
+    for (size_t i = 0; i < expected.items.size() && i < actual.items.size(); ++i) {
+        differentItems += sameItem(expected.items[i], actual.items[i]) ? 0 : 1;
+    }
+    size_t differentRuns = 0;
+    for (size_t i = 0; i < expected.runs.size() && i < actual.runs.size(); ++i) {
+        differentRuns += sameRun(expected.runs[i], actual.runs[i]) ? 0 : 1;
+    }
+    CHECK(differentItems == 0);
+    CHECK(differentRuns == 0);
+}
+
+
+static void checkPlan(const PlanInput& plan) {
+    LayoutPlan single;
+    LayoutDriver::run(plan, single, 1);
+    CHECK(!single.items.empty());
+
+    const unsigned threadCounts[] = { 1, 2, 3, 8 };
+    for (unsigned threads : threadCounts) {
+        LayoutPlan parallel;
+        LayoutDriver::run(plan, parallel, threads);
+        checkSamePlan(single, parallel);
+    }
+}
+
+
+int main() {
+    PlanGenerator generator(7);
+    checkPlan(generator.apartments(20, 20));
+    checkPlan(generator.site(500));
+    checkPlan(generator.courtyard());
+    return testResult("WallLayoutDeterminismTest");
+}
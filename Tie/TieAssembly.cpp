@@ -0,0 +1,161 @@
+#include "StdAfx.h"
+#include "TieAssembly.h"
+#include "TieLayout.h"
+#include "DefineScale.h"
+#include "Blocks/AssetRegistry.h"
+#include "Blocks/DrawingOptions.h"
+#include "dbapserv.h"
+#include "dbents.h"
+#include "dbsymtb.h"
+#include "acutads.h"
+#include <vector>
+#include <algorithm>
+#include <cwchar>
+#include "Profiler.h"
+
+static const ACHAR* optionKey = _T("PERI_TIE_ASSEMBLY");
+static const wchar_t* blockPrefix = L"PeriTie_";
+
+
+bool TieAssembly::enabled(AcDbDatabase* pDb) {
+    return DrawingOptions::flag(pDb, optionKey, false);
+}
+
+
+bool TieAssembly::setEnabled(AcDbDatabase* pDb, bool enabled) {
+    return DrawingOptions::setFlag(pDb, optionKey, enabled);
+}
+
+
+AcDbObjectId TieAssembly::definition(AcDbDatabase* pDb, const std::wstring& tieName, AcDbObjectId tieId,
+    AcDbObjectId wingnutId, double wallThickness, bool waler) {
+
+    if (!pDb || tieId.isNull() || wingnutId.isNull()) {
+        return AcDbObjectId::kNull;
+    }
+
+    double scale = globalVarScale.sx;
+    wchar_t blockName[128];
+    swprintf(blockName, 128, L"%s%s_%d%s_%g", blockPrefix, tieName.c_str(),
+        static_cast<int>(wallThickness), waler ? L"_W" : L"", scale);
+
+    AcDbObjectId blockId = AssetRegistry::resolve(pDb, blockName);
+    if (!blockId.isNull()) {
+        return blockId;
+    }
+
+    AssetRegistry::DefinitionScope definitionScope;
+    AcDbBlockTable* pBlockTable;
+    Profiler::count(ProfileCounter::BlockTableOpens);
+    if (pDb->getBlockTable(pBlockTable, AcDb::kForWrite) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to open block table for write."));
+        return AcDbObjectId::kNull;
+    }
+
+    AcDbBlockTableRecord* pRecord = new AcDbBlockTableRecord();
+    pRecord->setName(blockName);
+    pRecord->setOrigin(AcGePoint3d::kOrigin);
+    if (pBlockTable->add(blockId, pRecord) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to add the tie assembly block."));
+        delete pRecord;
+        pBlockTable->close();
+        return AcDbObjectId::kNull;
+    }
+    pBlockTable->close();
+
+    // The assembly reference carries the drawing scale, so the offsets inside it are
+    // divided by it and the nested references are unscaled
+    TiePart parts[3];
+    TieLayout::parts(wallThickness, waler, parts);
+    for (int partNum = 0; partNum < 3; ++partNum) {
+        const TiePart& part = parts[partNum];
+        AcDbBlockReference* pPart = new AcDbBlockReference();
+        pPart->setPosition(AcGePoint3d(part.offset.x / scale, part.offset.y / scale, 0.0));
+        pPart->setBlockTableRecord(partNum == 0 ? tieId : wingnutId);
+        pPart->setRotation(part.rotation);
+        if (pRecord->appendAcDbEntity(pPart) != Acad::eOk) {
+            delete pPart;
+            continue;
+        }
+        pPart->close();
+    }
+    pRecord->close();
+    return blockId;
+}
+
+
+int TieAssembly::explodeAll(AcDbDatabase* pDb) {
+    if (!pDb) {
+        return -1;
+    }
+
+    AcDbBlockTable* pBlockTable;
+    Profiler::count(ProfileCounter::BlockTableOpens);
+    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to get block table."));
+        return -1;
+    }
+
+    AcDbBlockTableRecord* pModelSpace;
+    if (pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to get model space."));
+        pBlockTable->close();
+        return -1;
+    }
+    pBlockTable->close();
+
+    AcDbBlockTableRecordIterator* pIter;
+    if (pModelSpace->newIterator(pIter) != Acad::eOk) {
+        pModelSpace->close();
+        return -1;
+    }
+
+    // Assembly definitions are looked up once, then references are matched by id
+    std::vector<AcDbObjectId> assemblies;
+    std::vector<AcDbObjectId> knownOther;
+    std::vector<AcDbObjectId> references;
+    for (pIter->start(); !pIter->done(); pIter->step()) {
+        AcDbEntity* pEnt;
+        Profiler::count(ProfileCounter::ObjectsOpened);
+        if (pIter->getEntity(pEnt, AcDb::kForRead) != Acad::eOk) {
+            continue;
+        }
+        AcDbBlockReference* pRef = AcDbBlockReference::cast(pEnt);
+        if (pRef) {
+            AcDbObjectId blockId = pRef->blockTableRecord();
+            bool isAssembly = std::find(assemblies.begin(), assemblies.end(), blockId) != assemblies.end();
+            if (!isAssembly && std::find(knownOther.begin(), knownOther.end(), blockId) == knownOther.end()) {
+                AcDbBlockTableRecord* pBlock;
+                const ACHAR* blockName = nullptr;
+                Profiler::count(ProfileCounter::ObjectsOpened);
+                if (acdbOpenObject(pBlock, blockId, AcDb::kForRead) == Acad::eOk) {
+                    pBlock->getName(blockName);
+                    isAssembly = blockName && wcsncmp(blockName, blockPrefix, wcslen(blockPrefix)) == 0;
+                    pBlock->close();
+                }
+                (isAssembly ? assemblies : knownOther).push_back(blockId);
+            }
+            if (isAssembly) {
+                references.push_back(pRef->objectId());
+            }
+        }
+        pEnt->close();
+    }
+    delete pIter;
+    pModelSpace->close();
+
+    int exploded = 0;
+    for (const AcDbObjectId& referenceId : references) {
+        AcDbBlockReference* pRef;
+        Profiler::count(ProfileCounter::ObjectsOpened);
+        if (acdbOpenObject(pRef, referenceId, AcDb::kForWrite) != Acad::eOk) {
+            continue;
+        }
+        if (pRef->explodeToOwnerSpace() == Acad::eOk) {
+            pRef->erase();
+            exploded++;
+        }
+        pRef->close();
+    }
+    return exploded;
+}
@@ -0,0 +1,25 @@
+// TieAssembly.h
+#pragma once
+
+#include <string>
+#include "dbid.h"
+
+class AcDbDatabase;
+
+// Tie with both wingnuts as one nested block, so a tie position is a single reference
+// instead of three. One definition per tie asset, wall thickness, waler and scale.
+class TieAssembly {
+public:
+    // Per-drawing option (DrawingOptions), off unless switched on
+    static bool enabled(AcDbDatabase* pDb);
+    static bool setEnabled(AcDbDatabase* pDb, bool enabled);
+
+    // Definition inserted at the tie anchor with the panel rotation, holding the
+    // TieLayout::parts. Created on first use.
+    static AcDbObjectId definition(AcDbDatabase* pDb, const std::wstring& tieName, AcDbObjectId tieId,
+        AcDbObjectId wingnutId, double wallThickness, bool waler);
+
+    // Replaces every assembly reference in model space by its tie and wingnut references.
+    // Returns the number of assemblies exploded, -1 on failure.
+    static int explodeAll(AcDbDatabase* pDb);
+};
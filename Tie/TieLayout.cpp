@@ -0,0 +1,172 @@
+#include "TieLayout.h"
+#include "AssetPlacer/Orientation.h"
+#include <cmath>
+
+static const double pi = 3.141592653589793238462643383279;
+
+// Panels up to this width are compensators, gathered in the middle of a run
+static const int compensatorWidth = 150;
+
+// Panels up to this width are bridged by the columns beside them and get no ties
+static const int narrowPanelWidth = 100;
+
+// A 100 compensator moves the panel beside the group by this much and puts it on a waler
+static const int walerCompensatorWidth = 100;
+static const double walerShift = 50.0;
+
+// Tie distance from the panel edge, wingnut distance beyond the wall face, and the extra
+// wingnut distance through a waler
+static const double edgeOffset = 25.0;
+static const double wingnutClearance = 100.0;
+static const double walerWingnutOffset = 45.0;
+
+static const int lowerTieHeight = 300;
+static const int upperTieHeight = 1050;
+static const int singleTiePanelHeight = 600;
+
+
+static void addColumn(const LayoutPlan& plan, size_t firstItem, size_t lastItem,
+    double x, double y, double rotation, int quadrant, bool waler, double thickness, std::vector<TieAnchor>& ties) {
+
+    // The base panel and the panels stacked on it follow each other in the plan
+    for (size_t itemNum = firstItem; itemNum < lastItem; ++itemNum) {
+        const LayoutItem& item = plan.items[itemNum];
+        double bottom = item.position.z;
+        ties.push_back({ makePlanPoint(x, y, bottom + lowerTieHeight), rotation, quadrant, waler, thickness });
+        if (item.height != singleTiePanelHeight) {
+            ties.push_back({ makePlanPoint(x, y, bottom + upperTieHeight), rotation, quadrant, waler, thickness });
+        }
+    }
+}
+
+
+static bool hasFace(const std::vector<WallFaceRef>& faces, int loop, int edge) {
+    for (const WallFaceRef& face : faces) {
+        if (face.loop == loop && face.edge == edge) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+static bool hasOuterFace(const std::vector<WallFaceRef>& faces) {
+    for (const WallFaceRef& face : faces) {
+        if (face.outerFace) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool TieLayout::tieFace(const LayoutRun& run, const WallGraph& graph, double& thickness) {
+    thickness = run.thickness;
+    int wallNum = graph.wallOf(run.loop, run.edge);
+    if (wallNum < 0) {
+        return run.insideFace;
+    }
+
+    const WallEdge& wall = graph.edges()[wallNum];
+    thickness = wall.thickness;
+    bool tieLeft = hasOuterFace(wall.rightFaces) || !hasOuterFace(wall.leftFaces);
+    return hasFace(tieLeft ? wall.leftFaces : wall.rightFaces, run.loop, run.edge);
+}
+
+
+void TieLayout::build(const LayoutPlan& plan, const WallGraph& graph, std::vector<TieAnchor>& ties) {
+    std::vector<size_t> basePanels;
+    for (const LayoutRun& run : plan.runs) {
+        double thickness = 0.0;
+        if (run.itemCount == 0 || !tieFace(run, graph, thickness)) {
+            continue;
+        }
+
+        size_t runEnd = run.firstItem + run.itemCount;
+        basePanels.clear();
+        int firstCompensator = -1;
+        int compensators = 0;
+        int walerCompensators = 0;
+        for (size_t itemNum = run.firstItem; itemNum < runEnd; ++itemNum) {
+            const LayoutItem& item = plan.items[itemNum];
+            if (item.type != LayoutComponent::WallPanel) {
+                continue;
+            }
+            if (item.width <= compensatorWidth) {
+                if (firstCompensator < 0) {
+                    firstCompensator = static_cast<int>(basePanels.size());
+                }
+                compensators++;
+                if (item.width == walerCompensatorWidth) {
+                    walerCompensators++;
+                }
+            }
+            basePanels.push_back(itemNum);
+        }
+        if (basePanels.empty()) {
+            continue;
+        }
+
+        // Panels on the outer-oriented runs are anchored at their end, the others at their start
+        double rotation = run.isOuterLoop ? run.rotation : run.rotation - pi;
+        snapToRightAngle(rotation, 0.1);
+        if (rotation >= 2 * pi - 1e-9) {
+            rotation = 0.0;
+        }
+        int quadrant = orientationQuadrant(rotation);
+
+        int walerPanel = -1;
+        double walerOffset = 0.0;
+        if (walerCompensators > 0) {
+            if (!run.isOuterLoop) {
+                walerPanel = firstCompensator + compensators;
+                walerOffset = -walerShift * walerCompensators;
+            }
+            else if (firstCompensator > 0) {
+                walerPanel = firstCompensator - 1;
+                walerOffset = walerShift * walerCompensators;
+            }
+            if (walerPanel >= static_cast<int>(basePanels.size())) {
+                walerPanel = -1;
+            }
+        }
+
+        for (size_t panelNum = 0; panelNum < basePanels.size(); ++panelNum) {
+            const LayoutItem& panel = plan.items[basePanels[panelNum]];
+            if (panel.width <= narrowPanelWidth) {
+                continue;
+            }
+
+            double x = panel.position.x;
+            double y = panel.position.y;
+            if (!run.isOuterLoop) {
+                x -= run.dx * panel.width;
+                y -= run.dy * panel.width;
+            }
+            bool waler = static_cast<int>(panelNum) == walerPanel;
+            if (waler) {
+                x += run.dx * walerOffset;
+                y += run.dy * walerOffset;
+            }
+
+            size_t columnEnd = panelNum + 1 < basePanels.size() ? basePanels[panelNum + 1] : runEnd;
+            addColumn(plan, basePanels[panelNum], columnEnd, x, y, rotation, quadrant, waler, thickness, ties);
+        }
+
+        // Closing column on the edge of the run the panel anchors leave open
+        size_t lastPanel = basePanels.back();
+        const LayoutItem& last = plan.items[lastPanel];
+        double x = run.isOuterLoop ? run.start.x : last.position.x;
+        double y = run.isOuterLoop ? run.start.y : last.position.y;
+        addColumn(plan, lastPanel, runEnd, x, y, rotation, quadrant, false, thickness, ties);
+    }
+}
+
+
+void TieLayout::parts(double wallThickness, bool waler, TiePart (&parts)[3]) {
+    double tieY = wallThickness / 2;
+    double wingnutOffset = tieY + wingnutClearance + (waler ? walerWingnutOffset : 0.0);
+    parts[0] = { makePlanPoint(edgeOffset, tieY), pi / 2 };
+    parts[1] = { makePlanPoint(edgeOffset, tieY - wingnutOffset), 0.0 };
+    parts[2] = { makePlanPoint(edgeOffset, tieY + wingnutOffset), pi };
+}
@@ -0,0 +1,40 @@
+// TieLayout.h
+#pragma once
+
+#include "AssetPlacer/WallLayout.h"
+#include "AssetPlacer/WallGraph.h"
+#include <vector>
+
+// One tie through the wall, at the panel edge it clamps
+struct TieAnchor {
+    PlanPoint position;     // panel edge on the inside face, z = tie height
+    double rotation;        // panel rotation seen from the tie face, snapped to a quarter turn
+    int quadrant;           // rotation / 90 degrees, 0..3
+    bool waler;             // panel beside 100 compensators, bridged by a waler and a longer tie
+    double thickness;       // wall thickness the tie goes through
+};
+
+// Tie or wingnut of one tie set, relative to its anchor: offset in panel coordinates
+// (x along the panel, y across the wall), rotation added to the anchor rotation
+struct TiePart {
+    PlanPoint offset;
+    double rotation;
+};
+
+// Tie positions for an already computed wall layout. Each wall of `graph` is tied from one face:
+// the one away from the outside of the building, or the left one of a wall between two rooms.
+// Runs on faces the graph has no wall for fall back to the inside faces. One column goes at
+// every panel joint wider than a compensator plus one closing the run, with two ties per panel
+// height (one on 600 panels). Work is linear in the number of layout items; pure geometry, no
+// BRX dependencies.
+class TieLayout {
+public:
+    // `graph` built on the loops the plan was laid out from
+    static void build(const LayoutPlan& plan, const WallGraph& graph, std::vector<TieAnchor>& ties);
+
+    // Whether the ties of `run` go on it, and the thickness of the wall behind it
+    static bool tieFace(const LayoutRun& run, const WallGraph& graph, double& thickness);
+
+    // The tie, then the wingnut on each face; through a waler the wingnuts sit further out
+    static void parts(double wallThickness, bool waler, TiePart (&parts)[3]);
+};
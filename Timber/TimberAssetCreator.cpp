@@ -7,6 +7,7 @@
 #include "aced.h"
 #include "geassign.h"
 #include <sstream>
+#include "Profiler.h"
 
 
 AcDbObjectId TimberAssetCreator::createTimberAsset(double length, double height) {
@@ -19,6 +20,7 @@ AcDbObjectId TimberAssetCreator::createTimberAsset(double length, double height)
     }
 
     AcDbBlockTable* pBlockTable;
+    Profiler::count(ProfileCounter::BlockTableOpens);
     Acad::ErrorStatus es = pDb->getBlockTable(pBlockTable, AcDb::kForRead);
     if (es != Acad::eOk) {
         acutPrintf(_T("\nFailed to get block table for read. Error: %d"), es);
@@ -45,6 +47,7 @@ AcDbObjectId TimberAssetCreator::createTimberAsset(double length, double height)
     pBlockTable->close(); 
 
     
+    Profiler::count(ProfileCounter::BlockTableOpens);
     es = pDb->getBlockTable(pBlockTable, AcDb::kForWrite);
     if (es != Acad::eOk) {
         acutPrintf(_T("\nFailed to open block table for write. Error: %d"), es);
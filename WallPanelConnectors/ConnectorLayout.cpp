@@ -0,0 +1,67 @@
+#include "ConnectorLayout.h"
+#include "ConnectorTemplates.h"
+#include "AssetPlacer/Orientation.h"
+
+
+static PlanPoint offsetBy(const PlanPoint& position, const PlanPoint& offset) {
+    return makePlanPoint(position.x + offset.x, position.y + offset.y, position.z + offset.z);
+}
+
+
+void ConnectorLayout::wallPanels(const std::vector<ConnectorPanel>& panels, std::vector<ConnectorPosition>& connectors) {
+    connectors.reserve(connectors.size() + panels.size() * 3);
+    PlanPoint offsets[3];
+    for (const ConnectorPanel& panel : panels) {
+        int count = panel.levels < 3 ? panel.levels : 3;
+        const PlanPoint* connectorTemplate = panel.cornerPost ? cornerPostConnectorTemplate : wallPanelConnectorTemplate;
+        orient(orientationOf(panel.rotation), connectorTemplate, offsets, count);
+        for (int i = 0; i < count; ++i) {
+            connectors.push_back({ offsetBy(panel.position, offsets[i]), panel.rotation, 0 });
+        }
+    }
+}
+
+
+void ConnectorLayout::walers(const std::vector<ConnectorPanel>& panels, std::vector<ConnectorPosition>& connectors) {
+    const double setHeights[] = { 300.0, 1050.0 };
+    connectors.reserve(connectors.size() + panels.size() * 6);
+    PlanPoint offsets[3];
+    for (const ConnectorPanel& panel : panels) {
+        orient(orientationOf(panel.rotation), walerConnectorTemplate, offsets, 3);
+        int sets = panel.levels < 2 ? panel.levels : 2;
+        for (int set = 0; set < sets; ++set) {
+            for (int i = 0; i < 3; ++i) {
+                offsets[i].z = setHeights[set];
+                connectors.push_back({ offsetBy(panel.position, offsets[i]), panel.rotation, i });
+            }
+        }
+    }
+}
+
+
+void ConnectorLayout::stackedPanels(const std::vector<ConnectorPanel>& panels, std::vector<ConnectorPosition>& connectors) {
+    connectors.reserve(connectors.size() + panels.size() * 2);
+    PlanPoint connectorTemplate[2];
+    PlanPoint offsets[2];
+    for (const ConnectorPanel& panel : panels) {
+        if (panel.position.z == 0) continue;
+
+        stackedPanelConnectorTemplate(panel.width, connectorTemplate);
+        orient(orientationOf(panel.rotation), connectorTemplate, offsets, 2);
+        for (int i = 0; i < 2; ++i) {
+            connectors.push_back({ offsetBy(panel.position, offsets[i]), panel.rotation, i });
+        }
+    }
+}
+
+
+void ConnectorLayout::stacked15Panels(const std::vector<ConnectorPanel>& panels, std::vector<ConnectorPosition>& connectors) {
+    connectors.reserve(connectors.size() + panels.size() * 2);
+    for (const ConnectorPanel& panel : panels) {
+        if (panel.position.z == 0) continue;
+
+        PlanPoint position = offsetBy(panel.position, orient(orientationOf(panel.rotation), stacked15ConnectorOffset));
+        connectors.push_back({ position, panel.rotation, 0 });
+        connectors.push_back({ position, panel.rotation, 1 });
+    }
+}
@@ -0,0 +1,42 @@
+// ConnectorLayout.h
+#pragma once
+
+#include "AssetPlacer/PlanGeometry.h"
+#include <vector>
+
+// Panel a connector pass works on, as the placer selected it from the PanelIndex
+struct ConnectorPanel {
+    PlanPoint position;     // insertion point
+    double rotation;
+    double width;           // mm along the panel
+    int levels;             // connectors up a wall panel (2 or 3), or waler sets on a compensator (1 or 2)
+    bool cornerPost;        // DC 135 * 10 corner post (128286)
+};
+
+// One connector, at `part` of its placer's template: the connector of a wall panel; the waler
+// (0) or a tube holder (1, 2) of a waler set; the near (0) or far (1) end of a stacked panel;
+// the connector (0) or its nut (1) on a 15 wide stacked panel
+struct ConnectorPosition {
+    PlanPoint position;
+    double rotation;        // rotation of the panel
+    int part;
+};
+
+// Connector positions of the four connector placers, from the templates in
+// ConnectorTemplates.h. Pure geometry, no BRX dependencies; the placers add the block
+// rotations of each part and commit the blocks.
+class ConnectorLayout {
+public:
+    // WallPanelConnector: `levels` connectors up every panel, moved along a corner post
+    static void wallPanels(const std::vector<ConnectorPanel>& panels, std::vector<ConnectorPosition>& connectors);
+
+    // WalerConnector: a waler and two tube holders per set, the sets 300 and 1050 up
+    static void walers(const std::vector<ConnectorPanel>& panels, std::vector<ConnectorPosition>& connectors);
+
+    // StackedWallPanelConnectors: one connector near each end of every stacked panel; panels
+    // standing on the slab (z = 0) have none
+    static void stackedPanels(const std::vector<ConnectorPanel>& panels, std::vector<ConnectorPosition>& connectors);
+
+    // Stacked15PanelConnector: a connector and its nut on every stacked panel, none on the slab
+    static void stacked15Panels(const std::vector<ConnectorPanel>& panels, std::vector<ConnectorPosition>& connectors);
+};
@@ -0,0 +1,40 @@
+// ConnectorTemplates.h
+#pragma once
+
+#include "AssetPlacer/PlanGeometry.h"
+
+// Connector offsets of each connector placer in panel coordinates (x along the panel, y across
+// it, z up from the panel base), turned into model space with orient() from Orientation.h.
+// Header only, no BRX dependencies.
+
+// WallPanelConnector: bottom to top; panels with two connectors use the first two
+constexpr PlanPoint wallPanelConnectorTemplate[3] = {
+    { 0.0, -50.0, 225.0 },
+    { 0.0, -50.0, 525.0 },
+    { 0.0, -50.0, 975.0 }
+};
+
+// WallPanelConnector on a corner post (128286): the same connectors 100 further along
+constexpr PlanPoint cornerPostConnectorTemplate[3] = {
+    { 100.0, -50.0, 225.0 },
+    { 100.0, -50.0, 525.0 },
+    { 100.0, -50.0, 975.0 }
+};
+
+// WalerConnector: one 128255 and two 128293 per set; z comes from the set height
+constexpr PlanPoint walerConnectorTemplate[3] = {
+    { 25.0, -100.0, 0.0 },
+    { -150.0, -100.0, 0.0 },
+    { 250.0, -100.0, 0.0 }
+};
+
+// StackedWallPanelConnectors: one connector near each end of a stacked panel
+inline void stackedPanelConnectorTemplate(double panelWidth, PlanPoint (&connectorTemplate)[2]) {
+    const double acrossOffset = 50.0;
+    const double endOffset = 75.0;
+    connectorTemplate[0] = makePlanPoint(endOffset, -acrossOffset);
+    connectorTemplate[1] = makePlanPoint(panelWidth - endOffset, -acrossOffset);
+}
+
+// Stacked15PanelConnector: the connector and its nut share one offset
+constexpr PlanPoint stacked15ConnectorOffset = { 75.0, -50.0, 0.0 };
@@ -0,0 +1,154 @@
+#include "StdAfx.h"
+#include "PanelIndex.h"
+#include "SharedDefinations.h"
+#include "dbapserv.h"
+#include "dbents.h"
+#include "dbsymtb.h"
+#include "AcDb.h"
+#include "Blocks/PanelStack.h"
+#include "Profiler.h"
+
+namespace {
+    struct CatalogueEntry {
+        const std::wstring* name;
+        PanelType type;
+        int width;
+        int height;
+    };
+
+    const CatalogueEntry panelCatalogue[] = {
+        { &ASSET_128280, PanelType::Panel, 900, 1350 },
+        { &ASSET_128281, PanelType::Panel, 750, 1350 },
+        { &ASSET_128282, PanelType::Panel, 600, 1350 },
+        { &ASSET_128283, PanelType::Panel, 450, 1350 },
+        { &ASSET_128284, PanelType::Panel, 300, 1350 },
+        { &ASSET_128285, PanelType::Panel, 150, 1350 },
+        { &ASSET_136096, PanelType::Panel, 600, 1200 },
+        { &ASSET_129837, PanelType::Panel, 900, 600 },
+        { &ASSET_129838, PanelType::Panel, 750, 600 },
+        { &ASSET_129839, PanelType::Panel, 600, 600 },
+        { &ASSET_129840, PanelType::Panel, 450, 600 },
+        { &ASSET_129841, PanelType::Panel, 300, 600 },
+        { &ASSET_129842, PanelType::Panel, 150, 600 },
+        { &ASSET_128286, PanelType::CornerPost, 100, 1350 },
+        { &ASSET_129864, PanelType::CornerPost, 100, 600 },
+        { &ASSET_128287, PanelType::Compensator, 50, 1350 },
+        { &ASSET_128292, PanelType::Compensator, 100, 1350 },
+        { &ASSET_129879, PanelType::Compensator, 50, 600 },
+        { &ASSET_129884, PanelType::Compensator, 100, 600 },
+    };
+}
+
+
+const PanelIndex::Definition& PanelIndex::definition(const AcDbObjectId& blockId) {
+    auto it = definitions.find(blockId);
+    if (it != definitions.end()) {
+        return it->second;
+    }
+
+    Definition result = { false, PanelType::Panel, 0, 0, std::wstring(), std::vector<StackPart>() };
+    AcDbBlockTableRecord* pBlockDef;
+    Profiler::count(ProfileCounter::ObjectsOpened);
+    if (acdbOpenObject(pBlockDef, blockId, AcDb::kForRead) == Acad::eOk) {
+        const wchar_t* blockName;
+        pBlockDef->getName(blockName);
+        std::wstring blockNameStr = toUpperCase(std::wstring(blockName));
+
+        // Stack definitions are read once; their panels resolve through the same cache
+        if (PanelStack::isStackName(blockNameStr)) {
+            AcDbBlockTableRecordIterator* pIter;
+            if (pBlockDef->newIterator(pIter) == Acad::eOk) {
+                for (pIter->start(); !pIter->done(); pIter->step()) {
+                    AcDbEntity* pEnt;
+                    Profiler::count(ProfileCounter::ObjectsOpened);
+                    if (pIter->getEntity(pEnt, AcDb::kForRead) != Acad::eOk) {
+                        continue;
+                    }
+                    AcDbBlockReference* pPart = AcDbBlockReference::cast(pEnt);
+                    if (pPart) {
+                        const Definition& panel = definition(pPart->blockTableRecord());
+                        if (panel.isPanel) {
+                            result.parts.push_back({ pPart->position(), pPart->rotation(), &panel });
+                        }
+                    }
+                    pEnt->close();
+                }
+                delete pIter;
+            }
+        }
+        pBlockDef->close();
+
+        for (const auto& entry : panelCatalogue) {
+            if (*entry.name == blockNameStr) {
+                result = { true, entry.type, entry.width, entry.height, blockNameStr };
+                break;
+            }
+        }
+    }
+    return definitions.emplace(blockId, result).first->second;
+}
+
+
+bool PanelIndex::build() {
+    Profiler::Phase phase("panel_index");
+    entries.clear();
+    definitions.clear();
+
+    AcDbDatabase* pDb = acdbHostApplicationServices()->workingDatabase();
+    if (!pDb) {
+        acutPrintf(_T("\nNo working database found."));
+        return false;
+    }
+
+    AcDbBlockTable* pBlockTable;
+    Profiler::count(ProfileCounter::BlockTableOpens);
+    if (pDb->getBlockTable(pBlockTable, AcDb::kForRead) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to get block table."));
+        return false;
+    }
+
+    AcDbBlockTableRecord* pModelSpace;
+    if (pBlockTable->getAt(ACDB_MODEL_SPACE, pModelSpace, AcDb::kForRead) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to get model space."));
+        pBlockTable->close();
+        return false;
+    }
+
+    AcDbBlockTableRecordIterator* pIter;
+    if (pModelSpace->newIterator(pIter) != Acad::eOk) {
+        acutPrintf(_T("\nFailed to create iterator."));
+        pModelSpace->close();
+        pBlockTable->close();
+        return false;
+    }
+
+    for (pIter->start(); !pIter->done(); pIter->step()) {
+        AcDbEntity* pEnt;
+        Profiler::count(ProfileCounter::ObjectsOpened);
+        if (pIter->getEntity(pEnt, AcDb::kForRead) == Acad::eOk) {
+            AcDbBlockReference* pBlockRef = AcDbBlockReference::cast(pEnt);
+            if (pBlockRef) {
+                const Definition& panel = definition(pBlockRef->blockTableRecord());
+                if (panel.isPanel) {
+                    entries.push_back({ pBlockRef->position(), pBlockRef->rotation(), panel.type, panel.width, panel.height, panel.name });
+                }
+                else if (!panel.parts.empty()) {
+                    AcGeMatrix3d blockTransform = pBlockRef->blockTransform();
+                    for (const StackPart& part : panel.parts) {
+                        AcGePoint3d position = part.position;
+                        position.transformBy(blockTransform);
+                        entries.push_back({ position, pBlockRef->rotation() + part.rotation, part.panel->type,
+                            part.panel->width, part.panel->height, part.panel->name });
+                    }
+                }
+            }
+            pEnt->close();
+        }
+    }
+
+    delete pIter;
+    pModelSpace->close();
+    pBlockTable->close();
+
+    return true;
+}
@@ -0,0 +1,75 @@
+// PanelIndex.h
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <string>
+#include <map>
+#include "gepnt3d.h"
+#include "dbid.h"
+
+enum class PanelType {
+    Panel,          // DP / DMP wall panel
+    CornerPost,     // DC corner post
+    Compensator     // DWC wall thickness compensator
+};
+
+// One wall panel block reference found in model space
+struct IndexedPanel {
+    AcGePoint3d position;
+    double rotation;
+    PanelType type;
+    int width;      // mm
+    int height;     // mm
+    std::wstring name;
+};
+
+// Every formwork panel in model space, gathered in a single scan. Block definitions are
+// resolved to a panel type once each, not once per reference, and the connector passes
+// select from the index instead of iterating model space themselves. Panel stack
+// references (PanelStack) are expanded into the panels they contain.
+class PanelIndex {
+public:
+    typedef std::tuple<AcGePoint3d, std::wstring, double> PanelPosition;
+
+    // Scans model space of the working database; false when it could not be read
+    bool build();
+
+    const std::vector<IndexedPanel>& panels() const { return entries; }
+    bool empty() const { return entries.empty(); }
+
+    // Panels accepted by `accept`, in the (position, name, rotation) form the placers use
+    template <typename Predicate>
+    std::vector<PanelPosition> positions(Predicate accept) const {
+        std::vector<PanelPosition> result;
+        for (const auto& panel : entries) {
+            if (accept(panel)) {
+                result.emplace_back(panel.position, panel.name, panel.rotation);
+            }
+        }
+        return result;
+    }
+
+private:
+    struct StackPart;
+
+    struct Definition {
+        bool isPanel;
+        PanelType type;
+        int width;
+        int height;
+        std::wstring name;
+        std::vector<StackPart> parts;   // panels of a stack definition, in block coordinates
+    };
+
+    struct StackPart {
+        AcGePoint3d position;
+        double rotation;
+        const Definition* panel;
+    };
+
+    const Definition& definition(const AcDbObjectId& blockId);
+
+    std::vector<IndexedPanel> entries;
+    std::map<AcDbObjectId, Definition> definitions;
+};
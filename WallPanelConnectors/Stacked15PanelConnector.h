@@ -5,15 +5,16 @@
 #include "gept3dar.h"  // For AcGePoint3d
 #include "dbid.h"   // For AcDbObjectId
 
+class PanelIndex;
+
 // Declare the function to get the width of the panel based on its name
 double get15Panel(const std::wstring& panelName);
 
 class Stacked15PanelConnector {
 public:
-	static void place15panelConnectors();
+	static void place15panelConnectors(const PanelIndex& index);
 private:
-	static std::vector<std::tuple<AcGePoint3d, std::wstring, double>> getWallPanelPositions();
+	static std::vector<std::tuple<AcGePoint3d, std::wstring, double>> getWallPanelPositions(const PanelIndex& index);
 	static std::vector<std::tuple<AcGePoint3d, double, double, double, double>> calculateConnectorPositions(const std::vector<std::tuple<AcGePoint3d, std::wstring, double>>& panelPositions);
 	static AcDbObjectId loadConnectorAsset(const wchar_t* blockName);
-	static void placeConnectorAtPosition(const AcGePoint3d& position, double rotationX, double rotationY, double rotationZ, double panelRotation, AcDbObjectId assetId);
 };
\ No newline at end of file